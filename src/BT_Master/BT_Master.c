@@ -6,7 +6,7 @@
 *************************************************************************/
 /*
     TM4C123G pins used
-    PA2,3,5,7   -   Nokia5110 (SSI0)
+    PA2,3,5,6,7 -   Nokia5110 or ST7735 (SSI0)
     PB0,1       -   Bluetooth module HC-05 (UART1)
     PC4,5,6,7   -   Keypad Colomn
     PD0,1,2,3   -   Keypad Row
@@ -17,7 +17,28 @@
 #include "../lib/tm4c123gh6pm.h"
 #include "../lib/UART.h"
 #include "../lib/Nokia5110.h"
-#include "../lib/Timer.h"
+#include "../lib/Timebase.h"
+#include "../lib/Widget.h"
+#include "../lib/ST7735.h"
+#include "../lib/Scene.h"
+#include "../lib/Settings.h"
+#include "../lib/SoftTimer.h"
+#include "../lib/Event.h"
+#include "../lib/Kernel.h"
+#include "Dashboard.h"
+
+// Uncomment to show the status on the ST7735 160x128 color LCD
+// instead of the Nokia5110.  Both use SSI0, connect only one.
+//#define DISPLAY_ST7735
+
+// Uncomment to run the event handlers and the display as tasks of
+// the preemptive kernel, so a key or a character from the Slave is
+// acted on at once, even in the middle of a long redraw.
+//#define KERNEL
+
+// Uncomment, with KERNEL, to print the context switch times measured
+// by PendSV_Handler on UART0 every 10 seconds.
+//#define KERNEL_STATS
 
 #define RELAY1  (*((volatile unsigned long *)0x40024010)) // PE2
 #define RELAY2  (*((volatile unsigned long *)0x40024020)) // PE3
@@ -45,13 +66,48 @@ void DisableInterrupts(void);       // Disable interrupts
 void EnableInterrupts(void);        // Enable interrupts
 void WaitForInterrupt(void);        // low power mode
 void PortE_Init(void);              // Relays & Buzzer Init
-void SysTick_Init(unsigned long);   // Systick Init
-void Nokia_Task(void);              // Task for Nokia5110 at 60Hz
+void Nokia_Task(void);              // Task for Nokia5110 after each change
 char ReadKey(void);                 // Reading input from Keypad
 void Keypad_Init(void);             // 4x4 Keypad Init
+void Key_Task(unsigned char key);   // Act on a key pressed
+void Bluetooth_Task(unsigned char c); // Act on a character from the Slave
+void Restore_State(void);           // Devices as they were before the reset
+void Save_State(void);              // Stage the state for the EEPROM
+void Wake_Background(void);         // Have the display and the state updated
 
 unsigned long SoundTime;            // Timer for sound
 static unsigned int device;        // a Register holding device flags
+static int select_led;             // Variable to hold last led selected.
+
+static SoftTimer KeyTimer;          // scans the keypad while a key is down
+static SoftTimer BuzzerTimer;       // plays the sound of the '1' key
+static SoftTimer SaveTimer;         // wakes the background to write the state
+#define KEY_SCAN_MS   20            // keypad scan, also the debounce time
+#define BUZZER_MS     33            // half period of the sound
+
+// Events posted by the ISRs, run from main by Event_Run()
+EVENT_QUEUE(BluetoothQueue, 16, EVENT_PRIORITY_HIGH, &Bluetooth_Task); // characters
+EVENT_QUEUE(KeyQueue, 4, EVENT_PRIORITY_HIGH+1, &Key_Task);   // keys pressed
+
+// Brightness of Slave's LED strips, mirroring the steps done by the
+// Slave on 'A'/'B' (HALLWAY) and 'C'/'D' (BATHROOM) so they can be shown.
+// Perceptual levels, the same units as PWM_SetLevel() on the Slave.
+#define BRIGHT_STEP    12
+#define BRIGHT_MAX     255
+#define BRIGHT_DEFAULT 230
+static unsigned int hallway_brightness  = BRIGHT_DEFAULT;
+static unsigned int bathroom_brightness = BRIGHT_DEFAULT;
+
+// State kept in the EEPROM over resets, see Settings.h.  HALLWAY
+// and BATHROOM are not kept: the Slave keeps them and reports them
+// after it starts.  Change STATE_VERSION when the layout changes.
+#define STATE_VERSION 1
+#define KEPT     (DESK1|DESK2|LAMP|POLE|DESK3|RELAY3|RELAY4|FAN)
+typedef struct {
+    uint16_t device;                // the KEPT flags of device
+    uint8_t  hallway;               // hallway_brightness
+    uint8_t  bathroom;              // bathroom_brightness
+} State;
 
 // PortC and PortD Initialization
 // PC 4,5,6,7 are Keypad's column 1,2,3,4 as outputs
@@ -75,6 +131,16 @@ void Keypad_Init(void){ volatile unsigned long delay;
   GPIO_PORTD_PCTL_R  &= ~0x0000FFFF; // configure PD0-3 as GPIO
   GPIO_PORTD_AMSEL_R &= ~0x0000FFFF; // disable analog functionality on PD0-3
   GPIO_PORTD_PUR_R   |= 0x0F;       // Enable weak pull up resistors.
+  
+  // Idle with all columns low, so any key pulls its row low
+  GPIO_PORTC_DATA_R  &= ~0xF0;
+  GPIO_PORTD_IS_R    &= ~0x0F;       // PD0-3 edge sensitive
+  GPIO_PORTD_IBE_R   &= ~0x0F;       //     not both edges
+  GPIO_PORTD_IEV_R   &= ~0x0F;       //     falling edge, a key pressed
+  GPIO_PORTD_ICR_R    =  0x0F;       // clear flags
+  GPIO_PORTD_IM_R    |=  0x0F;       // arm interrupt on PD0-3
+  NVIC_PRI0_R = (NVIC_PRI0_R&0x00FFFFFF)|0xC0000000; // priority 6
+  NVIC_EN0_R = 0x00000008;           // enable interrupt 3 in NVIC
 }
 
 // Port for Relays and Buzzer
@@ -93,17 +159,6 @@ void PortE_Init(void){ volatile unsigned long delay;
   GPIO_PORTE_DATA_R  &= ~0x3C;
 }
 
-// SysTick Init, period will be loaded such that the interrupts happen
-// at 1ms intervals.
-void SysTick_Init(unsigned long period) {
-    NVIC_ST_CTRL_R = 0;         // disable SysTick during setup
-    NVIC_ST_RELOAD_R = period-1;// reload value
-    NVIC_ST_CURRENT_R = 0;      // any write to current clears it
-    NVIC_SYS_PRI3_R = (NVIC_SYS_PRI3_R&0x00FFFFFF)|0x20000000; // priority 1
-    // enable SysTick with core clock and interrupts
-    NVIC_ST_CTRL_R = NVIC_ST_CTRL_ENABLE+NVIC_ST_CTRL_CLK_SRC+NVIC_ST_CTRL_INTEN;
-}
-
 /*****************************************************************
 Key Read Function
 *****************************************************************/
@@ -167,210 +222,403 @@ char ReadKey(void){
     return 0;
 }
 
+// Keypad scan, every KEY_SCAN_MS from the first edge until all
+// keys are up.  Posts each key pressed for Key_Task(); then the
+// columns go low again and the edge interrupt waits for the next key.
+static void Key_Scan(void){
+    static char prev_key;
+    char key = ReadKey();
+    if(key != prev_key){
+        prev_key = key;
+        if(key != 0) Event_Post(&KeyQueue, key);
+    }
+    if(key == 0){
+        SoftTimer_Cancel(&KeyTimer);
+        COL &= ~0xF0;
+        GPIO_PORTD_ICR_R = 0x0F;
+        GPIO_PORTD_IM_R |= 0x0F;
+        if(ROW != 0x0F){            // pressed before it was armed
+            GPIO_PORTD_IM_R &= ~0x0F;
+            SoftTimer_Start(&KeyTimer, &Key_Scan, KEY_SCAN_MS, KEY_SCAN_MS);
+        }
+    }
+}
+
+// A row went low: scan once the contacts have settled
+void GPIOPortD_Handler(void){
+    GPIO_PORTD_IM_R &= ~0x0F;       // disarm until all keys are up
+    GPIO_PORTD_ICR_R = 0x0F;        // acknowledge
+    SoftTimer_Start(&KeyTimer, &Key_Scan, KEY_SCAN_MS, KEY_SCAN_MS);
+}
+
+// Toggle the buzzer until the sound has played
+static void Buzzer_Task(void){
+    if(SoundTime < 59) BUZZER ^= 0x10;
+    else{
+        BUZZER &= ~0x10;
+        device &= ~SPEAKER;
+        SoftTimer_Cancel(&BuzzerTimer);
+    }
+    SoundTime = SoundTime+1;
+}
+
+#ifdef DISPLAY_ST7735
+static SoftTimer ClockTimer;        // wakes the background to age the link and sweep the sparkline
+
+// Rooms of the ST7735 dashboard, the two LED strips with bars.
+static const DashRoom Rooms[] = {
+    {"HALL",  HALLWAY,  &hallway_brightness},
+    {"BATH",  BATHROOM, &bathroom_brightness},
+    {"LAMP",  LAMP,     0},
+    {"POLE",  POLE,     0},
+    {"FAN",   FAN,      0},
+    {"DESK1", DESK1,    0},
+    {"DESK2", DESK2,    0},
+    {"DESK3", DESK3,    0},
+    {"RLY3",  RELAY3,   0},
+    {"RLY4",  RELAY4,   0},
+};
+#else
+// Pages of the Nokia5110 status display, switched by the 'D' key.
+//  Page 0 - lights and relays on the Master's screen since the start.
+//  Page 1 - the rest of the devices.
+//  Page 2 - brightness of the Slave's LED strips.
+static const Widget StatusPage[] = {
+    {WIDGET_LABEL, 0, 0, 12, "___MASTER___", 0, 0, 0},
+    {WIDGET_LABEL, 0, 1,  9, "HALLWAY:",     0, 0, 0},
+    {WIDGET_ONOFF, 9, 1,  3, 0, &device, HALLWAY,  0},
+    {WIDGET_LABEL, 0, 2,  9, "BATHROOM:",    0, 0, 0},
+    {WIDGET_ONOFF, 9, 2,  3, 0, &device, BATHROOM, 0},
+    {WIDGET_LABEL, 0, 3,  9, "LAMP:",        0, 0, 0},
+    {WIDGET_ONOFF, 9, 3,  3, 0, &device, LAMP,     0},
+    {WIDGET_LABEL, 0, 4,  9, "POLE:",        0, 0, 0},
+    {WIDGET_ONOFF, 9, 4,  3, 0, &device, POLE,     0},
+    {WIDGET_LABEL, 0, 5,  9, "FAN:",         0, 0, 0},
+    {WIDGET_ONOFF, 9, 5,  3, 0, &device, FAN,      0},
+};
+static const Widget DevicePage[] = {
+    {WIDGET_LABEL, 0, 0, 12, "__DEVICES___", 0, 0, 0},
+    {WIDGET_LABEL, 0, 1,  9, "DESK1:",       0, 0, 0},
+    {WIDGET_ONOFF, 9, 1,  3, 0, &device, DESK1,  0},
+    {WIDGET_LABEL, 0, 2,  9, "DESK2:",       0, 0, 0},
+    {WIDGET_ONOFF, 9, 2,  3, 0, &device, DESK2,  0},
+    {WIDGET_LABEL, 0, 3,  9, "DESK3:",       0, 0, 0},
+    {WIDGET_ONOFF, 9, 3,  3, 0, &device, DESK3,  0},
+    {WIDGET_LABEL, 0, 4,  9, "RELAY3:",      0, 0, 0},
+    {WIDGET_ONOFF, 9, 4,  3, 0, &device, RELAY3, 0},
+    {WIDGET_LABEL, 0, 5,  9, "RELAY4:",      0, 0, 0},
+    {WIDGET_ONOFF, 9, 5,  3, 0, &device, RELAY4, 0},
+};
+static const Widget BrightPage[] = {
+    {WIDGET_LABEL, 0, 0, 12, "_BRIGHTNESS_", 0, 0, 0},
+    {WIDGET_LABEL, 0, 1,  9, "HALLWAY:",     0, 0, 0},
+    {WIDGET_ONOFF, 9, 1,  3, 0, &device, HALLWAY,  0},
+    {WIDGET_BAR,   0, 2, 12, 0, &hallway_brightness,  0, BRIGHT_MAX},
+    {WIDGET_LABEL, 0, 3,  9, "BATHROOM:",    0, 0, 0},
+    {WIDGET_ONOFF, 9, 3,  3, 0, &device, BATHROOM, 0},
+    {WIDGET_BAR,   0, 4, 12, 0, &bathroom_brightness, 0, BRIGHT_MAX},
+};
+static const WidgetPage Pages[] = {
+    {StatusPage, sizeof(StatusPage)/sizeof(Widget)},
+    {DevicePage, sizeof(DevicePage)/sizeof(Widget)},
+    {BrightPage, sizeof(BrightPage)/sizeof(Widget)},
+};
+
 // Nokia_Task
-//      - Display status of Hallway light, Buzzer, Lamp, and Humidity on
-//          Nokia5110 display by utilizing Nokia_token that polls statuses 
-//          and are updated at Systick_Handler
+//      - Display status of devices on the Nokia5110 display.  Only the
+//          widgets whose device flag or brightness changed since the
+//          last call are redrawn; a page change redraws the whole page.
 //
-//  Input  - Nokia_token
-//  Output - Nokia5110 LCD display through Nokia functions.
+//  Input  - device, hallway_brightness, bathroom_brightness
+//  Output - Nokia5110 LCD display through Widget functions.
 //
-#define NOKIA_DEFAULT 0x00
 void Nokia_Task(){
+    Widget_Update();
+}
+#endif
+
+/***************************************************************************
+    Event handlers
+        - Run from main with the characters and keys posted by the
+            UART1 interrupt and the keypad scan; they set up Devices
+            register to operate the device, and the display is
+            updated once the events are done.
+***************************************************************************/
+// Step a mirrored brightness the same way the Slave does.
+static unsigned int BrightUp(unsigned int b){
+    if(b+BRIGHT_STEP > BRIGHT_MAX) return BRIGHT_MAX;
+    return b+BRIGHT_STEP;
+}
+static unsigned int BrightDown(unsigned int b){
+    if(b < 2*BRIGHT_STEP) return BRIGHT_STEP;
+    return b-BRIGHT_STEP;
+}
+
+// Mirror a scene the way the Slave applies it: strips at level 0
+// go off, the others come on at the scene's level.
+static void SceneMirror(const Scene *s){
+    if(s->level[SCENE_HALLWAY]){
+        device |= HALLWAY;
+        hallway_brightness = s->level[SCENE_HALLWAY];
+    }
+    else device &= ~HALLWAY;
+    if(s->level[SCENE_BATHROOM]){
+        device |= BATHROOM;
+        bathroom_brightness = s->level[SCENE_BATHROOM];
+    }
+    else device &= ~BATHROOM;
+}
+
+// Restore_State
+//  - restore the devices and brightness saved before the reset, and
+//    turn the relays back on.  Called before interrupts are enabled.
+void Restore_State(void){
+    State state;
+    state.device   = 0;
+    state.hallway  = BRIGHT_DEFAULT;
+    state.bathroom = BRIGHT_DEFAULT;
+    Settings_Init(STATE_VERSION, &state, sizeof(state));
+    device = state.device&KEPT;
+    hallway_brightness  = state.hallway;
+    bathroom_brightness = state.bathroom;
+    if(device&LAMP) RELAY1 |= 0x04;
+    if(device&POLE) RELAY2 |= 0x08;
+    if(device&FAN)  FANPIN |= 0x20;
+}
+
+// Save_State
+//  - stage the state for the EEPROM; a run of changes is written
+//    once, by the background, which a timer wakes when the quiet
+//    time is over.
+void Save_State(void){
+    State state;
+    state.device   = device&KEPT;
+    state.hallway  = hallway_brightness;
+    state.bathroom = bathroom_brightness;
+    Settings_Save(&state, sizeof(state));
+    SoftTimer_Start(&SaveTimer, &Wake_Background, SETTINGS_HOLD_MS+1, 0);
+}
+
+static void Bluetooth_Rx(unsigned char c){
+    Event_Post(&BluetoothQueue, c);
+}
+
+// Bluetooth_Task
+//  - a character from the Slave, posted by the UART1 interrupt.
+void Bluetooth_Task(unsigned char bt_in){
+#ifdef DISPLAY_ST7735
+    Dashboard_Link();
+    if((bt_in == '%')||(bt_in == '$')) Dashboard_Motion();
+#endif
     
-    //  Display default screen
-    if(device == NOKIA_DEFAULT){
-        Nokia5110_Clear();
-        Nokia5110_OutString("___MASTER___");
-        Nokia5110_SetCursor(0,1);
-        Nokia5110_OutString("HALLWAY: OFF");
-        Nokia5110_SetCursor(0,2);
-        Nokia5110_OutString("BATHROOM:OFF");
-        Nokia5110_SetCursor(0,3);
-        Nokia5110_OutString("LAMP:    OFF");
-        Nokia5110_SetCursor(0,4);
-        Nokia5110_OutString("POLE:    OFF");
-        Nokia5110_SetCursor(0,5);
-        Nokia5110_OutString("FAN:     OFF");
-//        Nokia5110_OutString("HUMID:  100%");
-    }else{
-    
-        // Display Hallway light status
-        if((device & HALLWAY) == HALLWAY){
-            Nokia5110_SetCursor(9,1);
-            Nokia5110_OutString(" ON");   
-        }
-        else{
-            Nokia5110_SetCursor(9,1);
-            Nokia5110_OutString("OFF");
-        }
-        
-        // Display Sound status
-        if((device & BATHROOM) == BATHROOM){
-            Nokia5110_SetCursor(9,2);
-            Nokia5110_OutString(" ON");
-        }
-        else{
-            Nokia5110_SetCursor(9,2);
-            Nokia5110_OutString("OFF");
+    // '%' - case that HALLWAY PIR to turn on
+    // '_' - case that HALLWAY PIR to turn off
+    // '@' - case that Slave MCU is restarted.
+    switch(bt_in){
+        case '%':{device |=  HALLWAY; break;}
+        case '_':{device &= ~HALLWAY; break;}
+        case '$':{device |=  BATHROOM; break;}
+        case '-':{device &= ~BATHROOM; break;}
+        case '@':{device &= ~(HALLWAY|BATHROOM); // its brightness is kept
+            break;}
+    }
+}
+
+// Key_Task
+//  - a key pressed, posted by the keypad scan.
+//    Toggle On/Off Devices of Action according to the button
+void Key_Task(unsigned char key){
+    static unsigned char scene;  // next scene of the 'C' key
+    switch(key){
+        case '1':{ device |= SPEAKER; SoundTime = 0;
+            SoftTimer_Start(&BuzzerTimer, &Buzzer_Task, 0, BUZZER_MS);
+            break; }
+        case '2':{ device ^= DESK1;  break; }
+        case '3':{ device ^= DESK2;  break; }
+        case '4':{ device ^= LAMP;   RELAY1 ^= 0x04; break; }
+        case '5':{ device ^= POLE;   RELAY2 ^= 0x08; break; }
+        case '6':{ device ^= DESK3;  break; }
+        case '7':{ device ^= RELAY3; break; }
+        case '8':{ device ^= RELAY4; break; }
+        case '9':{ device ^=    FAN; FANPIN ^= 0x20; break; }
+        case '0':{ device ^= BATHROOM; 
+            select_led = BATHROOM;
+            if((device&BATHROOM)!=BATHROOM) // if BATHROOM is off
+                 UART1_OutChar('2');        // send '2' to turn off BATHROOM
+            else UART1_OutChar('3');        // send '3' to turn on BATHROOM
+            break;
         }
-        
-        // Display Lamp status
-        if((device & LAMP) == LAMP){
-            Nokia5110_SetCursor(9,3);
-            Nokia5110_OutString(" ON");
+        case 'A': { //PWM_UP
+            // if either HALLWAY or BATHROOM is on.
+            if( ((device& HALLWAY)==HALLWAY)||((device&BATHROOM)==BATHROOM))
+            {
+                switch(select_led){
+                    case HALLWAY: {UART1_OutChar('A');
+                        hallway_brightness = BrightUp(hallway_brightness);
+                        break;}
+                    case BATHROOM:{UART1_OutChar('C');
+                        bathroom_brightness = BrightUp(bathroom_brightness);
+                        break;}
+                }
+            }
+            break;
         }
-        else{
-            Nokia5110_SetCursor(9,3);
-            Nokia5110_OutString("OFF");
+        case 'B': { //PWM_DN
+            // if either HALLWAY or BATHROOM is on.
+            if( ((device& HALLWAY)==HALLWAY)||((device&BATHROOM)==BATHROOM))
+            {
+                switch(select_led){
+                    case HALLWAY: {UART1_OutChar('B');
+                        hallway_brightness = BrightDown(hallway_brightness);
+                        break;}
+                    case BATHROOM:{UART1_OutChar('D');
+                        bathroom_brightness = BrightDown(bathroom_brightness);
+                        break;}
+                }
+            }
+            break;
         }
-        
-        // Display Lamp status
-        if((device & POLE) == POLE){
-            Nokia5110_SetCursor(9,4);
-            Nokia5110_OutString(" ON");
+        case 'C':{ // next scene, both LED strips fade together
+            UART1_OutChar(Scenes[scene].message);
+            SceneMirror(&Scenes[scene]);
+            scene = (scene+1)%SceneCount;
+            break;
         }
-        else{
-            Nokia5110_SetCursor(9,4);
-            Nokia5110_OutString("OFF");
+#ifndef DISPLAY_ST7735
+        case 'D':{ Widget_NextPage(); break; }  // next status page
+#endif
+        case '*':{ device ^= HALLWAY;
+            select_led = HALLWAY;
+            if((device&HALLWAY)!=HALLWAY)   // if HALLWAY is off
+                 UART1_OutChar('0');        // send '0' to turn off HALLWAY
+            else UART1_OutChar('1');        // send '1' to turn on HALLWAY
+            break;
         }
-        
-        // Display Fan status
-        if((device & FAN) == FAN){
-            Nokia5110_SetCursor(9,5);
-            Nokia5110_OutString(" ON");
+        case '#': {
+            // Turn off all devices
+            device &= ~(SPEAKER|DESK1|DESK2|DESK3|LAMP|POLE|
+                        RELAY3|RELAY4|FAN|BATHROOM|HALLWAY);
+            select_led = 0;
+            RELAY1 &= ~0x04;
+            RELAY2 &= ~0x08;
+            SoftTimer_Cancel(&BuzzerTimer);
+            BUZZER &= ~0x10;
+            FANPIN &= ~0x20;
+            UART1_OutChar('#'); // send a command to slave to turn off devices
+            break;
         }
-        else{
-            Nokia5110_SetCursor(9,5);
-            Nokia5110_OutString("OFF");
+        case '@':{  // Slave is just turn on.
+            // Reset Slave's devices status
+            device &= ~(HALLWAY|BATHROOM);
+            select_led = 0;
         }
-        
-        // Always display Humidity
-//            Nokia5110_SetCursor(6,5);
-//            Nokia5110_OutUDec(100);
-//            Nokia5110_OutChar('%');
     }
-        
+    Save_State();
 }
 
-/***************************************************************************
-    Interrupts, ISRs
-        - Consistently checking input from Bluetooth and Keypad
-            and then set up Devices register to operate the device
-            while setting up the Nokia_token for updating the Nokia display.
-***************************************************************************/
-void SysTick_Handler(void){
+#ifdef DISPLAY_ST7735
+static volatile uint8_t DisplayReady;   // the ST7735 init sequence is done
 
-    static char key, prev_key;   // Variable to hold current key character
-    static int  select_led;      // Variable to hold last led selected.       
-    char bt_in;                  // Variable to hold a character received from Bluetooth
-    
-    // Save previous key before receiving new key
-    //  Because 'key' would be spam with null
-    //  or previous key, the program would action
-    //  only time the key has changed.
-    prev_key = key;
-    
-    // Check input from Bluetooth
-    //  Set key if got Bluetooth char,
-    //  else key from keypad.
-    bt_in = UART1_NonBlockingInChar();    
-    if(bt_in != 0){
-        
-        // '%' - case that HALLWAY PIR to turn on
-        // '_' - case that HALLWAY PIR to turn off
-        // '@' - case that Slave MCU is restarted.
-        switch(bt_in){
-            case '%':{device |=  HALLWAY; break;}
-            case '_':{device &= ~HALLWAY; break;}
-            case '$':{device |=  BATHROOM; break;}
-            case '-':{device &= ~BATHROOM; break;}
-            case '@':{device &= ~(HALLWAY|BATHROOM); break;}    
-        }
+// Display_Ready
+//  - called from TIMER2A when the ST7735 is initialized: have the
+//    dashboard drawn for the first time, which also clears the
+//    screen, from the background rather than from the interrupt.
+static void Display_Ready(void){
+    DisplayReady = 1;
+    Wake_Background();
+}
+#endif
+
+// Redraw what the events changed
+static void Redraw(void){
+#ifdef DISPLAY_ST7735
+    if(DisplayReady){               // nothing is sent while it initializes
+        Dashboard_Update();
     }
-    else key = ReadKey();  // Update key received from Keypad
-    
-    // Only action when key is different.
-    //  Toggle On/Off Devices of Action according to the button
-    if(prev_key != key){
-        switch(key){
-            case '1':{ device |= SPEAKER; SoundTime = 0; break; }
-            case '2':{ device ^= DESK1;  break; }
-            case '3':{ device ^= DESK2;  break; }
-            case '4':{ device ^= LAMP;   RELAY1 ^= 0x04; break; }
-            case '5':{ device ^= POLE;   RELAY2 ^= 0x08; break; }
-            case '6':{ device ^= DESK3;  break; }
-            case '7':{ device ^= RELAY3; break; }
-            case '8':{ device ^= RELAY4; break; }
-            case '9':{ device ^=    FAN; FANPIN ^= 0x20; break; }
-            case '0':{ device ^= BATHROOM; 
-                select_led = BATHROOM;
-                if((device&BATHROOM)!=BATHROOM) // if BATHROOM is off
-                     UART1_OutChar('2');        // send '2' to turn off BATHROOM
-                else UART1_OutChar('3');        // send '3' to turn on BATHROOM
-                break;
-            }
-            case 'A': { //PWM_UP
-                // if either HALLWAY or BATHROOM is on.
-                if( ((device& HALLWAY)==HALLWAY)||((device&BATHROOM)==BATHROOM))
-                {
-                    switch(select_led){
-                        case HALLWAY: {UART1_OutChar('A'); break;}
-                        case BATHROOM:{UART1_OutChar('C'); break;}
-                    }
-                }
-                break;
-            }
-            case 'B': { //PWM_DN
-                // if either HALLWAY or BATHROOM is on.
-                if( ((device& HALLWAY)==HALLWAY)||((device&BATHROOM)==BATHROOM))
-                {
-                    switch(select_led){
-                        case HALLWAY: {UART1_OutChar('B'); break;}
-                        case BATHROOM:{UART1_OutChar('D'); break;}
-                    }
-                }
-                break;
-            }
-            case 'C':{ device ^= BTN_C; break; }
-            case 'D':{ device ^= BTN_D; break; }
-            case '*':{ device ^= HALLWAY;
-                select_led = HALLWAY;
-                if((device&HALLWAY)!=HALLWAY)   // if HALLWAY is off
-                     UART1_OutChar('0');        // send '0' to turn off HALLWAY
-                else UART1_OutChar('1');        // send '1' to turn on HALLWAY
-                break;
-            }
-            case '#': {
-                // Turn off all devices
-                device &= ~(SPEAKER|DESK1|DESK2|DESK3|LAMP|POLE|
-                            RELAY3|RELAY4|FAN|BATHROOM|HALLWAY);
-                select_led = 0;
-                RELAY1 &= ~0x04;
-                RELAY2 &= ~0x08;
-                BUZZER &= ~0x10;
-                FANPIN &= ~0x20;
-                UART1_OutChar('#'); // send a command to slave to turn off devices
-                break;
-            }
-            case '@':{  // Slave is just turn on.
-                // Reset Slave's devices status
-                device &= ~(HALLWAY|BATHROOM);
-                select_led = 0;
-            }
-        }
+#else
+    Nokia_Task();
+#endif
+}
+
+// Background
+//  - after the events: redraw what they changed, and write the state
+//    once it stops changing.
+static void Background(void){
+    Redraw();
+    Settings_Poll();
+}
+
+#ifdef KERNEL
+// Tasks of the kernel.  Control runs the events posted by the ISRs
+// and preempts Display, which redraws and writes the state.  SSI0
+// is taken with SsiBus, so a task added to use another device on
+// it lends its priority to Display while waiting for the bus.
+void Control_Run(void);
+void Display_Run(void);
+KERNEL_TASK(ControlTask, &Control_Run, 1, 128);
+KERNEL_TASK(DisplayTask, &Display_Run, 2, 384);
+static KernelMutex SsiBus;          // SSI0, the Nokia5110 or the ST7735
+
+#ifdef KERNEL_STATS
+static SoftTimer StatsTimer;        // has Display print the switch times
+static volatile uint8_t StatsDue;
+
+static void Stats_Due(void){
+    StatsDue = 1;
+    Kernel_Signal(&DisplayTask);
+}
+
+// Print the context switch counters measured by PendSV_Handler
+static void Stats_Print(void){
+    const KernelStats *s = Kernel_Stats();
+    UART0_OutString("PendSV cycles last ");
+    UART0_OutUDec(s->last);
+    UART0_OutString(" max ");
+    UART0_OutUDec(s->max);
+    UART0_OutString(" switches ");
+    UART0_OutUDec(s->switches);
+    UART0_OutString("\r\n");
+}
+#endif
+
+static void Control_Wake(void){
+    Kernel_Signal(&ControlTask);
+}
+
+void Control_Run(void){
+    while(1){
+        while(Event_Dispatch()){};
+        Kernel_Signal(&DisplayTask);    // redraw what they changed
+        Kernel_Wait();                  // until the next post
     }
-    
-    // Playing sound
-    if((device & SPEAKER)== SPEAKER){
-        if(SoundTime < 59) BUZZER ^= 0x10;
-        else if(SoundTime == 59){
-            BUZZER &= ~0x10;
-            device &= ~SPEAKER;
+}
+
+void Display_Run(void){
+    while(1){
+        Kernel_Wait();
+        Kernel_Lock(&SsiBus);
+        Redraw();
+        Kernel_Unlock(&SsiBus);
+        Settings_Poll();
+#ifdef KERNEL_STATS
+        if(StatsDue){
+            StatsDue = 0;
+            Stats_Print();
         }
+#endif
     }
-    SoundTime = ++SoundTime%60;
+}
+#endif
 
+// Wake_Background
+//  - have the display redrawn and the state written if it is time,
+//    from a timer.
+void Wake_Background(void){
+#ifdef KERNEL
+    Kernel_Signal(&DisplayTask);
+#else
+    SoftTimer_Wake();
+#endif
 }
 
 // Main
@@ -379,20 +627,43 @@ void SysTick_Handler(void){
 //
 int main(void){
     PLL_Init();              // 50MHz PLL                
+    Timebase_Init();         // 64-bit timebase for delays and timestamps
     UART0_Init();            // To display value received from BT on Serial Terminal
     UART1_Init();            // BlueTooth Module Init
     Keypad_Init();           // Keypad 
     PortE_Init();            // Relays and Buzzer Init
+    Restore_State();         // Devices and brightness from the EEPROM
+#ifdef DISPLAY_ST7735
+    ST7735_StartInitR(INITR_REDTAB, &Display_Ready); // ST7735 Init, continues from TIMER2A
+    Dashboard_Init(Rooms, sizeof(Rooms)/sizeof(DashRoom), &device, BRIGHT_MAX); // nothing sent yet
+#else
     Nokia5110_Init();        // Nokia5110 Init
-    SysTick_Init( 1666666 ); // 30Hz Systick Interrupt 
-    Timer0_Init(&Nokia_Task, 833333); // initialize timer0 (60 Hz) for Nokia5110
+    Widget_Init(&Display_Nokia5110, Pages, sizeof(Pages)/sizeof(WidgetPage)); // status pages
+#endif
+    SoftTimer_Init();        // timers on TIMER3A, no periodic interrupt
+    Event_Add(&BluetoothQueue);
+    Event_Add(&KeyQueue);
+    UART1_RxTask(&Bluetooth_Rx); // post each character from the Slave
+#ifdef KERNEL
+    Event_OnPost(&Control_Wake); // posts run the Control task
+    Kernel_Add(&ControlTask);
+    Kernel_Add(&DisplayTask);
+#ifdef KERNEL_STATS
+    SoftTimer_Start(&StatsTimer, &Stats_Due, 10000, 10000);
+#endif
+#endif
+#ifdef DISPLAY_ST7735
+    SoftTimer_Start(&ClockTimer, &Wake_Background, 1000, 1000); // link age, sparkline
+#endif
     EnableInterrupts();      // Enable interrupts
     
     UART0_OutString("Starting...\r\n");
     
-    while(1){
-        WaitForInterrupt();
-    }
+#ifdef KERNEL
+    Kernel_Start();          // the tasks from now on
+#else
+    Event_Run(&Background);  // sleeps until a key, a character or a timer
+#endif
 }
 
 
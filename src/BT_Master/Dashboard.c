@@ -0,0 +1,257 @@
+// Dashboard.c
+// Runs on LM4F120/TM4C123
+// Status dashboard of the Master on the ST7735 160x128 color LCD,
+// used instead of the Nokia5110 pages when DISPLAY_ST7735 is
+// defined.  The screen is described again on every update and
+// drawn through TileRender, so only the tiles whose contents
+// changed (a room switched, a bar moved, a new motion sample)
+// are sent to the LCD.
+// Chanartip Soonthornwan
+
+#include <stdint.h>
+#include "../lib/ST7735.h"
+#include "../lib/TileRender.h"
+#include "../lib/Timebase.h"
+#include "../lib/Pixel.h"
+#include "Dashboard.h"
+
+// Layout, landscape.  Room tiles are the size of one TileRender
+// tile, so switching a device repaints exactly one tile.
+#define HEAD_H      16
+#define ROOM_W      TILE_W
+#define ROOM_H      TILE_BAND_H
+#define ROOM_COLS   5
+#define ROOM_TOP    HEAD_H
+#define BAR_TOP     (ROOM_TOP + 2*ROOM_H)
+#define BAR_H       16
+#define BAR_X       32                  // left edge of the bar frame
+#define BAR_W       96                  // width of the bar frame
+#define SPARK_TOP   (BAR_TOP + DASH_MAX_BARS*BAR_H)
+#define SPARK_BASE  126                 // bottom row of the sparkline
+#define SPARK_H     30                  // height of a full column
+#define SPARK_COL_W 8                   // 6 pixel column and 2 pixel gap
+#define SPARK_FULL  4                   // reports in a slot drawn full height
+
+// Colors
+#define BG_COLOR    ST7735_BLACK
+#define HEAD_COLOR  PIXEL_565(0, 0, 128)
+#define ON_COLOR    PIXEL_565(0, 200, 0)
+#define OFF_COLOR   PIXEL_565(48, 48, 48)
+#define DIM_COLOR   PIXEL_565(128, 128, 128)
+#define FRAME_COLOR PIXEL_565(80, 80, 80)
+#define SPARK_COLOR PIXEL_565(0, 128, 255)
+
+#define SLOT_TICKS  TIMEBASE_MS(1000*DASH_SPARK_SEC)
+
+static const DashRoom *Rooms;
+static unsigned char NumRooms;
+static const volatile unsigned int *Device;
+static unsigned int LevelMax;
+
+static volatile uint32_t LinkEvents;    // counted by the ISRs
+static volatile uint32_t MotionEvents;
+static uint32_t LinkSeen, MotionSeen;   // counts already handled
+static uint8_t Heard;                   // 1 once the Slave has talked
+static uint64_t LastHeard;              // time of the last character
+static uint8_t Spark[DASH_SPARK_N];     // reports per slot
+static uint8_t Slot;                    // slot being filled
+static uint64_t SlotStart;              // time the slot began
+static uint8_t Landscape;               // 1 once the LCD was switched to landscape
+
+// Strings must stay valid until Tile_End()
+static char LinkText[10];
+static char PctText[DASH_MAX_BARS][5];
+
+//********Dashboard_Init*****************
+// Set the rooms to show.  Nothing is sent to the LCD, so it may
+// still be initializing; the first Dashboard_Update() switches it
+// to landscape and draws the whole screen.
+// inputs: rooms     array of rooms, the first DASH_MAX_ROOMS are shown
+//         count     number of rooms
+//         device    device flags tested with each room's mask
+//         levelMax  full scale brightness of the bars
+// outputs: none
+void Dashboard_Init(const DashRoom *rooms, unsigned char count,
+                    const volatile unsigned int *device, unsigned int levelMax){
+  Rooms = rooms;
+  NumRooms = (count > DASH_MAX_ROOMS) ? DASH_MAX_ROOMS : count;
+  Device = device;
+  LevelMax = levelMax ? levelMax : 1;
+  SlotStart = Timebase_Now();
+  Landscape = 0;
+}
+
+//********Dashboard_Link*****************
+// Note that a character was received from the Slave.  Safe to
+// call from an ISR.
+// inputs: none
+// outputs: none
+void Dashboard_Link(void){
+  LinkEvents = LinkEvents + 1;
+}
+
+//********Dashboard_Motion*****************
+// Count a PIR motion report in the current sparkline slot.  Safe
+// to call from an ISR.
+// inputs: none
+// outputs: none
+void Dashboard_Motion(void){
+  MotionEvents = MotionEvents + 1;
+}
+
+// Write n in decimal followed by suffix, return the end of the string.
+static char *udec(char *pt, unsigned int n, const char *suffix){
+  char digits[10];
+  int i = 0;
+  do{
+    digits[i] = '0' + n%10;
+    n = n/10;
+    i = i + 1;
+  } while(n);
+  while(i){
+    i = i - 1;
+    *pt++ = digits[i];
+  }
+  while(*suffix){
+    *pt++ = *suffix++;
+  }
+  *pt = 0;
+  return pt;
+}
+
+// Move the counts from the ISRs into the dashboard state.
+static void collect(uint64_t now){
+  uint32_t n;
+  n = LinkEvents;
+  if(n != LinkSeen){
+    LinkSeen = n;
+    LastHeard = now;
+    Heard = 1;
+  }
+  while(now - SlotStart >= SLOT_TICKS){ // start the next slot(s)
+    Slot = (Slot + 1)%DASH_SPARK_N;
+    Spark[Slot] = 0;
+    SlotStart = SlotStart + SLOT_TICKS;
+  }
+  n = MotionEvents;
+  if(n - MotionSeen > (uint32_t)(255 - Spark[Slot])){
+    Spark[Slot] = 255;
+  } else{
+    Spark[Slot] = Spark[Slot] + (n - MotionSeen);
+  }
+  MotionSeen = n;
+}
+
+// Title bar with the time since the Slave was last heard from
+static void drawHeader(uint64_t now){
+  uint32_t age;
+  char *pt;
+  int16_t len;
+  Tile_FillRect(0, 0, ST7735_GetWidth(), HEAD_H, HEAD_COLOR);
+  Tile_Text(2, 4, "HOME", ST7735_WHITE, ST7735_WHITE, 1);
+  if(!Heard){
+    Tile_Text(ST7735_GetWidth() - 2 - 6*7, 4, "NO LINK", DIM_COLOR, DIM_COLOR, 1);
+    return;
+  }
+  age = (uint32_t)((now - LastHeard)/BUS_CLOCK);
+  LinkText[0] = 'L'; LinkText[1] = 'I'; LinkText[2] = 'N'; LinkText[3] = 'K'; LinkText[4] = ' ';
+  if(age < 60){
+    pt = udec(&LinkText[5], age, "s");
+  } else if(age < 3600){
+    pt = udec(&LinkText[5], age/60, "m");
+  } else if(age < 100*3600UL){
+    pt = udec(&LinkText[5], age/3600, "h");
+  } else{
+    pt = udec(&LinkText[5], 99, "h");
+  }
+  len = pt - LinkText;
+  Tile_Text(ST7735_GetWidth() - 2 - 6*len, 4, LinkText, ON_COLOR, ON_COLOR, 1);
+}
+
+// One tile per room, filled when the device is on
+static void drawRooms(void){
+  const DashRoom *r;
+  int16_t x, y, len;
+  unsigned char i;
+  uint16_t fill, text;
+  for(i=0, r=Rooms; i<NumRooms; i=i+1, r=r+1){
+    x = (i%ROOM_COLS)*ROOM_W;
+    y = ROOM_TOP + (i/ROOM_COLS)*ROOM_H;
+    if((*Device)&r->mask){
+      fill = ON_COLOR; text = ST7735_BLACK;
+    } else{
+      fill = OFF_COLOR; text = DIM_COLOR;
+    }
+    for(len=0; r->name[len] && (len < 5); len=len+1){};
+    Tile_FillRect(x + 1, y + 1, ROOM_W - 2, ROOM_H - 2, fill);
+    Tile_Text(x + (ROOM_W - 6*len + 1)/2, y + 4, r->name, text, text, 1);
+  }
+}
+
+// A bar and percentage for each room with a brightness level
+static void drawBars(void){
+  const DashRoom *r;
+  unsigned int level;
+  int16_t y, w;
+  unsigned char i, bar = 0;
+  uint16_t color;
+  for(i=0, r=Rooms; (i<NumRooms) && (bar<DASH_MAX_BARS); i=i+1, r=r+1){
+    if(r->level == 0){
+      continue;
+    }
+    level = *r->level;
+    if(level > LevelMax){
+      level = LevelMax;
+    }
+    y = BAR_TOP + bar*BAR_H;
+    color = ((*Device)&r->mask) ? ST7735_YELLOW : DIM_COLOR;
+    w = (int16_t)(((uint32_t)level*(BAR_W - 2))/LevelMax);
+    udec(PctText[bar], ((uint32_t)level*100 + LevelMax/2)/LevelMax, "%");
+    Tile_Text(2, y + 4, r->name, ST7735_WHITE, ST7735_WHITE, 1);
+    Tile_FillRect(BAR_X, y + 3, BAR_W, 10, FRAME_COLOR);
+    Tile_FillRect(BAR_X + 1, y + 4, w, 8, color);
+    Tile_Text(BAR_X + BAR_W + 4, y + 4, PctText[bar], ST7735_WHITE, ST7735_WHITE, 1);
+    bar = bar + 1;
+  }
+}
+
+// Motion reports per slot.  The slots stay in place and the
+// cursor sweeps across them, so a new slot changes two tiles
+// instead of scrolling the whole graph.
+static void drawSpark(void){
+  int16_t x, h;
+  unsigned char i;
+  Tile_Text(2, SPARK_TOP + 4, "MOTION", ST7735_WHITE, ST7735_WHITE, 1);
+  for(i=0; i<DASH_SPARK_N; i=i+1){
+    h = (Spark[i] >= SPARK_FULL) ? SPARK_H : Spark[i]*SPARK_H/SPARK_FULL;
+    x = i*SPARK_COL_W;
+    if(h){
+      Tile_FillRect(x + 1, SPARK_BASE + 1 - h, SPARK_COL_W - 2, h,
+                    (i == Slot) ? ST7735_CYAN : SPARK_COLOR);
+    }
+  }
+  Tile_FillRect(Slot*SPARK_COL_W, SPARK_BASE + 1, SPARK_COL_W, 1, ST7735_WHITE);
+}
+
+//********Dashboard_Update*****************
+// Redraw the parts of the dashboard that changed.  Called
+// after each change and at least once a second, for the link
+// age and the sparkline.
+// inputs: none
+// outputs: none
+// assumes: the ST7735 initialization has finished
+void Dashboard_Update(void){
+  uint64_t now = Timebase_Now();
+  if(!Landscape){
+    ST7735_SetRotation(1);
+    Tile_Invalidate();                  // every tile is sent, which clears the screen
+    Landscape = 1;
+  }
+  collect(now);
+  Tile_Begin(BG_COLOR);
+  drawHeader(now);
+  drawRooms();
+  drawBars();
+  drawSpark();
+  Tile_End();
+}
@@ -0,0 +1,66 @@
+// Dashboard.h
+// Runs on LM4F120/TM4C123
+// Status dashboard of the Master on the ST7735 160x128 color LCD,
+// used instead of the Nokia5110 pages when DISPLAY_ST7735 is
+// defined.  The screen is described again on every update and
+// drawn through TileRender, so only the tiles whose contents
+// changed (a room switched, a bar moved, a new motion sample)
+// are sent to the LCD.
+// Chanartip Soonthornwan
+
+//  y   0-15   title and link status, time since the Slave last talked
+//  y  16-47   room tiles, 5 per row, filled when the device is on
+//  y  48-79   brightness bars of the rooms that have a level
+//  y  80-127  PIR activity sparkline, one column per time slot,
+//             swept left to right with a cursor under the current slot
+
+#ifndef __DASHBOARD_H__ // do not include more than once
+#define __DASHBOARD_H__
+
+#define DASH_MAX_ROOMS  10    // room tiles shown
+#define DASH_MAX_BARS   2     // brightness bars shown
+#define DASH_SPARK_N    20    // time slots in the sparkline
+#define DASH_SPARK_SEC  30    // seconds per slot, 10 minutes shown
+
+typedef struct {
+  const char *name;                     // up to 5 characters
+  unsigned int mask;                    // device flag of the room
+  const volatile unsigned int *level;   // brightness shown as a bar, 0 for none
+} DashRoom;
+
+//********Dashboard_Init*****************
+// Set the rooms to show.  Nothing is sent to the LCD, so it may
+// still be initializing; the first Dashboard_Update() switches it
+// to landscape and draws the whole screen.
+// inputs: rooms     array of rooms, the first DASH_MAX_ROOMS are shown
+//         count     number of rooms
+//         device    device flags tested with each room's mask
+//         levelMax  full scale brightness of the bars
+// outputs: none
+void Dashboard_Init(const DashRoom *rooms, unsigned char count,
+                    const volatile unsigned int *device, unsigned int levelMax);
+
+//********Dashboard_Link*****************
+// Note that a character was received from the Slave.  Safe to
+// call from an ISR.
+// inputs: none
+// outputs: none
+void Dashboard_Link(void);
+
+//********Dashboard_Motion*****************
+// Count a PIR motion report in the current sparkline slot.  Safe
+// to call from an ISR.
+// inputs: none
+// outputs: none
+void Dashboard_Motion(void);
+
+//********Dashboard_Update*****************
+// Redraw the parts of the dashboard that changed.  Called
+// after each change and at least once a second, for the link
+// age and the sparkline.
+// inputs: none
+// outputs: none
+// assumes: the ST7735 initialization has finished
+void Dashboard_Update(void);
+
+#endif // __DASHBOARD_H__
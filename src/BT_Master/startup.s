@@ -325,10 +325,6 @@ DebugMon_Handler\
                 EXPORT  DebugMon_Handler          [WEAK]
                 B       .
                 ENDP
-PendSV_Handler  PROC
-                EXPORT  PendSV_Handler            [WEAK]
-                B       .
-                ENDP
 SysTick_Handler PROC
                 EXPORT  SysTick_Handler           [WEAK]
                 B       .
@@ -594,6 +590,8 @@ PWM1Fault_Handler
         EXPORT  StartCritical
         EXPORT  EndCritical
         EXPORT  WaitForInterrupt
+        EXPORT  PendSV_Handler
+        IMPORT  KernelRun
 
 ;*********** DisableInterrupts ***************
 ; disable interrupts
@@ -636,6 +634,46 @@ WaitForInterrupt
         WFI
         BX     LR
 
+;*********** PendSV_Handler ************************
+; context switch of the kernel (Kernel.c), pended by its scheduler
+; at priority 7, after every other interrupt.  The hardware pushed
+; R0-R3, R12, LR, PC and xPSR on the task's stack (PSP); R4-R11 go
+; under them, and the next task is loaded the same way.  SysTick,
+; free running and counting down, times it into KernelRun.stats.
+; inputs:  KernelRun.current  task to save, 0 the first time
+;          KernelRun.next     task to run
+; outputs: none
+PendSV_Handler
+        LDR    R3, =0xE000E018  ; NVIC_ST_CURRENT_R
+        LDR    R12, [R3]        ; time of entry
+        CPSID  I
+        LDR    R2, =KernelRun
+        LDR    R0, [R2]         ; R0 = current
+        CBZ    R0, PendSV_Load  ; main's stack is left as it is
+        MRS    R1, PSP
+        STMDB  R1!, {R4-R11}    ; save the rest of the context
+        STR    R1, [R0]         ; current->sp
+PendSV_Load
+        LDR    R0, [R2, #4]     ; R0 = next
+        STR    R0, [R2]         ; current = next
+        LDR    R1, [R0]         ; next->sp
+        LDMIA  R1!, {R4-R11}    ; its context, but the hardware's part
+        MSR    PSP, R1
+        LDR    R1, [R2, #8]     ; stats.switches += 1
+        ADD    R1, R1, #1
+        STR    R1, [R2, #8]
+        LDR    R1, [R3]         ; time now
+        SUB    R1, R12, R1      ; cycles taken, SysTick counts down
+        UBFX   R1, R1, #0, #24  ; over 24 bits
+        STR    R1, [R2, #12]    ; stats.last
+        LDR    R0, [R2, #16]
+        CMP    R1, R0
+        IT     HI
+        STRHI  R1, [R2, #16]    ; stats.max
+        CPSIE  I
+        ORR    LR, LR, #0x04    ; return to thread mode on the PSP
+        BX     LR
+
 ;******************************************************************************
 ;
 ; The function expected of the C library startup code for defining the stack
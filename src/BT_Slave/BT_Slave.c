@@ -26,6 +26,11 @@
 #include "../lib/PLL.h"
 #include "../lib/UART.h"
 #include "../lib/PWM.h"
+#include "../lib/Timebase.h"
+#include "../lib/Scene.h"
+#include "../lib/Settings.h"
+#include "../lib/SoftTimer.h"
+#include "../lib/Event.h"
 
 #define HALL_PIR  (*((volatile unsigned long *)0x40024004))       // PE0
 #define BATH_PIR  (*((volatile unsigned long *)0x40024008))       // PE1
@@ -33,15 +38,40 @@
 #define HALLWAY   0x0001
 #define BATHROOM  0x0002
 
+#define PWM_PERIOD    1250          // 20 kHz at 25 MHz, dithered to 8 more bits
+#define FADE_ON_MS    400           // light coming on
+#define FADE_OFF_MS   1500          // light going off, slow enough to notice
+#define FADE_STEP_MS  150           // brightness step from the Master
+
+#define LEVEL_STEP    12            // brightness step, in perceptual levels
+#define LEVEL_DEFAULT 230           // brightness at power up, 0 to PWM_LEVEL_MAX
+
 void DisableInterrupts(void);       // Disable interrupts
 void EnableInterrupts(void);        // Enable interrupts
 void WaitForInterrupt(void);        // low power mode
 void PIR_Init(void);                // PIR sensor init
-void SysTick_Init(unsigned long);   // Systick Interrupt Init
+void Bluetooth_Task(unsigned char c); // Act on a character from the Master
+void PIR_Task(unsigned char e);     // Act on a PIR edge
+void Apply_Scene(const Scene *s);   // Fade the LED strips to a scene
+void Save_State(void);              // Stage the state for the EEPROM
 
 unsigned int device;
-unsigned int bathroom_brightness;
+unsigned int bathroom_brightness;   // perceptual level, 0 to PWM_LEVEL_MAX
 unsigned int hallway_brightness;
+static SoftTimer SaveTimer;         // wakes main to write the state
+
+// Events posted by the ISRs, run from main by Event_Run()
+EVENT_QUEUE(BluetoothQueue, 16, EVENT_PRIORITY_HIGH, &Bluetooth_Task); // characters
+EVENT_QUEUE(PirQueue, 8, EVENT_PRIORITY_HIGH+1, &PIR_Task); // (edges<<2)|levels of PE0,1
+
+// State kept in the EEPROM over resets, see Settings.h.
+// Change STATE_VERSION when the layout changes.
+#define STATE_VERSION 1
+typedef struct {
+    uint8_t hallway;                // hallway_brightness
+    uint8_t bathroom;               // bathroom_brightness
+    uint8_t device;                 // HALLWAY and BATHROOM turned on by the Master
+} State;
 
 /*
     Initialization
@@ -63,153 +93,188 @@ void PIR_Init(void){ volatile unsigned long delay;
   NVIC_EN0_R |= 0x00000010;             // Enable PortE Interrupt Enable Register
 }
 
-/*
- * SysTick Init
- *      initializes system timer with Interrupt Enable for
- *      utilizing Systick_Handler as an Interrupt Service Routine(ISR)
- */
-void SysTick_Init(unsigned long period) {
-    NVIC_ST_CTRL_R = 0;         // disable SysTick during setup
-    NVIC_ST_RELOAD_R = period-1;// reload value
-    NVIC_ST_CURRENT_R = 0;      // any write to current clears it
-    NVIC_SYS_PRI3_R = (NVIC_SYS_PRI3_R&0x00FFFFFF)|0xC0000000; // priority 6
-    // enable SysTick with core clock and interrupts
-    NVIC_ST_CTRL_R = NVIC_ST_CTRL_ENABLE+NVIC_ST_CTRL_CLK_SRC+NVIC_ST_CTRL_INTEN;
+// Post which PIRs changed and their levels, acted on by PIR_Task()
+void GPIOPortE_Handler(void){
+    unsigned long edges = GPIO_PORTE_RIS_R & 0x03;
+    GPIO_PORTE_ICR_R = edges;               // Acknowledge PE0,1
+    Event_Post(&PirQueue, (edges<<2)|HALL_PIR|BATH_PIR);
 }
 
-void GPIOPortE_Handler(void){
-    if((GPIO_PORTE_RIS_R & 0x01) == 0x01){
-        GPIO_PORTE_ICR_R |= 0x01;           // Acknowledge PE0  
+/*
+ * PIR_Task
+ *      turns a strip on or off as its PIR changes, unless the
+ *      Master turned it on, and tells the Master.
+ */
+void PIR_Task(unsigned char e){
+    if(e & (0x01<<2)){                      // PE0 changed
         
         if((device&HALLWAY)!=HALLWAY){      // if HALLWAY is off.
-            if(HALL_PIR == 0x01) {
+            if(e & 0x01) {
                 UART1_OutChar('%');         // Indicate Master that HALLWAY is on.
-                M0PWM0_Duty(hallway_brightness);// Assign current Brightness
+                PWM_SetLevel(PWM_CH0, hallway_brightness, FADE_ON_MS, PWM_FADE_EASE);// Assign current Brightness
             }
             else{
                 UART1_OutChar('_');         // Indicate Master that HALLWAY is off.
-                M0PWM0_Duty(2);             // Turn off PWM
+                PWM_SetLevel(PWM_CH0, 0, FADE_OFF_MS, PWM_FADE_EASE); // Turn off PWM
             }
         }
         
     }
     
-    if((GPIO_PORTE_RIS_R & 0x02) == 0x02){
-        GPIO_PORTE_ICR_R |=  0x02;           // Acknowledge PE2   
+    if(e & (0x02<<2)){                      // PE1 changed
         
         if((device&BATHROOM)!=BATHROOM){    // if BATHROOM is off.
             
-            if(BATH_PIR == 0x02) {
+            if(e & 0x02) {
                 UART1_OutChar('$');         // Indicate Master that BATHROOM is on.
-                M0PWM2_Duty(bathroom_brightness);// Assign current Brightness
+                PWM_SetLevel(PWM_CH2, bathroom_brightness, FADE_ON_MS, PWM_FADE_EASE);// Assign current Brightness
             }
             else{
                 UART1_OutChar('-');         // Indicate Master that BATHROOM is off.
-                M0PWM2_Duty(2);             // Turn off PWM
+                PWM_SetLevel(PWM_CH2, 0, FADE_OFF_MS, PWM_FADE_EASE); // Turn off PWM
             }
         }
     }
 }
+/*
+ * Apply_Scene
+ *      fades both LED strips to the levels of a scene, starting
+ *      and ending in the same PWM period.  A strip at level 0 is
+ *      turned off; the others are turned on, so the PIRs leave
+ *      them alone, and become the brightness 'A' to 'D' step from.
+ */
+void Apply_Scene(const Scene *s){
+    PWM_Begin();
+    PWM_SetLevel(PWM_CH0, s->level[SCENE_HALLWAY],  s->ms, s->curve);
+    PWM_SetLevel(PWM_CH2, s->level[SCENE_BATHROOM], s->ms, s->curve);
+    PWM_Commit();
+    
+    if(s->level[SCENE_HALLWAY]){
+        device |= HALLWAY;
+        hallway_brightness = s->level[SCENE_HALLWAY];
+    }
+    else device &= ~HALLWAY;
+    
+    if(s->level[SCENE_BATHROOM]){
+        device |= BATHROOM;
+        bathroom_brightness = s->level[SCENE_BATHROOM];
+    }
+    else device &= ~BATHROOM;
+    
+    UART0_OutString(" scene ");     // after the echoed character
+    UART0_OutString((char *)s->name);
+    UART0_OutString("\r\n");
+}
+
+/*
+ * Save_State
+ *      stages the brightness and the strips turned on for the
+ *      EEPROM; a run of changes is written once, by main, which
+ *      a timer wakes when the quiet time is over.
+ */
+void Save_State(void){
+    State state;
+    state.hallway  = hallway_brightness;
+    state.bathroom = bathroom_brightness;
+    state.device   = device&(HALLWAY|BATHROOM);
+    Settings_Save(&state, sizeof(state));
+    SoftTimer_Start(&SaveTimer, &SoftTimer_Wake, SETTINGS_HOLD_MS+1, 0);
+}
+
 /***************************************************************************
- * Interrupts, ISR
- *      - Consistently check Bluetooth input at 30Hz and take action
- *          based on the Bluetooth input; updating devices status
+ * Event handlers
+ *      - Run from main with each character from the Master, posted
+ *          by the UART1 interrupt; updating devices status
  *          and adjusting brightness.
  ***************************************************************************/
-void SysTick_Handler(void){
+static void Bluetooth_Rx(unsigned char c){
+    Event_Post(&BluetoothQueue, c);
+}
 
-    static char bt_data;
-    static char key,prev_key;
-    
-    // Save the previous key
-    prev_key = key;
-    
-    // Check input from Bluetooth
-    //  
-    bt_data = UART1_NonBlockingInChar();
-    if(bt_data != 0) {
-        key = bt_data;
-        UART0_OutChar(bt_data);
-    }
-    else{
-        key = 0;
-    }
+void Bluetooth_Task(unsigned char key){
+
+    const Scene *scene;
     
-    // Take action when there is a change on the key 
-    if(prev_key != key){
-        switch(key){
-            case '0':{ 
-                device  &= ~HALLWAY;    // Turn off HALLWAY
-                M0PWM0_Duty(2);         // Low the PWM
-                break; }
-            case '1': {
-                device  |= HALLWAY;     // Turn on HALLWAY
-                M0PWM0_Duty(hallway_brightness);// Assign PWM
-                break;
-            }
-            case '2':{
-                device  &= ~BATHROOM;   // Turn off BATHROOM
-                M0PWM2_Duty(2);         // Low the PWM
-                break;
-            }
-            case '3': {
-                device  |= BATHROOM;    // Turn on BATHROOM
-                M0PWM2_Duty(bathroom_brightness);// Assign PWM
-                break;
-            }
-            case 'A':{
-                // Increment PWM duty but within it's period
-                if(hallway_brightness+3500 > 50000){
-                    hallway_brightness = 49999;
-                }
-                else hallway_brightness += 3500;
-                
-                // Updating Brightness 
-                M0PWM0_Duty(hallway_brightness);
-                break;
-            }
-            case 'B':{
-                // Decrement PWM duty but within it's period
-                if(hallway_brightness-3500 < 3500){
-                    hallway_brightness = 3500;
-                }
-                else hallway_brightness -= 3500;
-                
-                // Updating Brightness 
-                M0PWM0_Duty(hallway_brightness);
-                break;
+    UART0_OutChar(key);    // echo
+    switch(key){
+        case '0':{ 
+            device  &= ~HALLWAY;    // Turn off HALLWAY
+            PWM_SetLevel(PWM_CH0, 0, FADE_OFF_MS, PWM_FADE_EASE); // Low the PWM
+            break; }
+        case '1': {
+            device  |= HALLWAY;     // Turn on HALLWAY
+            PWM_SetLevel(PWM_CH0, hallway_brightness, FADE_ON_MS, PWM_FADE_EASE);// Assign PWM
+            break;
+        }
+        case '2':{
+            device  &= ~BATHROOM;   // Turn off BATHROOM
+            PWM_SetLevel(PWM_CH2, 0, FADE_OFF_MS, PWM_FADE_EASE); // Low the PWM
+            break;
+        }
+        case '3': {
+            device  |= BATHROOM;    // Turn on BATHROOM
+            PWM_SetLevel(PWM_CH2, bathroom_brightness, FADE_ON_MS, PWM_FADE_EASE);// Assign PWM
+            break;
+        }
+        case 'A':{
+            // Increment PWM duty but within it's period
+            if(hallway_brightness+LEVEL_STEP > PWM_LEVEL_MAX){
+                hallway_brightness = PWM_LEVEL_MAX;
             }
-            case 'C':{
-                // Increment PWM duty but within it's period
-                if(bathroom_brightness+3500 > 50000){
-                    bathroom_brightness = 49999;
-                }
-                else bathroom_brightness += 3500;
-                
-                // Updating Brightness 
-                M0PWM2_Duty(bathroom_brightness);
-                break;
+            else hallway_brightness += LEVEL_STEP;
+            
+            // Updating Brightness 
+            PWM_SetLevel(PWM_CH0, hallway_brightness, FADE_STEP_MS, PWM_FADE_LINEAR);
+            break;
+        }
+        case 'B':{
+            // Decrement PWM duty but within it's period
+            if(hallway_brightness < 2*LEVEL_STEP){
+                hallway_brightness = LEVEL_STEP;
             }
-            case 'D':{
-                // Decrement PWM duty but within it's period
-                if(bathroom_brightness-3500 < 3500){
-                    bathroom_brightness = 3500;
-                }
-                else bathroom_brightness -= 3500;
-                
-                // Updating Brightness 
-                M0PWM2_Duty(bathroom_brightness);
-                break;
+            else hallway_brightness -= LEVEL_STEP;
+            
+            // Updating Brightness 
+            PWM_SetLevel(PWM_CH0, hallway_brightness, FADE_STEP_MS, PWM_FADE_LINEAR);
+            break;
+        }
+        case 'C':{
+            // Increment PWM duty but within it's period
+            if(bathroom_brightness+LEVEL_STEP > PWM_LEVEL_MAX){
+                bathroom_brightness = PWM_LEVEL_MAX;
             }
-            case '#':{
-                // Turn all off signal from Master
-                device &= ~(HALLWAY|BATHROOM);
-                M0PWM0_Duty(2); // Low the light
-                M0PWM2_Duty(2); // Low the light
-                break;
+            else bathroom_brightness += LEVEL_STEP;
+            
+            // Updating Brightness 
+            PWM_SetLevel(PWM_CH2, bathroom_brightness, FADE_STEP_MS, PWM_FADE_LINEAR);
+            break;
+        }
+        case 'D':{
+            // Decrement PWM duty but within it's period
+            if(bathroom_brightness < 2*LEVEL_STEP){
+                bathroom_brightness = LEVEL_STEP;
             }
+            else bathroom_brightness -= LEVEL_STEP;
+            
+            // Updating Brightness 
+            PWM_SetLevel(PWM_CH2, bathroom_brightness, FADE_STEP_MS, PWM_FADE_LINEAR);
+            break;
+        }
+        case '#':{
+            // Turn all off signal from Master
+            device &= ~(HALLWAY|BATHROOM);
+            PWM_SetLevel(PWM_CH0, 0, FADE_OFF_MS, PWM_FADE_EASE); // Low the light
+            PWM_SetLevel(PWM_CH2, 0, FADE_OFF_MS, PWM_FADE_EASE); // Low the light
+            break;
+        }
+        default:{
+            // 'E' to 'H', a scene for both strips
+            scene = Scene_Find(key);
+            if(scene != 0) Apply_Scene(scene);
+            break;
         }
     }
+    Save_State();
 }
 
 
@@ -217,21 +282,43 @@ void SysTick_Handler(void){
  Main function / loop.
 ***************************************************************************/
 int main( void ) {
+    State state;
 
     PLL_Init();                 // 50MHz
+    Timebase_Init();            // 64-bit timebase for delays and timestamps
     UART0_Init();               // UART0 (microUSB port)
     UART1_Init();               // UART1 (PB0(RX) to TX pin, PB1(TX) to RX pin)
     PIR_Init();                 // PIR sensor init
-    M0PWM0_M0PM2_Init(50000,2); // PWM for Bathroom and Hallway init 
-    SysTick_Init( 1666666 );    // 30Hz Systick Interrupt 
+    M0PWM0_M0PM2_Init(PWM_PERIOD,0); // PWM for Bathroom and Hallway init, off
+    PWM_Dither(PWM_CH0, PWM_DITHER_FADES); // no flicker on camera, smooth dimming,
+    PWM_Dither(PWM_CH2, PWM_DITHER_FADES); // and no tick once the fades end
+    SoftTimer_Init();           // timers on TIMER3A, no periodic interrupt
+    Event_Add(&BluetoothQueue);
+    Event_Add(&PirQueue);
+    UART1_RxTask(&Bluetooth_Rx); // post each character from the Master
+    
+    // Restore the last state, or start with the strips off
+    state.hallway = state.bathroom = LEVEL_DEFAULT;
+    state.device = 0;
+    Settings_Init(STATE_VERSION, &state, sizeof(state));
+    hallway_brightness  = state.hallway;
+    bathroom_brightness = state.bathroom;
+    device = state.device&(HALLWAY|BATHROOM);
     EnableInterrupts();
     
     UART0_OutString(">>> Welcome to Serial Terminal <<<\r\n"); 
-    hallway_brightness = bathroom_brightness = 40000;
     UART1_OutChar('@');         // Indicate Master as it's just Turn on.
+    if(device&HALLWAY){         // back on, as if the PIR saw someone
+        PWM_SetLevel(PWM_CH0, hallway_brightness, FADE_ON_MS, PWM_FADE_EASE);
+        UART1_OutChar('%');
+    }
+    if(device&BATHROOM){
+        PWM_SetLevel(PWM_CH2, bathroom_brightness, FADE_ON_MS, PWM_FADE_EASE);
+        UART1_OutChar('$');
+    }
     
-    while(1) {
-        WaitForInterrupt();
-    } //end while
+    // Run the events, write the state once it stops changing, and
+    // sleep until a character, a PIR or a timer
+    Event_Run(&Settings_Poll);
 } //end main
 
@@ -0,0 +1,119 @@
+// Display.c
+// Runs on LM4F120/TM4C123
+// Thin display interface shared by the Nokia5110, the ST7735 and
+// an in-memory framebuffer for testing on a PC.  These functions
+// call the backend and, when DISPLAY_STATS is defined, count
+// what each backend was asked to do and how long it took.
+// Chanartip Soonthornwan
+
+#include <stdint.h>
+#include "Display.h"
+
+#ifdef DISPLAY_STATS
+#include "Timebase.h"
+#define BEGIN()          uint64_t start = Timebase_Now()
+#define END(d, n)        account(d, n, start)
+static void account(const Display *d, uint32_t pixels, uint64_t start){
+  if(d->stats){
+    d->stats->calls = d->stats->calls + 1;
+    d->stats->pixels = d->stats->pixels + pixels;
+    d->stats->cycles = d->stats->cycles + (Timebase_Now() - start);
+  }
+}
+
+// Pixels in the cells covered by a string
+static uint32_t textPixels(const Display *d, const char *pt){
+  uint32_t n = 0;
+  while(pt[n]){
+    n = n + 1;
+  }
+  return n*d->cellW*d->cellH;
+}
+#else
+#define BEGIN()
+#define END(d, n)
+#endif
+
+//********Display_Width*****************
+// inputs: d  display
+// outputs: width in pixels
+int16_t Display_Width(const Display *d){
+  return d->width();
+}
+
+//********Display_Height*****************
+// inputs: d  display
+// outputs: height in pixels
+int16_t Display_Height(const Display *d){
+  return d->height();
+}
+
+//********Display_Clear*****************
+// Set every pixel to DISPLAY_BLACK.
+// inputs: d  display
+// outputs: none
+void Display_Clear(const Display *d){
+  BEGIN();
+  d->clear();
+  END(d, (uint32_t)d->width()*d->height());
+}
+
+//********Display_Text*****************
+// Draw a string on the text cell grid, cellW by cellH pixels per
+// character, clipped at the right edge.  On a 1 bpp display the
+// colors are ignored and text is drawn as set pixels on clear
+// cells.
+// inputs: d    display
+//         col  cell column of the first character
+//         row  cell row
+//         pt   null terminated string
+//         fg   16-bit color of the characters
+//         bg   16-bit color of the rest of the cells
+// outputs: none
+void Display_Text(const Display *d, uint8_t col, uint8_t row, const char *pt, uint16_t fg, uint16_t bg){
+  BEGIN();
+  d->text(col, row, pt, fg, bg);
+  END(d, textPixels(d, pt));
+}
+
+//********Display_FillRect*****************
+// Fill a rectangle, clipped to the screen.
+// inputs: d      display
+//         x, y   top left corner
+//         w, h   size in pixels
+//         color  16-bit color
+// outputs: none
+void Display_FillRect(const Display *d, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color){
+  BEGIN();
+  if((w > 0) && (h > 0)){
+    d->fillRect(x, y, w, h, color);
+  }
+  END(d, (w > 0) && (h > 0) ? (uint32_t)w*h : 0);
+}
+
+//********Display_Blit*****************
+// Copy a block of 16-bit pixels stored top row first, clipped
+// to the screen.
+// inputs: d       display
+//         x, y    top left corner
+//         buf     first pixel of the block
+//         w, h    size in pixels
+//         stride  pixels from one row of buf to the next
+// outputs: none
+void Display_Blit(const Display *d, int16_t x, int16_t y, const uint16_t *buf, int16_t w, int16_t h, int16_t stride){
+  BEGIN();
+  if((w > 0) && (h > 0)){
+    d->blit(x, y, buf, w, h, stride);
+  }
+  END(d, (w > 0) && (h > 0) ? (uint32_t)w*h : 0);
+}
+
+//********Display_Flush*****************
+// Send everything drawn since the last flush to the screen.
+// inputs: d  display
+// outputs: none
+void Display_Flush(const Display *d){
+  BEGIN();
+  d->flush();
+  END(d, 0);
+}
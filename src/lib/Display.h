@@ -0,0 +1,119 @@
+// Display.h
+// Runs on LM4F120/TM4C123
+// Thin display interface shared by the Nokia5110, the ST7735 and
+// an in-memory framebuffer for testing on a PC.  Each backend is
+// a table of functions; UI code such as Widget.c draws through
+// the Display_ functions below and works on any of them.
+// Chanartip Soonthornwan
+
+// Colors are 16-bit, in the format of ST7735_Color565().  A
+// 1 bit per pixel backend turns on every pixel that is not
+// DISPLAY_BLACK, which on the Nokia5110 is a dark pixel.
+// Drawing may be buffered: nothing is guaranteed to be on the
+// screen until Display_Flush().
+// Define DISPLAY_STATS to count the calls, pixels and bus clock
+// cycles spent in each backend, to compare rendering costs.
+
+#ifndef __DISPLAY_H__ // do not include more than once
+#define __DISPLAY_H__
+#include <stdint.h>
+
+#define DISPLAY_BLACK  0x0000
+#define DISPLAY_WHITE  0xFFFF
+
+typedef struct {
+  uint32_t calls;                       // drawing calls, including flushes
+  uint32_t pixels;                      // pixels covered by the calls
+  uint64_t cycles;                      // bus clock cycles spent in the backend
+} DisplayStats;
+
+typedef struct {
+  const char *name;
+  uint8_t bpp;                          // bits per pixel, 1 or 16
+  uint8_t cellW, cellH;                 // text cell size in pixels
+  int16_t (*width)(void);               // pixels, may change with rotation
+  int16_t (*height)(void);
+  void (*clear)(void);                  // all pixels DISPLAY_BLACK
+  void (*text)(uint8_t col, uint8_t row, const char *pt, uint16_t fg, uint16_t bg);
+  void (*fillRect)(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void (*blit)(int16_t x, int16_t y, const uint16_t *buf, int16_t w, int16_t h, int16_t stride);
+  void (*flush)(void);                  // send buffered drawing to the screen
+  DisplayStats *stats;                  // counters for DISPLAY_STATS
+} Display;
+
+// Backends
+extern const Display Display_Nokia5110; // 84x48, 1 bpp, 7x8 cells, buffered
+extern const Display Display_ST7735;    // 128x160 or 160x128, 16 bpp, 6x8 cells, direct
+extern const Display Display_Memory;    // RAM framebuffer, 16 bpp, 6x8 cells
+
+// Size of the Display_Memory framebuffer
+#ifndef DISPLAY_MEM_W
+#define DISPLAY_MEM_W  160
+#endif
+#ifndef DISPLAY_MEM_H
+#define DISPLAY_MEM_H  128
+#endif
+
+//********Display_Width*****************
+// inputs: d  display
+// outputs: width in pixels
+int16_t Display_Width(const Display *d);
+
+//********Display_Height*****************
+// inputs: d  display
+// outputs: height in pixels
+int16_t Display_Height(const Display *d);
+
+//********Display_Clear*****************
+// Set every pixel to DISPLAY_BLACK.
+// inputs: d  display
+// outputs: none
+void Display_Clear(const Display *d);
+
+//********Display_Text*****************
+// Draw a string on the text cell grid, cellW by cellH pixels per
+// character, clipped at the right edge.  On a 1 bpp display the
+// colors are ignored and text is drawn as set pixels on clear
+// cells.
+// inputs: d    display
+//         col  cell column of the first character
+//         row  cell row
+//         pt   null terminated string
+//         fg   16-bit color of the characters
+//         bg   16-bit color of the rest of the cells
+// outputs: none
+void Display_Text(const Display *d, uint8_t col, uint8_t row, const char *pt, uint16_t fg, uint16_t bg);
+
+//********Display_FillRect*****************
+// Fill a rectangle, clipped to the screen.
+// inputs: d      display
+//         x, y   top left corner
+//         w, h   size in pixels
+//         color  16-bit color
+// outputs: none
+void Display_FillRect(const Display *d, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+
+//********Display_Blit*****************
+// Copy a block of 16-bit pixels stored top row first, clipped
+// to the screen.
+// inputs: d       display
+//         x, y    top left corner
+//         buf     first pixel of the block
+//         w, h    size in pixels
+//         stride  pixels from one row of buf to the next
+// outputs: none
+void Display_Blit(const Display *d, int16_t x, int16_t y, const uint16_t *buf, int16_t w, int16_t h, int16_t stride);
+
+//********Display_Flush*****************
+// Send everything drawn since the last flush to the screen.
+// inputs: d  display
+// outputs: none
+void Display_Flush(const Display *d);
+
+//********Display_MemoryPixel*****************
+// Read back a pixel of the Display_Memory framebuffer.
+// inputs: x, y  pixel
+// outputs: 16-bit color, DISPLAY_BLACK outside the framebuffer
+uint16_t Display_MemoryPixel(int16_t x, int16_t y);
+
+#endif // __DISPLAY_H__
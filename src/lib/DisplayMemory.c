@@ -0,0 +1,200 @@
+// DisplayMemory.c
+// Runs on LM4F120/TM4C123 or a PC
+// Display backend that draws into a framebuffer in RAM, so UI
+// code can be run and checked on a PC, and its drawing cost
+// compared with the LCD backends without the bus in the way.
+// The framebuffer is DISPLAY_MEM_W by DISPLAY_MEM_H pixels (see
+// Display.h).  It has its own copy of the printable characters
+// of the ST7735 font, so it links without the LCD drivers; other
+// characters are drawn as blank cells.
+// Chanartip Soonthornwan
+
+#include <stdint.h>
+#include "Display.h"
+
+static DisplayStats Stats;
+static uint16_t Frame[DISPLAY_MEM_H][DISPLAY_MEM_W];
+
+// Printable characters 0x20 to 0x7E of the 5x8 font of ST7735.c,
+// five columns each, least significant bit on top
+static const uint8_t Font[] = {
+  0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x5F, 0x00, 0x00,
+  0x00, 0x07, 0x00, 0x07, 0x00,
+  0x14, 0x7F, 0x14, 0x7F, 0x14,
+  0x24, 0x2A, 0x7F, 0x2A, 0x12,
+  0x23, 0x13, 0x08, 0x64, 0x62,
+  0x36, 0x49, 0x56, 0x20, 0x50,
+  0x00, 0x08, 0x07, 0x03, 0x00,
+  0x00, 0x1C, 0x22, 0x41, 0x00,
+  0x00, 0x41, 0x22, 0x1C, 0x00,
+  0x2A, 0x1C, 0x7F, 0x1C, 0x2A,
+  0x08, 0x08, 0x3E, 0x08, 0x08,
+  0x00, 0x80, 0x70, 0x30, 0x00,
+  0x08, 0x08, 0x08, 0x08, 0x08,
+  0x00, 0x00, 0x60, 0x60, 0x00,
+  0x20, 0x10, 0x08, 0x04, 0x02,
+  0x3E, 0x51, 0x49, 0x45, 0x3E, // 0
+  0x00, 0x42, 0x7F, 0x40, 0x00, // 1
+  0x72, 0x49, 0x49, 0x49, 0x46, // 2
+  0x21, 0x41, 0x49, 0x4D, 0x33, // 3
+  0x18, 0x14, 0x12, 0x7F, 0x10, // 4
+  0x27, 0x45, 0x45, 0x45, 0x39, // 5
+  0x3C, 0x4A, 0x49, 0x49, 0x31, // 6
+  0x41, 0x21, 0x11, 0x09, 0x07, // 7
+  0x36, 0x49, 0x49, 0x49, 0x36, // 8
+  0x46, 0x49, 0x49, 0x29, 0x1E, // 9
+  0x00, 0x00, 0x14, 0x00, 0x00,
+  0x00, 0x40, 0x34, 0x00, 0x00,
+  0x00, 0x08, 0x14, 0x22, 0x41,
+  0x14, 0x14, 0x14, 0x14, 0x14,
+  0x00, 0x41, 0x22, 0x14, 0x08,
+  0x02, 0x01, 0x59, 0x09, 0x06,
+  0x3E, 0x41, 0x5D, 0x59, 0x4E,
+  0x7C, 0x12, 0x11, 0x12, 0x7C, // A
+  0x7F, 0x49, 0x49, 0x49, 0x36, // B
+  0x3E, 0x41, 0x41, 0x41, 0x22, // C
+  0x7F, 0x41, 0x41, 0x41, 0x3E, // D
+  0x7F, 0x49, 0x49, 0x49, 0x41, // E
+  0x7F, 0x09, 0x09, 0x09, 0x01, // F
+  0x3E, 0x41, 0x41, 0x51, 0x73, // G
+  0x7F, 0x08, 0x08, 0x08, 0x7F, // H
+  0x00, 0x41, 0x7F, 0x41, 0x00, // I
+  0x20, 0x40, 0x41, 0x3F, 0x01, // J
+  0x7F, 0x08, 0x14, 0x22, 0x41, // K
+  0x7F, 0x40, 0x40, 0x40, 0x40, // L
+  0x7F, 0x02, 0x1C, 0x02, 0x7F, // M
+  0x7F, 0x04, 0x08, 0x10, 0x7F, // N
+  0x3E, 0x41, 0x41, 0x41, 0x3E, // O
+  0x7F, 0x09, 0x09, 0x09, 0x06, // P
+  0x3E, 0x41, 0x51, 0x21, 0x5E, // Q
+  0x7F, 0x09, 0x19, 0x29, 0x46, // R
+  0x26, 0x49, 0x49, 0x49, 0x32, // S
+  0x03, 0x01, 0x7F, 0x01, 0x03, // T
+  0x3F, 0x40, 0x40, 0x40, 0x3F, // U
+  0x1F, 0x20, 0x40, 0x20, 0x1F, // V
+  0x3F, 0x40, 0x38, 0x40, 0x3F, // W
+  0x63, 0x14, 0x08, 0x14, 0x63, // X
+  0x03, 0x04, 0x78, 0x04, 0x03, // Y
+  0x61, 0x59, 0x49, 0x4D, 0x43, // Z
+  0x00, 0x7F, 0x41, 0x41, 0x41,
+  0x02, 0x04, 0x08, 0x10, 0x20,
+  0x00, 0x41, 0x41, 0x41, 0x7F,
+  0x04, 0x02, 0x01, 0x02, 0x04,
+  0x40, 0x40, 0x40, 0x40, 0x40,
+  0x00, 0x03, 0x07, 0x08, 0x00,
+  0x20, 0x54, 0x54, 0x78, 0x40, // a
+  0x7F, 0x28, 0x44, 0x44, 0x38, // b
+  0x38, 0x44, 0x44, 0x44, 0x28, // c
+  0x38, 0x44, 0x44, 0x28, 0x7F, // d
+  0x38, 0x54, 0x54, 0x54, 0x18, // e
+  0x00, 0x08, 0x7E, 0x09, 0x02, // f
+  0x18, 0xA4, 0xA4, 0x9C, 0x78, // g
+  0x7F, 0x08, 0x04, 0x04, 0x78, // h
+  0x00, 0x44, 0x7D, 0x40, 0x00, // i
+  0x20, 0x40, 0x40, 0x3D, 0x00, // j
+  0x7F, 0x10, 0x28, 0x44, 0x00, // k
+  0x00, 0x41, 0x7F, 0x40, 0x00, // l
+  0x7C, 0x04, 0x78, 0x04, 0x78, // m
+  0x7C, 0x08, 0x04, 0x04, 0x78, // n
+  0x38, 0x44, 0x44, 0x44, 0x38, // o
+  0xFC, 0x18, 0x24, 0x24, 0x18, // p
+  0x18, 0x24, 0x24, 0x18, 0xFC, // q
+  0x7C, 0x08, 0x04, 0x04, 0x08, // r
+  0x48, 0x54, 0x54, 0x54, 0x24, // s
+  0x04, 0x04, 0x3F, 0x44, 0x24, // t
+  0x3C, 0x40, 0x40, 0x20, 0x7C, // u
+  0x1C, 0x20, 0x40, 0x20, 0x1C, // v
+  0x3C, 0x40, 0x30, 0x40, 0x3C, // w
+  0x44, 0x28, 0x10, 0x28, 0x44, // x
+  0x4C, 0x90, 0x90, 0x90, 0x7C, // y
+  0x44, 0x64, 0x54, 0x4C, 0x44, // z
+  0x00, 0x08, 0x36, 0x41, 0x00,
+  0x00, 0x00, 0x77, 0x00, 0x00,
+  0x00, 0x41, 0x36, 0x08, 0x00,
+  0x02, 0x01, 0x02, 0x04, 0x02,
+};
+
+// Clip a rectangle to the framebuffer, 0 if nothing is left.
+static int clip(int16_t *x, int16_t *y, int16_t *w, int16_t *h){
+  if(*x < 0){ *w = *w + *x; *x = 0; }
+  if(*y < 0){ *h = *h + *y; *y = 0; }
+  if(*w > DISPLAY_MEM_W - *x) *w = DISPLAY_MEM_W - *x;
+  if(*h > DISPLAY_MEM_H - *y) *h = DISPLAY_MEM_H - *y;
+  return (*w > 0) && (*h > 0);
+}
+
+static int16_t memWidth(void){
+  return DISPLAY_MEM_W;
+}
+
+static int16_t memHeight(void){
+  return DISPLAY_MEM_H;
+}
+
+static void memFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color){
+  int16_t i, j;
+  if(!clip(&x, &y, &w, &h)){
+    return;
+  }
+  for(j=y; j<y+h; j=j+1){
+    for(i=x; i<x+w; i=i+1){
+      Frame[j][i] = color;
+    }
+  }
+}
+
+static void memClear(void){
+  memFillRect(0, 0, DISPLAY_MEM_W, DISPLAY_MEM_H, DISPLAY_BLACK);
+}
+
+static void memText(uint8_t col, uint8_t row, const char *pt, uint16_t fg, uint16_t bg){
+  const uint8_t *glyph;
+  int16_t x = col*6, y = row*8, i, j;
+  for(; *pt && (x < DISPLAY_MEM_W); pt=pt+1, x=x+6){
+    glyph = ((*pt >= 0x20) && (*pt <= 0x7E)) ? &Font[(*pt - 0x20)*5] : 0;
+    for(j=0; (j<8) && (y+j<DISPLAY_MEM_H); j=j+1){
+      for(i=0; (i<6) && (x+i<DISPLAY_MEM_W); i=i+1){
+        if(glyph && (i < 5) && ((glyph[i]>>j)&0x01)){
+          Frame[y+j][x+i] = fg;
+        } else if(bg != fg){
+          Frame[y+j][x+i] = bg;
+        }
+      }
+    }
+  }
+}
+
+static void memBlit(int16_t x, int16_t y, const uint16_t *buf, int16_t w, int16_t h, int16_t stride){
+  int16_t x0 = x, y0 = y, i, j;
+  if(!clip(&x, &y, &w, &h)){
+    return;
+  }
+  buf = buf + (y - y0)*stride + (x - x0);
+  for(j=0; j<h; j=j+1){
+    for(i=0; i<w; i=i+1){
+      Frame[y+j][x+i] = buf[i];
+    }
+    buf = buf + stride;
+  }
+}
+
+static void memFlush(void){
+}
+
+//********Display_MemoryPixel*****************
+// Read back a pixel of the Display_Memory framebuffer.
+// inputs: x, y  pixel
+// outputs: 16-bit color, DISPLAY_BLACK outside the framebuffer
+uint16_t Display_MemoryPixel(int16_t x, int16_t y){
+  if((x < 0) || (y < 0) || (x >= DISPLAY_MEM_W) || (y >= DISPLAY_MEM_H)){
+    return DISPLAY_BLACK;
+  }
+  return Frame[y][x];
+}
+
+const Display Display_Memory = {
+  "Memory", 16, 6, 8,
+  memWidth, memHeight, memClear, memText,
+  memFillRect, memBlit, memFlush, &Stats
+};
@@ -0,0 +1,104 @@
+// DisplayNokia.c
+// Runs on LM4F120/TM4C123
+// Display backend for the Nokia5110 48x84 LCD.  Drawing goes to
+// the screen buffer of Nokia5110.c, and the bounding box of
+// everything drawn is sent by the flush, so a change to one
+// widget costs a few dozen bytes instead of the whole screen.
+// Chanartip Soonthornwan
+
+#include <stdint.h>
+#include "Nokia5110.h"
+#include "Display.h"
+
+static DisplayStats Stats;
+static uint8_t Dirty;                   // 1 if the buffer changed since the flush
+static int16_t DirtyX0, DirtyY0, DirtyX1, DirtyY1; // changed area, x1 and y1 exclusive
+
+// Clip a rectangle to the screen, 0 if nothing is left.
+static int clip(int16_t *x, int16_t *y, int16_t *w, int16_t *h){
+  if(*x < 0){ *w = *w + *x; *x = 0; }
+  if(*y < 0){ *h = *h + *y; *y = 0; }
+  if(*w > MAX_X - *x) *w = MAX_X - *x;
+  if(*h > MAX_Y - *y) *h = MAX_Y - *y;
+  return (*w > 0) && (*h > 0);
+}
+
+// Grow the changed area to include a clipped rectangle.
+static void touch(int16_t x, int16_t y, int16_t w, int16_t h){
+  if(!Dirty){
+    DirtyX0 = x; DirtyY0 = y;
+    DirtyX1 = x + w; DirtyY1 = y + h;
+    Dirty = 1;
+    return;
+  }
+  if(x < DirtyX0) DirtyX0 = x;
+  if(y < DirtyY0) DirtyY0 = y;
+  if(x + w > DirtyX1) DirtyX1 = x + w;
+  if(y + h > DirtyY1) DirtyY1 = y + h;
+}
+
+static int16_t nokiaWidth(void){
+  return MAX_X;
+}
+
+static int16_t nokiaHeight(void){
+  return MAX_Y;
+}
+
+static void nokiaClear(void){
+  Nokia5110_ClearBuffer();
+  touch(0, 0, MAX_X, MAX_Y);
+}
+
+static void nokiaText(uint8_t col, uint8_t row, const char *pt, uint16_t fg, uint16_t bg){
+  int16_t n = 0;
+  (void)fg; (void)bg;                   // 1 bpp, text is always set pixels
+  while(pt[n] && (col + n < 12)){
+    n = n + 1;
+  }
+  if((n == 0) || (row > 5)){
+    return;
+  }
+  Nokia5110_BufferString(col, row, pt);
+  touch(col*7, row*8, n*7, 8);
+}
+
+static void nokiaFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color){
+  if(!clip(&x, &y, &w, &h)){
+    return;
+  }
+  Nokia5110_FillRect(x, y, w, h, color != DISPLAY_BLACK);
+  touch(x, y, w, h);
+}
+
+static void nokiaBlit(int16_t x, int16_t y, const uint16_t *buf, int16_t w, int16_t h, int16_t stride){
+  int16_t x0 = x, y0 = y, i, j;
+  if(!clip(&x, &y, &w, &h)){
+    return;
+  }
+  buf = buf + (y - y0)*stride + (x - x0);
+  for(j=0; j<h; j=j+1){
+    for(i=0; i<w; i=i+1){
+      if(buf[i] != DISPLAY_BLACK){
+        Nokia5110_SetPixel(x + i, y + j);
+      } else{
+        Nokia5110_ClrPixel(x + i, y + j);
+      }
+    }
+    buf = buf + stride;
+  }
+  touch(x, y, w, h);
+}
+
+static void nokiaFlush(void){
+  if(Dirty){
+    Nokia5110_DisplayRect(DirtyX0, DirtyY0, DirtyX1 - DirtyX0, DirtyY1 - DirtyY0);
+    Dirty = 0;
+  }
+}
+
+const Display Display_Nokia5110 = {
+  "Nokia5110", 1, 7, 8,
+  nokiaWidth, nokiaHeight, nokiaClear, nokiaText,
+  nokiaFillRect, nokiaBlit, nokiaFlush, &Stats
+};
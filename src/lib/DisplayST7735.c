@@ -0,0 +1,33 @@
+// DisplayST7735.c
+// Runs on LM4F120/TM4C123
+// Display backend for the ST7735 160x128 color LCD.  Every call
+// is drawn on the LCD right away through the span functions of
+// ST7735.c, so the flush has nothing to do.
+// Chanartip Soonthornwan
+
+#include <stdint.h>
+#include "ST7735.h"
+#include "Display.h"
+
+static DisplayStats Stats;
+
+static void st7735Clear(void){
+  ST7735_FillScreen(DISPLAY_BLACK);
+}
+
+static void st7735Text(uint8_t col, uint8_t row, const char *pt, uint16_t fg, uint16_t bg){
+  ST7735_DrawText(col*6, row*8, pt, fg, bg, 1);
+}
+
+static void st7735Blit(int16_t x, int16_t y, const uint16_t *buf, int16_t w, int16_t h, int16_t stride){
+  ST7735_DrawBuffer(x, y, buf, w, h, stride);
+}
+
+static void st7735Flush(void){
+}
+
+const Display Display_ST7735 = {
+  "ST7735", 16, 6, 8,
+  ST7735_GetWidth, ST7735_GetHeight, st7735Clear, st7735Text,
+  ST7735_FillRect, st7735Blit, st7735Flush, &Stats
+};
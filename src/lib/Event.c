@@ -0,0 +1,97 @@
+// Event.c
+// Runs on LM4F120/TM4C123
+// Run-to-completion event loop: single producer, single consumer
+// event queues posted by ISRs and dispatched from the main loop
+// by priority.
+// Chanartip Soonthornwan
+
+#include <stdint.h>
+#include "SoftTimer.h"
+#include "Event.h"
+
+static EventQueue *Queues;              // highest priority first
+static void (*Wake)(void) = &SoftTimer_Wake;    // what a post wakes
+
+//********Event_Add*****************
+// Add a queue to the dispatcher, after the queues of the same or
+// higher priority.  Called before interrupts that post to it.
+// inputs: q  queue made with EVENT_QUEUE()
+// outputs: none
+void Event_Add(EventQueue *q){
+  EventQueue **pt = &Queues;
+  while(*pt && ((*pt)->priority <= q->priority)){
+    pt = &(*pt)->next;
+  }
+  q->head = q->tail = 0;
+  q->next = *pt;
+  *pt = q;
+}
+
+//********Event_Post*****************
+// Queue an event for the queue's handler.  Called by the one
+// producer of the queue, usually an ISR.  About 20 cycles.
+// inputs: q      queue
+//         event  passed to the handler
+// outputs: 1 if queued, 0 if the queue was full and it was lost
+int Event_Post(EventQueue *q, unsigned char event){
+  uint8_t head = q->head;
+  uint8_t count = (uint8_t)(head - q->tail);    // indexes run free, mod 256
+  if(count >= q->size){
+    q->lost = q->lost + 1;
+    return 0;
+  }
+  q->buf[head&(q->size - 1)] = event;   // the event first,
+  q->head = head + 1;                   // then the index that hands it over
+  if(count >= q->peak){
+    q->peak = count + 1;
+  }
+  (*Wake)();                            // the main loop may be about to sleep
+  return 1;
+}
+
+//********Event_OnPost*****************
+// Set what a post wakes, SoftTimer_Wake() until it is called.
+// Called before interrupts that post.
+// inputs: wake  called by Event_Post() after each event queued
+// outputs: none
+void Event_OnPost(void (*wake)(void)){
+  Wake = wake;
+}
+
+//********Event_Dispatch*****************
+// Run the handler of the first event of the highest priority
+// queue that has one.  Called from the main loop only.
+// inputs: none
+// outputs: 1 if a handler ran, 0 if every queue was empty
+int Event_Dispatch(void){
+  EventQueue *q;
+  uint8_t tail;
+  unsigned char event;
+  for(q=Queues; q; q=q->next){
+    tail = q->tail;
+    if(tail != q->head){
+      event = q->buf[tail&(q->size - 1)];
+      q->tail = tail + 1;               // the slot is free again
+      q->handler(event);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+//********Event_Run*****************
+// The main loop: run every queued event, then the background
+// task, then sleep until an interrupt.  Never returns.
+// inputs: background  run each time the queues are emptied,
+//                     e.g. to redraw what the handlers changed,
+//                     or 0 for none
+// outputs: none
+void Event_Run(void (*background)(void)){
+  while(1){
+    while(Event_Dispatch()){};
+    if(background){
+      background();
+    }
+    SoftTimer_Idle();                   // returns at once if an event came meanwhile
+  }
+}
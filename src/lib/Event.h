@@ -0,0 +1,91 @@
+// Event.h
+// Runs on LM4F120/TM4C123
+// Run-to-completion event loop.  Interrupts only take in their
+// input and post it as an event; the handlers that act on it
+// (sending on the UART, changing the PWM, redrawing) run one at a
+// time from the main loop, highest priority first, and none
+// preempts another.  So the ISRs stay a few dozen cycles long,
+// the latency of every interrupt stays short and bounded, and the
+// handlers need no critical sections between themselves.
+// Chanartip Soonthornwan
+
+// Each queue is a ring of single byte events with one producer,
+// the interrupt posting to it, and one consumer, the dispatcher.
+// The producer only writes head and the consumer only writes tail,
+// and each writes the event before moving its index, so neither
+// side has to disable interrupts.  Interrupts at the same NVIC
+// priority cannot preempt each other and may post to the same
+// queue; ones at different priorities need a queue each.
+
+// The dispatcher takes the first event of the highest priority
+// queue that has one, runs its handler, and looks again from the
+// top, so an event posted meanwhile to a higher priority queue
+// runs next.  With nothing queued the main loop sleeps in
+// SoftTimer_Idle(), which Event_Post() wakes.  A program that
+// dispatches from a task of the kernel (Kernel.h) instead has
+// Event_OnPost() signal that task.
+
+#ifndef __EVENT_H__ // do not include more than once
+#define __EVENT_H__
+#include <stdint.h>
+
+#define EVENT_PRIORITY_HIGH  0
+#define EVENT_PRIORITY_LOW   3
+
+typedef struct EventQueue {             // owned by Event.c once added
+  void (*handler)(unsigned char event); // run from the main loop
+  unsigned char *buf;
+  uint8_t size;                         // events in buf: 2, 4, ... 128
+  uint8_t priority;                     // EVENT_PRIORITY_HIGH to _LOW
+  volatile uint8_t head;                // written by the producer only
+  volatile uint8_t tail;                // written by the dispatcher only
+  uint8_t peak;                         // most events queued at once
+  uint16_t lost;                        // posts to a full queue
+  struct EventQueue *next;              // list of queues by priority
+} EventQueue;
+
+// Define a queue and its buffer, e.g.
+//   EVENT_QUEUE(KeyQueue, 8, EVENT_PRIORITY_LOW, &Key_Task);
+#define EVENT_QUEUE(name, n, priority, handler) \
+  static unsigned char name##Buf[n]; \
+  static EventQueue name = {handler, name##Buf, n, priority}
+
+//********Event_Add*****************
+// Add a queue to the dispatcher, after the queues of the same or
+// higher priority.  Called before interrupts that post to it.
+// inputs: q  queue made with EVENT_QUEUE()
+// outputs: none
+void Event_Add(EventQueue *q);
+
+//********Event_Post*****************
+// Queue an event for the queue's handler.  Called by the one
+// producer of the queue, usually an ISR.  About 20 cycles.
+// inputs: q      queue
+//         event  passed to the handler
+// outputs: 1 if queued, 0 if the queue was full and it was lost
+int Event_Post(EventQueue *q, unsigned char event);
+
+//********Event_OnPost*****************
+// Set what a post wakes, SoftTimer_Wake() until it is called.
+// Called before interrupts that post.
+// inputs: wake  called by Event_Post() after each event queued
+// outputs: none
+void Event_OnPost(void (*wake)(void));
+
+//********Event_Dispatch*****************
+// Run the handler of the first event of the highest priority
+// queue that has one.  Called from the main loop only.
+// inputs: none
+// outputs: 1 if a handler ran, 0 if every queue was empty
+int Event_Dispatch(void);
+
+//********Event_Run*****************
+// The main loop: run every queued event, then the background
+// task, then sleep until an interrupt.  Never returns.
+// inputs: background  run each time the queues are emptied,
+//                     e.g. to redraw what the handlers changed,
+//                     or 0 for none
+// outputs: none
+void Event_Run(void (*background)(void));
+
+#endif // __EVENT_H__
@@ -0,0 +1,223 @@
+// Kernel.c
+// Runs on LM4F120/TM4C123
+// Optional preemptive kernel: fixed priority tasks with their own
+// stacks, switched by PendSV_Handler in startup.s, and mutexes
+// with priority inheritance.
+// Chanartip Soonthornwan
+
+#include <stdint.h>
+#include "tm4c123gh6pm.h"
+#include "Kernel.h"
+
+long StartCritical(void);    // previous I bit, disable interrupts
+void EndCritical(long sr);   // restore I bit to previous value
+void EnableInterrupts(void); // Enable interrupts
+void WaitForInterrupt(void); // low power mode
+
+#define BLOCK_WAIT     1                // in Kernel_Wait()
+#define BLOCK_MUTEX    2                // in Kernel_Lock()
+#define STACK_FILL     0x5A5A5A5A       // unused stack, for Kernel_StackFree()
+#define PSR_THUMB      0x01000000       // xPSR of a new task
+
+// Shared with PendSV_Handler in startup.s, which uses the offsets:
+// current 0, next 4, stats 8 (switches 8, last 12, max 16).
+struct {
+  KernelTask *current;                  // task running, 0 before the first switch
+  KernelTask *next;                     // task PendSV switches to
+  KernelStats stats;
+} KernelRun;
+
+static KernelTask *Tasks[KERNEL_MAX_TASKS];     // the idle task is not in it
+static uint8_t Count;
+
+static void idle(void){
+  while(1){
+    WaitForInterrupt();
+  }
+}
+KERNEL_TASK(IdleTask, &idle, KERNEL_PRIORITY_IDLE, 64);
+
+// A task function returned: it only waits from then on
+static void exitTask(void){
+  while(1){
+    Kernel_Wait();
+  }
+}
+
+// Switch to the highest priority ready task if it is not the one
+// running.  PendSV does the switch once the interrupts are done,
+// or as soon as they are enabled.  Interrupts are disabled.
+static void schedule(void){
+  KernelTask *best = &IdleTask, *t;
+  uint8_t i;
+  for(i=0; i<Count; i=i+1){
+    t = Tasks[i];
+    if((t->blocked == 0) && (t->priority < best->priority)){
+      best = t;
+    }
+  }
+  KernelRun.next = best;
+  if(best != KernelRun.current){
+    NVIC_INT_CTRL_R = NVIC_INT_CTRL_PEND_SV;
+  }
+}
+
+// Give a task the stack of a call to its function made from an
+// interrupt: R4-R11, then the frame the hardware pops
+static void prepare(KernelTask *t){
+  uint32_t *sp, i;
+  for(i=0; i<t->words; i=i+1){
+    t->stack[i] = STACK_FILL;
+  }
+  sp = (uint32_t *)((uint32_t)(t->stack + t->words)&~7UL); // 8-byte aligned, as AAPCS wants
+  sp = sp - 16;
+  for(i=0; i<16; i=i+1){
+    sp[i] = 0;                          // R4-R11, R0-R3, R12
+  }
+  sp[13] = (uint32_t)&exitTask;         // LR
+  sp[14] = (uint32_t)t->run&~1UL;       // PC, without the Thumb bit of the pointer
+  sp[15] = PSR_THUMB;                   // xPSR
+  t->sp = sp;
+  t->priority = t->base;
+  t->blocked = 0;
+  t->signaled = 0;
+  t->waitingFor = 0;
+}
+
+//********Kernel_Add*****************
+// Add a task, ready to run from the start of its function.
+// Called before Kernel_Start(), one task per priority.
+// inputs: t  task made with KERNEL_TASK()
+// outputs: none
+void Kernel_Add(KernelTask *t){
+  if(Count < KERNEL_MAX_TASKS){
+    prepare(t);
+    Tasks[Count] = t;
+    Count = Count + 1;
+  }
+}
+
+//********Kernel_Start*****************
+// Start the tasks; main's code after it never runs.  Called
+// with the interrupts set up, enables them.
+// inputs: none
+// outputs: none
+void Kernel_Start(void){
+  prepare(&IdleTask);
+  NVIC_ST_CTRL_R = 0;                   // SysTick free running, for the timing
+  NVIC_ST_RELOAD_R = NVIC_ST_RELOAD_M;
+  NVIC_ST_CURRENT_R = 0;
+  NVIC_ST_CTRL_R = NVIC_ST_CTRL_ENABLE+NVIC_ST_CTRL_CLK_SRC; // no interrupt
+  NVIC_SYS_PRI3_R = (NVIC_SYS_PRI3_R&0xFF00FFFF)|0x00E00000; // PendSV priority 7
+  KernelRun.current = 0;
+  (void)StartCritical();
+  schedule();                           // pends the first switch
+  EnableInterrupts();                   // PendSV leaves main's stack here
+  while(1){};
+}
+
+//********Kernel_Wait*****************
+// Block the calling task until it is signaled, or return at once
+// if it was signaled since its last wait.  Called by a task only.
+// inputs: none
+// outputs: none
+void Kernel_Wait(void){
+  KernelTask *me;
+  long sr = StartCritical();
+  me = KernelRun.current;
+  if(!me->signaled){
+    me->blocked = BLOCK_WAIT;
+    schedule();
+    EndCritical(sr);                    // switched out here until signaled
+    sr = StartCritical();
+  }
+  me->signaled = 0;
+  EndCritical(sr);
+}
+
+//********Kernel_Signal*****************
+// Make a task's next or current Kernel_Wait() return.  Safe to
+// call from any ISR or task.
+// inputs: t  task
+// outputs: none
+void Kernel_Signal(KernelTask *t){
+  long sr = StartCritical();
+  t->signaled = 1;
+  if(t->blocked == BLOCK_WAIT){
+    t->blocked = 0;
+    schedule();
+  }
+  EndCritical(sr);
+}
+
+//********Kernel_Lock*****************
+// Take a mutex, waiting while another task holds it and lending
+// that task the caller's priority.  Called by a task only, not
+// again by the task that holds it.
+// inputs: m  mutex, zero initialized
+// outputs: none
+void Kernel_Lock(KernelMutex *m){
+  KernelTask *me, *owner;
+  long sr = StartCritical();
+  me = KernelRun.current;
+  if(m->owner){
+    m->contended = m->contended + 1;
+  }
+  while(m->owner){
+    owner = m->owner;                   // lend my priority down the chain
+    while(owner && (owner->priority > me->priority)){
+      owner->priority = me->priority;
+      owner = owner->waitingFor ? owner->waitingFor->owner : 0;
+    }
+    me->blocked = BLOCK_MUTEX;
+    me->waitingFor = m;
+    schedule();
+    EndCritical(sr);                    // switched out here until unlocked
+    sr = StartCritical();
+  }
+  me->waitingFor = 0;
+  m->owner = me;
+  EndCritical(sr);
+}
+
+//********Kernel_Unlock*****************
+// Give back a mutex taken by the calling task.
+// inputs: m  mutex
+// outputs: none
+void Kernel_Unlock(KernelMutex *m){
+  KernelTask *me, *t;
+  uint8_t i;
+  long sr = StartCritical();
+  me = KernelRun.current;
+  m->owner = 0;
+  me->priority = me->base;
+  for(i=0; i<Count; i=i+1){
+    t = Tasks[i];
+    if(t->waitingFor == m){             // all try again, the highest gets it
+      t->blocked = 0;
+    } else if(t->waitingFor && (t->waitingFor->owner == me) &&
+              (t->priority < me->priority)){
+      me->priority = t->priority;       // still lent by a mutex I hold
+    }
+  }
+  schedule();
+  EndCritical(sr);
+}
+
+//********Kernel_StackFree*****************
+// inputs: t  task
+// outputs: words of its stack never used so far
+uint16_t Kernel_StackFree(KernelTask *t){
+  uint16_t n = 0;
+  while((n < t->words) && (t->stack[n] == STACK_FILL)){
+    n = n + 1;
+  }
+  return n;
+}
+
+//********Kernel_Stats*****************
+// inputs: none
+// outputs: counters of the context switches
+const KernelStats *Kernel_Stats(void){
+  return &KernelRun.stats;
+}
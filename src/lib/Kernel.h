@@ -0,0 +1,129 @@
+// Kernel.h
+// Runs on LM4F120/TM4C123
+// Optional preemptive kernel with fixed priority tasks, for work
+// that must not wait for a long, low priority one: a relay or a
+// fade started from a key press while the display is redrawn.
+// Tasks are switched by PendSV_Handler in startup.s; each task
+// has its own stack, sized when it is defined.  A program that
+// does not call Kernel_Start() keeps running its main loop, and
+// the kernel costs nothing but its code.
+// Chanartip Soonthornwan
+
+// Scheduling.  The ready task of the highest priority runs; a
+// task runs until it waits, or until an interrupt makes a higher
+// priority task ready.  A task waits with Kernel_Wait() until
+// Kernel_Signal() from another task or an ISR, or for a mutex.
+// With every task waiting, the kernel's idle task sleeps with WFI.
+
+// Context switch.  Scheduling in C picks the next task and pends
+// PendSV, which runs at priority 7, below every interrupt, once
+// they are all done.  PendSV saves R4-R11 under the frame the
+// hardware pushed on the task's stack (PSP), stores the stack
+// pointer, and loads the next task the same way.  The interrupts
+// themselves run on the main stack (MSP).  The FPU must stay off,
+// as in startup.s, since its registers are not saved.
+
+// Priority inheritance.  A task holding a KernelMutex runs at the
+// priority of the highest task waiting for it, so a middle
+// priority task cannot keep a high priority one waiting for the
+// bus (priority inversion).  The inherited priority is dropped
+// when the mutex is unlocked.
+
+// Instrumentation.  SysTick runs free at the bus clock, without
+// interrupts, and PendSV reads it on entry and exit: Kernel_Stats()
+// has the number of switches and the cycles of the last and the
+// longest.  The whole switch adds what the hardware takes to push
+// a frame and pop one.  Kernel_StackFree() shows how much of a
+// stack was never used, to size it.
+
+#ifndef __KERNEL_H__ // do not include more than once
+#define __KERNEL_H__
+#include <stdint.h>
+
+#define KERNEL_MAX_TASKS   8            // not counting the idle task
+#define KERNEL_PRIORITY_IDLE 255        // 0 is the highest
+
+typedef struct {
+  uint32_t switches;                    // context switches
+  uint32_t last;                        // bus cycles in PendSV_Handler, last switch
+  uint32_t max;                         //   longest switch
+} KernelStats;
+
+typedef struct KernelTask {             // owned by Kernel.c once added
+  uint32_t *sp;                         // saved stack pointer, first for PendSV
+  void (*run)(void);                    // never returns
+  uint32_t *stack;
+  uint16_t words;                       // size of stack
+  uint8_t base;                         // priority it was given
+  uint8_t priority;                     // priority it runs at, base or inherited
+  uint8_t blocked;                      // 0 if ready to run
+  uint8_t signaled;                     // Kernel_Signal() not yet waited for
+  struct KernelMutex *waitingFor;       // mutex it is blocked on, or 0
+} KernelTask;
+
+typedef struct KernelMutex {
+  KernelTask *owner;                    // 0 if free
+  uint32_t contended;                   // locks that had to wait
+} KernelMutex;
+
+// Define a task and its stack, e.g.
+//   KERNEL_TASK(DisplayTask, &Display_Run, 3, 256);
+// The stack holds the task's calls plus 16 words for a switch
+// and the frame of an interrupt.
+#define KERNEL_TASK(name, run, priority, words) \
+  static uint32_t name##Stack[words]; \
+  static KernelTask name = {0, run, name##Stack, words, priority}
+
+//********Kernel_Add*****************
+// Add a task, ready to run from the start of its function.
+// Called before Kernel_Start(), one task per priority.
+// inputs: t  task made with KERNEL_TASK()
+// outputs: none
+void Kernel_Add(KernelTask *t);
+
+//********Kernel_Start*****************
+// Start the tasks; main's code after it never runs.  Called
+// with the interrupts set up, enables them.
+// inputs: none
+// outputs: none
+void Kernel_Start(void);
+
+//********Kernel_Wait*****************
+// Block the calling task until it is signaled, or return at once
+// if it was signaled since its last wait.  Called by a task only.
+// inputs: none
+// outputs: none
+void Kernel_Wait(void);
+
+//********Kernel_Signal*****************
+// Make a task's next or current Kernel_Wait() return.  Safe to
+// call from any ISR or task.
+// inputs: t  task
+// outputs: none
+void Kernel_Signal(KernelTask *t);
+
+//********Kernel_Lock*****************
+// Take a mutex, waiting while another task holds it and lending
+// that task the caller's priority.  Called by a task only, not
+// again by the task that holds it.
+// inputs: m  mutex, zero initialized
+// outputs: none
+void Kernel_Lock(KernelMutex *m);
+
+//********Kernel_Unlock*****************
+// Give back a mutex taken by the calling task.
+// inputs: m  mutex
+// outputs: none
+void Kernel_Unlock(KernelMutex *m);
+
+//********Kernel_StackFree*****************
+// inputs: t  task
+// outputs: words of its stack never used so far
+uint16_t Kernel_StackFree(KernelTask *t);
+
+//********Kernel_Stats*****************
+// inputs: none
+// outputs: counters of the context switches
+const KernelStats *Kernel_Stats(void);
+
+#endif // __KERNEL_H__
@@ -1,5 +1,5 @@
 // Nokia5110.c
-// Runs on LM4F120/TM4C123
+// Runs on LM4F120/TM4C123, or a PC with NOKIA5110_SIMULATE defined
 // Use SSI0 to send an 8-bit code to the Nokia5110 48x84
 // pixel LCD to display text, images, or other information.
 // Daniel Valvano
@@ -32,7 +32,7 @@
 // ---------------
 // Signal        (Nokia 5110) LaunchPad pin
 // Reset         (RST, pin 1) connected to PA7
-// SSI0Fss       (CE,  pin 2) connected to PA3
+// Chip enable   (CE,  pin 2) connected to PA3
 // Data/Command  (DC,  pin 3) connected to PA6
 // SSI0Tx        (Din, pin 4) connected to PA5
 // SSI0Clk       (Clk, pin 5) connected to PA2
@@ -45,7 +45,7 @@
 // Signal        (Nokia 5110) LaunchPad pin
 // 3.3V          (VCC, pin 1) power
 // Ground        (GND, pin 2) ground
-// SSI0Fss       (SCE, pin 3) connected to PA3
+// Chip enable   (SCE, pin 3) connected to PA3
 // Reset         (RST, pin 4) connected to PA7
 // Data/Command  (D/C, pin 5) connected to PA6
 // SSI0Tx        (DN,  pin 6) connected to PA5
@@ -53,65 +53,81 @@
 // back light    (LED, pin 8) not connected, consists of 4 white LEDs which draw ~80mA total
 
 #include "Nokia5110.h"
+#include "SSI.h"
+#include "Timebase.h"
 
+#ifndef NOKIA5110_SIMULATE
+#define CE                      (*((volatile unsigned long *)0x40004020))
 #define DC                      (*((volatile unsigned long *)0x40004100))
-#define DC_COMMAND              0
-#define DC_DATA                 0x40
 #define RESET                   (*((volatile unsigned long *)0x40004200))
-#define RESET_LOW               0
-#define RESET_HIGH              0x80
 #define GPIO_PORTA_DIR_R        (*((volatile unsigned long *)0x40004400))
 #define GPIO_PORTA_AFSEL_R      (*((volatile unsigned long *)0x40004420))
 #define GPIO_PORTA_DEN_R        (*((volatile unsigned long *)0x4000451C))
 #define GPIO_PORTA_AMSEL_R      (*((volatile unsigned long *)0x40004528))
 #define GPIO_PORTA_PCTL_R       (*((volatile unsigned long *)0x4000452C))
-#define SSI0_CR0_R              (*((volatile unsigned long *)0x40008000))
-#define SSI0_CR1_R              (*((volatile unsigned long *)0x40008004))
 #define SSI0_DR_R               (*((volatile unsigned long *)0x40008008))
 #define SSI0_SR_R               (*((volatile unsigned long *)0x4000800C))
-#define SSI0_CPSR_R             (*((volatile unsigned long *)0x40008010))
-#define SSI0_CC_R               (*((volatile unsigned long *)0x40008FC8))
-#define SSI_CR0_SCR_M           0x0000FF00  // SSI Serial Clock Rate
-#define SSI_CR0_SPH             0x00000080  // SSI Serial Clock Phase
-#define SSI_CR0_SPO             0x00000040  // SSI Serial Clock Polarity
-#define SSI_CR0_FRF_M           0x00000030  // SSI Frame Format Select
-#define SSI_CR0_FRF_MOTO        0x00000000  // Freescale SPI Frame Format
-#define SSI_CR0_DSS_M           0x0000000F  // SSI Data Size Select
-#define SSI_CR0_DSS_8           0x00000007  // 8-bit data
-#define SSI_CR1_MS              0x00000004  // SSI Master/Slave Select
-#define SSI_CR1_SSE             0x00000002  // SSI Synchronous Serial Port
-                                            // Enable
+#define SYSCTL_RCGC2_R          (*((volatile unsigned long *)0x400FE108))
+#define SSI0_OUT(message)       (SSI0_DR_R = (message))
+#else
+// On a PC (src/tools/DisplaySim.c) the pins and registers are
+// variables, the SSI is never busy, and each byte goes to
+// Nokia5110_SimByte(), provided by the program, with the
+// Data/Command pin.  SSI_Select(), SSI_Register(), SSI_Count()
+// and Delay_us() are provided by the program as well.
+void Nokia5110_SimByte(unsigned char message, unsigned char data);
+static volatile unsigned long SimPin[3];                // CE, DC, RESET
+static volatile unsigned long SimReg[6];
+#define CE                      SimPin[0]
+#define DC                      SimPin[1]
+#define RESET                   SimPin[2]
+#define GPIO_PORTA_DIR_R        SimReg[0]
+#define GPIO_PORTA_AFSEL_R      SimReg[1]
+#define GPIO_PORTA_DEN_R        SimReg[2]
+#define GPIO_PORTA_AMSEL_R      SimReg[3]
+#define GPIO_PORTA_PCTL_R       SimReg[4]
+#define SYSCTL_RCGC2_R          SimReg[5]
+#define SSI0_SR_R               SSI_SR_TNF  // never busy, never full
+#define SSI0_OUT(message)       Nokia5110_SimByte(message, DC == DC_DATA)
+#endif
+#define CE_LOW                  0
+#define CE_HIGH                 0x08
+#define DC_COMMAND              0
+#define DC_DATA                 0x40
+#define RESET_LOW               0
+#define RESET_HIGH              0x80
 #define SSI_SR_BSY              0x00000010  // SSI Busy Bit
 #define SSI_SR_TNF              0x00000002  // SSI Transmit FIFO Not Full
-#define SSI_CPSR_CPSDVSR_M      0x000000FF  // SSI Clock Prescale Divisor
-#define SSI_CC_CS_M             0x0000000F  // SSI Baud Clock Source
-#define SSI_CC_CS_SYSPLL        0x00000000  // Either the system clock (if the
-                                            // PLL bypass is in effect) or the
-                                            // PLL output (default)
-#define SYSCTL_RCGC1_R          (*((volatile unsigned long *)0x400FE104))
-#define SYSCTL_RCGC2_R          (*((volatile unsigned long *)0x400FE108))
-#define SYSCTL_RCGC1_SSI0       0x00000010  // SSI0 Clock Gating Control
 #define SYSCTL_RCGC2_GPIOA      0x00000001  // port A Clock Gating Control
 
+// The screen buffer is packed the same way as the PCD8544 RAM:
+// six banks of 84 bytes, one byte per column, with the least
+// significant bit at the top of the bank.  It is declared as
+// words so clearing can use 32-bit stores.
+static unsigned long ScreenWords[MAX_X*MAX_Y/32];
+#define Screen ((unsigned char *)ScreenWords)
+
 enum typeOfWrite{
   COMMAND,                              // the transmission is an LCD command
   DATA                                  // the transmission is data
 };
 // The Data/Command pin must be valid when the eighth bit is
 // sent.  The SSI module has hardware input and output FIFOs
-// that are 8 locations deep.  Based on the observation that
-// the LCD interface tends to send a few commands and then a
-// lot of data, the FIFOs are not used when writing
-// commands, and they are used when writing data.  This
-// ensures that the Data/Command pin status matches the byte
-// that is actually being transmitted.
-// The write command operation waits until all data has been
-// sent, configures the Data/Command pin for commands, sends
-// the command, and then waits for the transmission to
-// finish.
-// The write data operation waits until there is room in the
-// transmit FIFO, configures the Data/Command pin for data,
-// and then adds the data to the transmit FIFO.
+// that are 8 locations deep.  Commands and data are both
+// queued in the transmit FIFO, and the Data/Command pin is
+// only changed at a phase boundary: when a command follows
+// data or data follows a command, the write waits until the
+// SSI is no longer busy (every queued byte has been shifted
+// out), then switches the Data/Command pin.  A run of
+// commands, like the two sent by Nokia5110_SetCursor(), costs
+// one pipeline drain instead of two per command.
+static unsigned char Phase = 0xFF;      // COMMAND or DATA currently on the DC pin, 0xFF if unknown
+
+// SSI0 with PA3 as a GPIO chip enable, so other devices can share
+// the bus, 3.125 MHz SSIClk (50 MHz/16), SPI mode 0, 8-bit frames.
+// Another device using SSI0 may change the DC pin, so Phase is
+// forgotten whenever the bus comes back to the LCD.
+static SSIDevice NokiaDev = {0, 16, 0, 0, 8, 0, &CE, &DC, DC_DATA, {0, 0}};
 
 // This is a helper function that sends an 8-bit message to the LCD.
 // inputs: type     COMMAND or DATA
@@ -119,20 +135,50 @@ enum typeOfWrite{
 // outputs: none
 // assumes: SSI0 and port A have already been initialized and enabled
 void static lcdwrite(enum typeOfWrite type, char message){
-  if(type == COMMAND){
-                                        // wait until SSI0 not busy/transmit FIFO empty
-    while((SSI0_SR_R&SSI_SR_BSY)==SSI_SR_BSY){};
-    DC = DC_COMMAND;
-    SSI0_DR_R = message;                // command out
+  if(SSI_Select(&NokiaDev)){
+    Phase = 0xFF;
+  }
+  if(type != Phase){
                                         // wait until SSI0 not busy/transmit FIFO empty
     while((SSI0_SR_R&SSI_SR_BSY)==SSI_SR_BSY){};
-  } else{
-    while((SSI0_SR_R&SSI_SR_TNF)==0){}; // wait until transmit FIFO not full
-    DC = DC_DATA;
-    SSI0_DR_R = message;                // data out
+    if(type == COMMAND){
+      DC = DC_COMMAND;
+    } else{
+      DC = DC_DATA;
+    }
+    Phase = type;
   }
+  while((SSI0_SR_R&SSI_SR_TNF)==0){};   // wait until transmit FIFO not full
+  SSI0_OUT(message);                    // command or data out
+  SSI_Count(&NokiaDev, 1);
 }
 
+//********Nokia5110_OutCommands*****************
+// Send a run of commands to the PCD8544.  The Data/Command pin
+// is switched once for the whole run, and the bytes are queued
+// in the transmit FIFO without waiting for each to finish.
+// inputs: cmds  array of command bytes
+//         n     number of commands
+// outputs: none
+void Nokia5110_OutCommands(const char *cmds, unsigned char n){
+  while(n){
+    lcdwrite(COMMAND, *cmds);
+    cmds = cmds + 1;
+    n = n - 1;
+  }
+}
+
+// Commands sent by Nokia5110_Init() as a single batch.
+static const char InitCommands[] = {
+  0x21,                                 // chip active; horizontal addressing mode (V = 0); use extended instruction set (H = 1)
+                                        // set LCD Vop (contrast), which may require some tweaking:
+  CONTRAST,                             // try 0xB1 (for 3.3V red SparkFun), 0xB8 (for 3.3V blue SparkFun), 0xBF if your display is too dark, or 0x80 to 0xFF if experimenting
+  0x04,                                 // set temp coefficient
+  0x14,                                 // LCD bias mode 1:48: try 0x13 or 0x14
+  0x20,                                 // we must send 0x20 before modifying the display control mode
+  0x0C                                  // set display control to normal mode: 0x0D for inverse
+};
+
 //********Nokia5110_Init*****************
 // Initialize Nokia 5110 48x84 LCD by sending the proper
 // commands to the PCD8544 driver.  One new feature of the
@@ -146,45 +192,24 @@ void static lcdwrite(enum typeOfWrite type, char message){
 // assumes: system clock rate of 50 MHz or less
 void Nokia5110_Init(void){
   volatile unsigned long delay;
-  SYSCTL_RCGC1_R |= SYSCTL_RCGC1_SSI0;  // activate SSI0
   SYSCTL_RCGC2_R |= SYSCTL_RCGC2_GPIOA; // activate port A
   delay = SYSCTL_RCGC2_R;               // allow time to finish activating
-  GPIO_PORTA_DIR_R |= 0xC0;             // make PA6,7 out
-  GPIO_PORTA_AFSEL_R |= 0x2C;           // enable alt funct on PA2,3,5
-  GPIO_PORTA_AFSEL_R &= ~0xC0;          // disable alt funct on PA6,7
-  GPIO_PORTA_DEN_R |= 0xEC;             // enable digital I/O on PA2,3,5,6,7
-                                        // configure PA2,3,5 as SSI
-  GPIO_PORTA_PCTL_R = (GPIO_PORTA_PCTL_R&0xFF0F00FF)+0x00202200;
-                                        // configure PA6,7 as GPIO
-  GPIO_PORTA_PCTL_R = (GPIO_PORTA_PCTL_R&0x00FFFFFF)+0x00000000;
-  GPIO_PORTA_AMSEL_R &= ~0xEC;          // disable analog functionality on PA2,3,5,6,7
-  SSI0_CR1_R &= ~SSI_CR1_SSE;           // disable SSI
-  SSI0_CR1_R &= ~SSI_CR1_MS;            // master mode
-                                        // configure for system clock/PLL baud clock source
-  SSI0_CC_R = (SSI0_CC_R&~SSI_CC_CS_M)+SSI_CC_CS_SYSPLL;
-                                        // clock divider for 3.125 MHz SSIClk (50 MHz PIOSC/16)
-  SSI0_CPSR_R = (SSI0_CPSR_R&~SSI_CPSR_CPSDVSR_M)+16;
-  SSI0_CR0_R &= ~(SSI_CR0_SCR_M |       // SCR = 0 (3.125 Mbps data rate)
-                  SSI_CR0_SPH |         // SPH = 0
-                  SSI_CR0_SPO);         // SPO = 0
-                                        // FRF = Freescale format
-  SSI0_CR0_R = (SSI0_CR0_R&~SSI_CR0_FRF_M)+SSI_CR0_FRF_MOTO;
-                                        // DSS = 8-bit data
-  SSI0_CR0_R = (SSI0_CR0_R&~SSI_CR0_DSS_M)+SSI_CR0_DSS_8;
-  SSI0_CR1_R |= SSI_CR1_SSE;            // enable SSI
+  CE = CE_HIGH;                         // deselected until the first write
+  GPIO_PORTA_DIR_R |= 0xC8;             // make PA3,6,7 out
+  GPIO_PORTA_AFSEL_R &= ~0xC8;          // disable alt funct on PA3,6,7
+  GPIO_PORTA_DEN_R |= 0xC8;             // enable digital I/O on PA3,6,7
+                                        // configure PA3,6,7 as GPIO
+  GPIO_PORTA_PCTL_R = (GPIO_PORTA_PCTL_R&0x00FF0FFF)+0x00000000;
+  GPIO_PORTA_AMSEL_R &= ~0xC8;          // disable analog functionality on PA3,6,7
+  SSI_Register(&NokiaDev);              // SSI0 on PA2,5, PA3 chip enable
+  SSI_Select(&NokiaDev);
 
   RESET = RESET_LOW;                    // reset the LCD to a known state
-  for(delay=0; delay<10; delay=delay+1);// delay minimum 100 ns
+  Delay_us(1);                          // delay minimum 100 ns
   RESET = RESET_HIGH;                   // negative logic
 
-  lcdwrite(COMMAND, 0x21);              // chip active; horizontal addressing mode (V = 0); use extended instruction set (H = 1)
-                                        // set LCD Vop (contrast), which may require some tweaking:
-  lcdwrite(COMMAND, CONTRAST);          // try 0xB1 (for 3.3V red SparkFun), 0xB8 (for 3.3V blue SparkFun), 0xBF if your display is too dark, or 0x80 to 0xFF if experimenting
-  lcdwrite(COMMAND, 0x04);              // set temp coefficient
-  lcdwrite(COMMAND, 0x14);              // LCD bias mode 1:48: try 0x13 or 0x14
-
-  lcdwrite(COMMAND, 0x20);              // we must send 0x20 before modifying the display control mode
-  lcdwrite(COMMAND, 0x0C);              // set display control to normal mode: 0x0D for inverse
+  Phase = 0xFF;                         // DC pin state unknown after reset
+  Nokia5110_OutCommands(InitCommands, sizeof(InitCommands));
 }
 
 //********Nokia5110_OutChar*****************
@@ -264,6 +289,26 @@ void Nokia5110_OutUDec(unsigned short n){
   }
 }
 
+//********Nokia5110_OutBar*****************
+// Print a horizontal bar gauge at the current cursor position.
+// The bar is framed top and bottom, closed on both ends, and
+// solid for the first filled columns.  The cursor advances by
+// columns pixels, so a bar 7*n columns wide fills n characters.
+// inputs: columns  width of the bar in pixels (2 to 84)
+//         filled   number of solid columns (0 to columns)
+// outputs: none
+// assumes: LCD is in default horizontal addressing mode (V = 0)
+void Nokia5110_OutBar(unsigned char columns, unsigned char filled){
+  int i;
+  for(i=0; i<columns; i=i+1){
+    if((i == 0) || (i == columns-1) || (i < filled)){
+      lcdwrite(DATA, 0x7E);             // solid column
+    } else{
+      lcdwrite(DATA, 0x42);             // frame only
+    }
+  }
+}
+
 //********Nokia5110_SetCursor*****************
 // Move the cursor to the desired X- and Y-position.  The
 // next character will be printed here.  X=0 is the leftmost
@@ -276,6 +321,7 @@ void Nokia5110_SetCursor(unsigned char newX, unsigned char newY){
     return;                             // do nothing
   }
   // multiply newX by 7 because each character is 7 columns wide
+  // both commands go out as one batch
   lcdwrite(COMMAND, 0x80|(newX*7));     // setting bit 7 updates X-position
   lcdwrite(COMMAND, 0x40|newY);         // setting bit 6 updates Y-position
 }
@@ -305,3 +351,227 @@ void Nokia5110_DrawFullImage(const char *ptr){
     lcdwrite(DATA, ptr[i]);
   }
 }
+
+//********Nokia5110_ClearBuffer*****************
+// Clear the screen buffer.  Nothing is sent to the LCD until
+// Nokia5110_DisplayBuffer() is called.
+// inputs: none
+// outputs: none
+void Nokia5110_ClearBuffer(void){
+  int i;
+  for(i=0; i<(MAX_X*MAX_Y/32); i=i+1){
+    ScreenWords[i] = 0;
+  }
+}
+
+//********Nokia5110_DisplayBuffer*****************
+// Send the whole screen buffer to the LCD.
+// inputs: none
+// outputs: none
+// assumes: LCD is in default horizontal addressing mode (V = 0)
+void Nokia5110_DisplayBuffer(void){
+  Nokia5110_DrawFullImage((const char *)Screen);
+}
+
+//********Nokia5110_DisplayRect*****************
+// Send the part of the screen buffer covering a rectangle.
+// Whole banks are sent, so the rows are rounded out to
+// multiples of eight.  Clipped to the screen.
+// inputs: x  left column
+//         y  top row
+//         w  width in pixels
+//         h  height in pixels
+// outputs: none
+// assumes: LCD is in default horizontal addressing mode (V = 0)
+void Nokia5110_DisplayRect(unsigned char x, unsigned char y, unsigned char w, unsigned char h){
+  unsigned char bank, last;
+  int i;
+  if((x >= MAX_X) || (y >= MAX_Y) || (w == 0) || (h == 0)){
+    return;
+  }
+  if(w > MAX_X - x) w = MAX_X - x;
+  if(h > MAX_Y - y) h = MAX_Y - y;
+  last = (y + h - 1)>>3;
+  for(bank=y>>3; bank<=last; bank=bank+1){
+    lcdwrite(COMMAND, 0x80|x);          // column of the first byte
+    lcdwrite(COMMAND, 0x40|bank);
+    for(i=0; i<w; i=i+1){
+      lcdwrite(DATA, Screen[bank*MAX_X + x + i]);
+    }
+  }
+}
+
+//********Nokia5110_BufferString*****************
+// Print a string into the screen buffer on the 12x6 character
+// grid used by Nokia5110_SetCursor(), 7 columns per character.
+// Characters past the right edge are dropped.
+// inputs: x    column of the first character (0<=x<=11)
+//         y    row (0<=y<=5)
+//         ptr  pointer to NULL-terminated ASCII string
+// outputs: none
+void Nokia5110_BufferString(unsigned char x, unsigned char y, const char *ptr){
+  unsigned char *p;
+  int i;
+  if(y > 5){
+    return;
+  }
+  while(*ptr && (x < 12)){
+    p = &Screen[y*MAX_X + x*7];
+    p[0] = 0x00;                        // blank vertical line padding
+    for(i=0; i<5; i=i+1){
+      p[i+1] = ASCII[(unsigned char)*ptr - 0x20][i];
+    }
+    p[6] = 0x00;                        // blank vertical line padding
+    x = x + 1;
+    ptr = ptr + 1;
+  }
+}
+
+//********Nokia5110_SetPixel*****************
+// Turn on the pixel at (x, y) in the screen buffer.
+// inputs: x  column (0<=x<=83), 0 is the leftmost
+//         y  row (0<=y<=47), 0 is the top
+// outputs: none
+void Nokia5110_SetPixel(unsigned char x, unsigned char y){
+  if((x < MAX_X) && (y < MAX_Y)){
+    Screen[(y>>3)*MAX_X + x] |= 1<<(y&0x07);
+  }
+}
+
+//********Nokia5110_ClrPixel*****************
+// Turn off the pixel at (x, y) in the screen buffer.
+// inputs: x  column (0<=x<=83), 0 is the leftmost
+//         y  row (0<=y<=47), 0 is the top
+// outputs: none
+void Nokia5110_ClrPixel(unsigned char x, unsigned char y){
+  if((x < MAX_X) && (y < MAX_Y)){
+    Screen[(y>>3)*MAX_X + x] &= ~(1<<(y&0x07));
+  }
+}
+
+//********Nokia5110_FillRect*****************
+// Fill a rectangle of the screen buffer.  Each bank the
+// rectangle crosses is written one byte per column with a mask
+// of the rows inside the rectangle, so a rectangle h rows tall
+// costs about w*(h/8+2) byte writes instead of w*h pixel writes.
+// The rectangle is clipped to the screen.
+// inputs: x      left column
+//         y      top row
+//         w      width in pixels
+//         h      height in pixels
+//         color  1 to turn pixels on, 0 to turn them off
+// outputs: none
+void Nokia5110_FillRect(unsigned char x, unsigned char y, unsigned char w, unsigned char h, unsigned char color){
+  unsigned char *p;
+  unsigned char mask, bank, last, y1;
+  int i;
+  if((x >= MAX_X) || (y >= MAX_Y) || (w == 0) || (h == 0)){
+    return;
+  }
+  if(w > MAX_X - x) w = MAX_X - x;
+  if(h > MAX_Y - y) h = MAX_Y - y;
+  y1 = y + h - 1;                       // bottom row
+  last = y1>>3;
+  for(bank=y>>3; bank<=last; bank=bank+1){
+    mask = 0xFF;
+    if(bank == (y>>3)){
+      mask &= 0xFF<<(y&0x07);           // rows above the rectangle
+    }
+    if(bank == last){
+      mask &= 0xFF>>(7-(y1&0x07));      // rows below the rectangle
+    }
+    p = &Screen[bank*MAX_X + x];
+    if(color){
+      for(i=0; i<w; i=i+1) p[i] |= mask;
+    } else{
+      for(i=0; i<w; i=i+1) p[i] &= ~mask;
+    }
+  }
+}
+
+//********Nokia5110_HLine*****************
+// Draw a horizontal line in the screen buffer.
+// inputs: x      left column
+//         y      row
+//         w      length in pixels
+//         color  1 to turn pixels on, 0 to turn them off
+// outputs: none
+void Nokia5110_HLine(unsigned char x, unsigned char y, unsigned char w, unsigned char color){
+  Nokia5110_FillRect(x, y, w, 1, color);
+}
+
+//********Nokia5110_VLine*****************
+// Draw a vertical line in the screen buffer, one byte write
+// per bank crossed.
+// inputs: x      column
+//         y      top row
+//         h      length in pixels
+//         color  1 to turn pixels on, 0 to turn them off
+// outputs: none
+void Nokia5110_VLine(unsigned char x, unsigned char y, unsigned char h, unsigned char color){
+  Nokia5110_FillRect(x, y, 1, h, color);
+}
+
+//********Nokia5110_BarGauge*****************
+// Draw a framed horizontal bar gauge in the screen buffer.
+// The inside of the frame is filled from the left in
+// proportion to value/max and cleared for the rest.
+// inputs: x      left column
+//         y      top row
+//         w      width in pixels including the frame (3 or more)
+//         h      height in pixels including the frame (3 or more)
+//         value  current value (clipped to max)
+//         max    full scale value
+// outputs: none
+void Nokia5110_BarGauge(unsigned char x, unsigned char y, unsigned char w, unsigned char h,
+                        unsigned long value, unsigned long max){
+  unsigned char fill;
+  if((w < 3) || (h < 3)){
+    return;
+  }
+  if(value > max) value = max;
+  fill = max ? (value*(w - 2))/max : 0;
+  Nokia5110_HLine(x, y, w, 1);          // frame
+  Nokia5110_HLine(x, y+h-1, w, 1);
+  Nokia5110_VLine(x, y, h, 1);
+  Nokia5110_VLine(x+w-1, y, h, 1);
+  Nokia5110_FillRect(x+1, y+1, fill, h-2, 1);
+  Nokia5110_FillRect(x+1+fill, y+1, w-2-fill, h-2, 0);
+}
+
+//********Nokia5110_Sparkline*****************
+// Plot a series of samples as a connected line in the screen
+// buffer, one column per sample, oldest on the left.  The area
+// is cleared first, and each column is drawn as one vertical
+// span from the previous sample to the current one.
+// inputs: x      left column
+//         y      top row
+//         w      width of the plot in pixels
+//         h      height of the plot in pixels
+//         data   samples, data[0] is the oldest
+//         n      number of samples (only the newest w are drawn)
+//         max    value plotted at the top row
+// outputs: none
+void Nokia5110_Sparkline(unsigned char x, unsigned char y, unsigned char w, unsigned char h,
+                         const unsigned char *data, unsigned short n, unsigned char max){
+  unsigned char i, row, prev, top;
+  unsigned short v;
+  if((w == 0) || (h == 0) || (max == 0)){
+    return;
+  }
+  Nokia5110_FillRect(x, y, w, h, 0);
+  if(n > w){
+    data = data + (n - w);              // keep the newest w samples
+    n = w;
+  }
+  prev = 0;
+  for(i=0; i<n; i=i+1){
+    v = data[i];
+    if(v > max) v = max;
+    row = y + (h - 1) - (v*(h - 1))/max;
+    if(i == 0) prev = row;
+    top = (row < prev) ? row : prev;
+    Nokia5110_VLine(x+i, top, ((row < prev) ? prev - row : row - prev) + 1, 1);
+    prev = row;
+  }
+}
@@ -178,6 +178,15 @@ static const char ASCII[][5] = {
 // assumes: system clock rate of 50 MHz or less
 void Nokia5110_Init(void);
 
+//********Nokia5110_OutCommands*****************
+// Send a run of commands to the PCD8544.  The Data/Command pin
+// is switched once for the whole run, and the bytes are queued
+// in the transmit FIFO without waiting for each to finish.
+// inputs: cmds  array of command bytes
+//         n     number of commands
+// outputs: none
+void Nokia5110_OutCommands(const char *cmds, unsigned char n);
+
 //********Nokia5110_OutChar*****************
 // Print a character to the Nokia 5110 48x84 LCD.  The
 // character will be printed at the current cursor position,
@@ -209,6 +218,17 @@ void Nokia5110_OutString(char *ptr);
 // assumes: LCD is in default horizontal addressing mode (V = 0)
 void Nokia5110_OutUDec(unsigned short n);
 
+//********Nokia5110_OutBar*****************
+// Print a horizontal bar gauge at the current cursor position.
+// The bar is framed top and bottom, closed on both ends, and
+// solid for the first filled columns.  The cursor advances by
+// columns pixels, so a bar 7*n columns wide fills n characters.
+// inputs: columns  width of the bar in pixels (2 to 84)
+//         filled   number of solid columns (0 to columns)
+// outputs: none
+// assumes: LCD is in default horizontal addressing mode (V = 0)
+void Nokia5110_OutBar(unsigned char columns, unsigned char filled);
+
 //********Nokia5110_SetCursor*****************
 // Move the cursor to the desired X- and Y-position.  The
 // next character will be printed here.  X=0 is the leftmost
@@ -231,3 +251,113 @@ void Nokia5110_Clear(void);
 // outputs: none
 // assumes: LCD is in default horizontal addressing mode (V = 0)
 void Nokia5110_DrawFullImage(const char *ptr);
+
+// The functions below draw into a screen buffer in RAM that is
+// packed like the PCD8544 RAM (six banks of 84 bytes, one byte
+// per column).  Nothing is sent to the LCD until
+// Nokia5110_DisplayBuffer() is called.
+
+//********Nokia5110_ClearBuffer*****************
+// Clear the screen buffer.
+// inputs: none
+// outputs: none
+void Nokia5110_ClearBuffer(void);
+
+//********Nokia5110_DisplayBuffer*****************
+// Send the whole screen buffer to the LCD.
+// inputs: none
+// outputs: none
+// assumes: LCD is in default horizontal addressing mode (V = 0)
+void Nokia5110_DisplayBuffer(void);
+
+//********Nokia5110_DisplayRect*****************
+// Send the part of the screen buffer covering a rectangle.
+// Whole banks are sent, so the rows are rounded out to
+// multiples of eight.  Clipped to the screen.
+// inputs: x  left column
+//         y  top row
+//         w  width in pixels
+//         h  height in pixels
+// outputs: none
+// assumes: LCD is in default horizontal addressing mode (V = 0)
+void Nokia5110_DisplayRect(unsigned char x, unsigned char y, unsigned char w, unsigned char h);
+
+//********Nokia5110_BufferString*****************
+// Print a string into the screen buffer on the 12x6 character
+// grid used by Nokia5110_SetCursor(), 7 columns per character.
+// Characters past the right edge are dropped.
+// inputs: x    column of the first character (0<=x<=11)
+//         y    row (0<=y<=5)
+//         ptr  pointer to NULL-terminated ASCII string
+// outputs: none
+void Nokia5110_BufferString(unsigned char x, unsigned char y, const char *ptr);
+
+//********Nokia5110_SetPixel*****************
+// Turn on the pixel at (x, y) in the screen buffer.
+// inputs: x  column (0<=x<=83), 0 is the leftmost
+//         y  row (0<=y<=47), 0 is the top
+// outputs: none
+void Nokia5110_SetPixel(unsigned char x, unsigned char y);
+
+//********Nokia5110_ClrPixel*****************
+// Turn off the pixel at (x, y) in the screen buffer.
+// inputs: x  column (0<=x<=83), 0 is the leftmost
+//         y  row (0<=y<=47), 0 is the top
+// outputs: none
+void Nokia5110_ClrPixel(unsigned char x, unsigned char y);
+
+//********Nokia5110_FillRect*****************
+// Fill a rectangle of the screen buffer, one masked byte write
+// per column for each bank crossed.  Clipped to the screen.
+// inputs: x      left column
+//         y      top row
+//         w      width in pixels
+//         h      height in pixels
+//         color  1 to turn pixels on, 0 to turn them off
+// outputs: none
+void Nokia5110_FillRect(unsigned char x, unsigned char y, unsigned char w, unsigned char h, unsigned char color);
+
+//********Nokia5110_HLine*****************
+// Draw a horizontal line in the screen buffer.
+// inputs: x      left column
+//         y      row
+//         w      length in pixels
+//         color  1 to turn pixels on, 0 to turn them off
+// outputs: none
+void Nokia5110_HLine(unsigned char x, unsigned char y, unsigned char w, unsigned char color);
+
+//********Nokia5110_VLine*****************
+// Draw a vertical line in the screen buffer.
+// inputs: x      column
+//         y      top row
+//         h      length in pixels
+//         color  1 to turn pixels on, 0 to turn them off
+// outputs: none
+void Nokia5110_VLine(unsigned char x, unsigned char y, unsigned char h, unsigned char color);
+
+//********Nokia5110_BarGauge*****************
+// Draw a framed horizontal bar gauge in the screen buffer,
+// filled from the left in proportion to value/max.
+// inputs: x      left column
+//         y      top row
+//         w      width in pixels including the frame (3 or more)
+//         h      height in pixels including the frame (3 or more)
+//         value  current value (clipped to max)
+//         max    full scale value
+// outputs: none
+void Nokia5110_BarGauge(unsigned char x, unsigned char y, unsigned char w, unsigned char h,
+                        unsigned long value, unsigned long max);
+
+//********Nokia5110_Sparkline*****************
+// Plot a series of samples as a connected line in the screen
+// buffer, one column per sample, oldest on the left.
+// inputs: x      left column
+//         y      top row
+//         w      width of the plot in pixels
+//         h      height of the plot in pixels
+//         data   samples, data[0] is the oldest
+//         n      number of samples (only the newest w are drawn)
+//         max    value plotted at the top row
+// outputs: none
+void Nokia5110_Sparkline(unsigned char x, unsigned char y, unsigned char w, unsigned char h,
+                         const unsigned char *data, unsigned short n, unsigned char max);
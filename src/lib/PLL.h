@@ -25,6 +25,7 @@
 // the PLL to the desired frequency.
 #define SYSDIV2 7 
 // bus frequency is 400MHz/(SYSDIV2+1) = 400MHz/(7+1) = 50 MHz
+#define BUS_CLOCK (400000000/(SYSDIV2+1))   // bus frequency in Hz
 
 // configure the system to get its clock from the PLL
 void PLL_Init(void);
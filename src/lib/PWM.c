@@ -1,6 +1,7 @@
 // PWM.c
 // Runs on TM4C123
-// Use PWM0/PB6 and PWM1/PB7 to generate pulse-width modulated outputs.
+// Generate pulse-width modulated outputs on any of the 16 outputs
+// of PWM0 and PWM1, described by a table of channels.
 // Daniel Valvano
 // March 28, 2014
 
@@ -22,6 +23,7 @@
  */
 #include <stdint.h>
 #include "PWM.h"
+#include "PLL.h"
 #include "tm4c123gh6pm.h"
 #define PWM_0_GENA_ACTCMPAD_ONE 0x000000C0  // Set the output signal to 1
 #define PWM_0_GENA_ACTLOAD_ZERO 0x00000008  // Set the output signal to 0
@@ -32,47 +34,456 @@
 #define SYSCTL_RCC_PWMDIV_M     0x000E0000  // PWM Unit Clock Divisor
 #define SYSCTL_RCC_PWMDIV_2     0x00000000  // /2
 
+long StartCritical(void);    // previous I bit, disable interrupts
+void EndCritical(long sr);   // restore I bit to previous value
+
+// Registers of PWM module m and of its generator g, 0x40 apart
+#define PWM_BASE(m)        (0x40028000 + 0x1000*(m))
+#define PWM_CTL(m)         (*((volatile unsigned long *)(PWM_BASE(m) + 0x000)))
+#define PWM_ENABLE(m)      (*((volatile unsigned long *)(PWM_BASE(m) + 0x008)))
+#define PWM_INTEN(m)       (*((volatile unsigned long *)(PWM_BASE(m) + 0x014)))
+#define PWM_GEN(m,g,off)   (*((volatile unsigned long *)(PWM_BASE(m) + 0x040 + 0x040*(g) + (off))))
+#define GEN_CTL            0x000
+#define GEN_INTEN          0x004
+#define GEN_ISC            0x00C
+#define GEN_LOAD           0x010
+#define GEN_CMPA           0x018
+#define GEN_GENA           0x020
+#define GEN_GENB           0x024
+
+// Registers of GPIO port p, A to D at 0x1000 apart, E and F after
+#define PORT_BASE(p)       ((p) < 4 ? 0x40004000 + 0x1000*(p) : 0x40024000 + 0x1000*((p) - 4))
+#define PORT_REG(p,off)    (*((volatile unsigned long *)(PORT_BASE(p) + (off))))
+#define PORT_AFSEL         0x420
+#define PORT_DEN           0x51C
+#define PORT_LOCK          0x520
+#define PORT_CR            0x524
+#define PORT_AMSEL         0x528
+#define PORT_PCTL          0x52C
+
+// Interrupt number of each generator
+static const uint8_t Irq[2][4] = {{10, 11, 12, 45}, {134, 135, 136, 137}};
+
+#define FADE_ONE    0x40000000          // fade progress when complete
+
+// Relative luminance of each perceptual level, 0 to 65535, from
+// the CIE 1976 lightness formula with L* = 100*level/255:
+//   Y = L*/903.3              for L* <= 8
+//   Y = ((L* + 16)/116)^3     above
+// evaluated by the compiler in 64-bit integers.
+#define CIE_L(i)    (100ULL*(i))        // L* times 255
+#define CIE_K       (116ULL*255)
+#define CIE(i)      ((CIE_L(i) <= 8*255) ? \
+  (uint16_t)(CIE_L(i)*65535*10/(255*9033)) : \
+  (uint16_t)((CIE_L(i) + 16*255)*(CIE_L(i) + 16*255)*(CIE_L(i) + 16*255)*65535/(CIE_K*CIE_K*CIE_K)))
+#define CIE4(i)     CIE(i), CIE((i)+1), CIE((i)+2), CIE((i)+3)
+#define CIE16(i)    CIE4(i), CIE4((i)+4), CIE4((i)+8), CIE4((i)+12)
+
+static const uint16_t Luminance[PWM_LEVEL_MAX + 1] = {
+  CIE16(0),   CIE16(16),  CIE16(32),  CIE16(48),
+  CIE16(64),  CIE16(80),  CIE16(96),  CIE16(112),
+  CIE16(128), CIE16(144), CIE16(160), CIE16(176),
+  CIE16(192), CIE16(208), CIE16(224), CIE16(240)
+};
+
+// One channel.  During a fade, progress counts from 0 to
+// FADE_ONE by step once per tick; its top 15 bits are the
+// fraction of the fade done, which the curve maps to the
+// fraction of the change made.  A fade started by PWM_SetLevel()
+// moves in perceptual levels with 8 fraction bits, so it looks
+// even to the eye; one started by PWM_Fade() moves in duty cycle.
+// Duty cycles are kept with 8 fraction bits; a dithered channel
+// outputs the fraction over successive periods, the others drop it,
+// and a channel dithered only while fading rounds it at rest.
+typedef struct {
+  volatile unsigned long *cmp;          // comparator of the output
+  uint16_t period;                      // PWM clock cycles per period
+  uint8_t module;                       // 0 or 1
+  uint8_t gen;                          // bit of the generator, for the sync register
+  uint32_t fine;                        // duty cycle being output, 8.8
+  uint32_t target;                      // duty cycle at the end of the fade, 8.8
+  uint8_t dither;                       // PWM_DITHER_OFF, _ON or _FADES
+  uint16_t acc;                         // fraction carried between periods
+  uint16_t level;                       // level being output, 8.8, if perceptual
+  uint8_t perceptual;                   // 1 if start and delta are levels
+  uint8_t curve;                        // PWM_FADE_LINEAR or PWM_FADE_EASE
+  uint8_t active;                       // FADE_RUNNING or FADE_WAITING while fading
+  int32_t start;                        // duty cycle or level when the fade started
+  int32_t delta;                        // change over the whole fade
+  uint32_t progress;
+  uint32_t step;
+} Channel;
+
+#define FADE_RUNNING   1                // stepped by the tick
+#define FADE_WAITING   2                // started in a batch, runs from the commit
+
+static Channel Chans[PWM_MAX_CHANNELS];
+static uint8_t Count;                   // channels in the table
+static uint8_t Dithering;               // number of channels with PWM_DITHER_ON
+static uint8_t Batch;                   // 1 between PWM_Begin() and PWM_Commit()
+static uint8_t Pending[2];              // generators with changes waiting for the commit
+static uint8_t TickModule, TickGen;     // generator whose LOAD interrupt runs the fades
+static uint16_t TickPeriod;
+
+// Turn on a pin for PWM output: PCTL 4 for PWM0, 5 for PWM1
+static void pinInit(uint8_t port, uint8_t pin, uint8_t module){
+  unsigned long bit = 1<<pin;
+  SYSCTL_RCGCGPIO_R |= 1<<port;         // activate the port
+  while((SYSCTL_PRGPIO_R&(1<<port)) == 0){};
+  if(((port == PWM_PORTF) && (pin == 0)) || ((port == PWM_PORTD) && (pin == 7))){
+    PORT_REG(port, PORT_LOCK) = GPIO_LOCK_KEY; // PF0 and PD7 are locked
+    PORT_REG(port, PORT_CR) |= bit;
+  }
+  PORT_REG(port, PORT_AFSEL) |= bit;    // enable alt funct
+  PORT_REG(port, PORT_PCTL) = (PORT_REG(port, PORT_PCTL)&~(0x0FUL<<(4*pin)))|
+                              ((4UL + module)<<(4*pin));
+  PORT_REG(port, PORT_AMSEL) &= ~bit;   // disable analog functionality
+  PORT_REG(port, PORT_DEN) |= bit;      // enable digital I/O
+}
+
+// Comparator value for a duty cycle.  The output goes high when
+// the count down matches, so duty 0 uses a value above LOAD that
+// never matches and the output stays low.
+static unsigned long cmpValue(uint16_t duty){
+  return duty ? duty - 1 : 0xFFFF;
+}
+
+// Set up the outputs of a table of channels.  A channel is
+// referred to by its index in the table.
+void PWM_Init(const PWMChannel *table, uint8_t count){
+  const PWMChannel *t;
+  Channel *c;
+  uint8_t i, m, g, b, irq;
+  unsigned long ctl;
+  if(count > PWM_MAX_CHANNELS){
+    count = PWM_MAX_CHANNELS;
+  }
+  SYSCTL_RCC_R = SYSCTL_RCC_USEPWMDIV | // 3) use PWM divider
+      (SYSCTL_RCC_R & (~SYSCTL_RCC_PWMDIV_M)); //    configure for /2 divider
+  for(i=0; i<count; i=i+1){
+    t = &table[i];
+    c = &Chans[i];
+    m = t->output>>3;
+    g = (t->output>>1)&0x03;
+    b = t->output&0x01;
+    SYSCTL_RCGCPWM_R |= 1<<m;           // 1) activate PWMm
+    while((SYSCTL_PRPWM_R&(1<<m)) == 0){};
+    pinInit(t->port, t->pin, m);        // 2) pin mux
+    ctl = PWM_GEN(m, g, GEN_CTL);
+    PWM_GEN(m, g, GEN_CTL) = 0;         // 4) re-loading down-counting mode, stopped
+    if(b){
+                                        // low on LOAD, high on CMPB down
+      PWM_GEN(m, g, GEN_GENB) = PWM_0_GENB_ACTCMPBD_ONE|PWM_0_GENB_ACTLOAD_ZERO;
+    } else{
+                                        // low on LOAD, high on CMPA down
+      PWM_GEN(m, g, GEN_GENA) = PWM_0_GENA_ACTCMPAD_ONE|PWM_0_GENA_ACTLOAD_ZERO;
+    }
+    PWM_GEN(m, g, GEN_LOAD) = t->period - 1; // 5) cycles needed to count down to 0
+    c->cmp = &PWM_GEN(m, g, GEN_CMPA + 4*b);
+    *c->cmp = cmpValue(t->duty);        // 6) count value when output rises
+    c->period = t->period;
+    c->module = m;
+    c->gen = 1<<g;
+    c->fine = c->target = (uint32_t)t->duty<<8;
+    c->active = c->perceptual = c->dither = 0;
+                                        // 7) start, compare values globally synchronized
+    PWM_GEN(m, g, GEN_CTL) = ctl|PWM_0_CTL_CMPAUPD|PWM_0_CTL_CMPBUPD|PWM_0_CTL_ENABLE;
+    PWM_ENABLE(m) |= 1<<(t->output&0x07);
+  }
+  Count = count;
+  Batch = Dithering = Pending[0] = Pending[1] = 0;
+  if(count){                            // fades run in the LOAD interrupt of channel 0's generator
+    TickModule = Chans[0].module;
+    TickGen = (table[0].output>>1)&0x03;
+    TickPeriod = Chans[0].period;
+    irq = Irq[TickModule][TickGen];
+    PWM_GEN(TickModule, TickGen, GEN_INTEN) = 0; // armed only while fading
+    PWM_INTEN(TickModule) |= 1<<TickGen;
+    *((volatile uint8_t *)(0xE000E400 + irq)) = 0xA0; // priority 5
+    (&NVIC_EN0_R)[irq>>5] = 1<<(irq&0x1F);
+  }
+}
+
+// period of a channel in PWM clock cycles
+uint16_t PWM_Period(uint8_t channel){
+  return Chans[channel].period;
+}
+
+// Load a channel's new compare value at its generator's next zero
+// count, or at the commit during a batch.  Interrupts are disabled.
+static void sync(Channel *c){
+  if(Batch){
+    Pending[c->module] |= c->gen;
+  } else{
+    PWM_CTL(c->module) = c->gen;        // GLOBALSYNCn, writing 0 does nothing
+  }
+}
+
+void PWM_Begin(void){
+  Batch = 1;
+}
+
+// Fades started in the batch begin here, so they take their first
+// step on the same tick and, if they are as long, their last one.
+void PWM_Commit(void){
+  uint8_t i, start = 0;
+  long sr = StartCritical();
+  for(i=0; i<Count; i=i+1){
+    if(Chans[i].active == FADE_WAITING){
+      Chans[i].active = FADE_RUNNING;
+      start = 1;
+    }
+  }
+  if(start){
+    PWM_GEN(TickModule, TickGen, GEN_INTEN) = PWM_0_INTEN_INTCNTLOAD;
+  }
+  PWM_CTL(0) = Pending[0];
+  PWM_CTL(1) = Pending[1];
+  Pending[0] = Pending[1] = 0;
+  Batch = 0;
+  EndCritical(sr);
+}
+
+// Duty cycle, 8.8, of a level with 8 fraction bits: 0 (off) at
+// level 0, then from 2 to period-2 at PWM_LEVEL_MAX, interpolating
+// between levels
+static uint32_t levelFine(Channel *c, uint32_t level){
+  uint32_t i = level>>8, y = Luminance[i];
+  if(level == 0){
+    return 0;
+  }
+  if(level&0xFF){
+    y = y + (((Luminance[i+1] - y)*(level&0xFF))>>8);
+  }
+  return (2UL<<8) + ((y*(c->period - 3))>>8);
+}
+
+// Highest level whose duty cycle is at most fine, 8.8
+static uint16_t fineLevel(Channel *c, uint32_t fine){
+  uint32_t lo = 0, hi = PWM_LEVEL_MAX, mid;
+  while(lo < hi){
+    mid = (lo + hi + 1)/2;
+    if(levelFine(c, mid<<8) <= fine){
+      lo = mid;
+    } else{
+      hi = mid - 1;
+    }
+  }
+  return lo<<8;
+}
+
+// 1 if the tick writes the channel's comparator
+static int dithered(Channel *c){
+  return (c->dither == PWM_DITHER_ON) ||
+         ((c->dither == PWM_DITHER_FADES) && (c->active == FADE_RUNNING));
+}
+
+// Output a duty cycle with 8 fraction bits; the caller syncs.  A
+// dithered channel is written by the next tick.  Interrupts are
+// disabled.
+static void setFine(Channel *c, uint32_t fine){
+  c->fine = fine;
+  if(dithered(c)){                      // the tick writes it
+  } else if(c->dither == PWM_DITHER_FADES){
+    *c->cmp = cmpValue((fine + 128)>>8);        // nearest, at rest
+  } else{
+    *c->cmp = cmpValue(fine>>8);
+  }
+}
+
+// change the duty cycle of a channel with 8 fraction bits, 0 to
+// (period-1)*256, at the next period, stopping any fade on it
+void PWM_DutyFine(uint8_t channel, uint32_t fine){
+  Channel *c = &Chans[channel];
+  long sr = StartCritical();
+  c->active = 0;
+  c->perceptual = 0;
+  c->target = fine;
+  setFine(c, fine);
+  sync(c);
+  EndCritical(sr);
+}
+
+// change the duty cycle of a channel at the next period, stopping
+// any fade on it
+void PWM_Duty(uint8_t channel, uint16_t duty){
+  PWM_DutyFine(channel, (uint32_t)duty<<8);
+}
+
+// dither a channel's duty cycle fraction over successive periods:
+// mode PWM_DITHER_ON always, PWM_DITHER_FADES only while it fades,
+// PWM_DITHER_OFF never
+void PWM_Dither(uint8_t channel, int mode){
+  Channel *c = &Chans[channel];
+  long sr = StartCritical();
+  if(mode && !c->dither){
+    c->acc = 0;
+  }
+  if((mode == PWM_DITHER_ON) && (c->dither != PWM_DITHER_ON)){
+    Dithering = Dithering + 1;
+    PWM_GEN(TickModule, TickGen, GEN_INTEN) = PWM_0_INTEN_INTCNTLOAD;
+  } else if((mode != PWM_DITHER_ON) && (c->dither == PWM_DITHER_ON)){
+    Dithering = Dithering - 1;
+  }
+  c->dither = mode;
+  setFine(c, c->fine);                  // drop or round the fraction if no longer dithered
+  sync(c);
+  EndCritical(sr);
+}
+
+// The value a fade has reached
+static void output(Channel *c, int32_t value){
+  if(c->perceptual){
+    c->level = value;
+    setFine(c, levelFine(c, value));
+  } else{
+    setFine(c, (uint32_t)value<<8);
+  }
+}
+
+// Start a fade from start to end, in duty cycles or levels
+static void startFade(Channel *c, int32_t start, int32_t end, uint16_t ms, uint8_t curve, uint8_t perceptual){
+  uint32_t ticks;
+  long sr;
+                                        // ticks in ms, PWM clock = BUS_CLOCK/2
+  ticks = (uint32_t)ms*((BUS_CLOCK/2)/1000)/TickPeriod;
+  sr = StartCritical();
+  c->perceptual = perceptual;
+  c->target = perceptual ? levelFine(c, end) : (uint32_t)end<<8;
+  if((ticks == 0) || (start == end)){
+    c->active = 0;
+    output(c, end);
+    sync(c);
+  } else{
+    c->start = start;
+    c->delta = end - start;
+    c->curve = curve;
+    c->progress = 0;
+    c->step = FADE_ONE/ticks;
+    if(Batch){
+      c->active = FADE_WAITING;         // PWM_Commit() starts it
+    } else{
+      c->active = FADE_RUNNING;
+      PWM_GEN(TickModule, TickGen, GEN_INTEN) = PWM_0_INTEN_INTCNTLOAD;
+    }
+  }
+  EndCritical(sr);
+}
+
+// start fading a channel toward duty (2<=duty<=period-1) over ms
+// milliseconds, replacing any fade in progress on the channel;
+// ms = 0 changes the duty cycle at the next period
+void PWM_Fade(uint8_t channel, uint16_t duty, uint16_t ms, uint8_t curve){
+  Channel *c = &Chans[channel];
+  startFade(c, c->fine>>8, duty, ms, curve, 0); // from wherever a previous fade got to
+}
+
+// start fading a channel toward a perceptual level, 0 (off) to
+// PWM_LEVEL_MAX, over ms milliseconds; equal steps in level look
+// like equal steps in brightness
+void PWM_SetLevel(uint8_t channel, uint8_t level, uint16_t ms, uint8_t curve){
+  Channel *c = &Chans[channel];
+  uint16_t from;
+  long sr = StartCritical();            // read a consistent starting point
+  from = c->perceptual ? c->level : fineLevel(c, c->fine);
+  EndCritical(sr);
+  startFade(c, from, (uint32_t)level<<8, ms, curve, 1);
+}
+
+// duty cycle of a perceptual level on a channel
+uint16_t PWM_LevelDuty(uint8_t channel, uint8_t level){
+  return levelFine(&Chans[channel], (uint32_t)level<<8)>>8;
+}
+
+// duty cycle the channel is fading toward, or has reached
+uint16_t PWM_Target(uint8_t channel){
+  return Chans[channel].target>>8;
+}
+
+// 1 while the channel is fading
+int PWM_Fading(uint8_t channel){
+  return Chans[channel].active != 0;
+}
+
+// Runs at counter=LOAD of the tick generator while any channel is
+// fading or dithered.  The compare values written here are committed together
+// and loaded at each generator's next zero count, so no pulse is
+// cut short and channels fading together (the colors of an RGB
+// strip) change in the same period.  Generators with a batch in
+// progress are left for PWM_Commit().  About 40 cycles per fading
+// channel: a multiply and shift for a linear fade, three more for
+// the ease curve, and a table lookup and two more for a
+// perceptual fade; about 15 per dithered channel.
+static void tick(void){
+  Channel *c;
+  uint32_t u, t, duty;
+  uint8_t i, fading = 0, touched[2] = {0, 0};
+  PWM_GEN(TickModule, TickGen, GEN_ISC) = PWM_0_INTEN_INTCNTLOAD; // acknowledge
+  for(i=0; i<Count; i=i+1){
+    c = &Chans[i];
+    if(c->active == FADE_RUNNING){
+      c->progress = c->progress + c->step;
+      if(c->progress >= FADE_ONE){
+        c->active = 0;                  // first, so a PWM_DITHER_FADES channel rests
+        output(c, c->start + c->delta);
+      } else{
+        u = c->progress>>15;            // fraction done, 0 to 32767
+        t = u;
+        if(c->curve == PWM_FADE_EASE){  // smoothstep 3u^2 - 2u^3
+          t = (((u*u)>>15)*(3*32768 - 2*u))>>15;
+        }
+        output(c, c->start + ((c->delta*(int32_t)t)>>15));
+        fading = 1;
+      }
+      touched[c->module] |= c->gen;
+    }
+    if(dithered(c)){                    // whole duty cycle plus the carry
+      duty = PWM_DITHER_STEP(c->fine, c->acc);
+      *c->cmp = cmpValue(duty);
+      touched[c->module] |= c->gen;
+    }
+  }
+  PWM_CTL(0) = touched[0]&~Pending[0];
+  PWM_CTL(1) = touched[1]&~Pending[1];
+  if((fading == 0) && (Dithering == 0)){
+    PWM_GEN(TickModule, TickGen, GEN_INTEN) = 0; // nothing left to do each period
+  }
+}
+
+void PWM0Generator0_Handler(void){ tick(); }
+void PWM0Generator1_Handler(void){ tick(); }
+void PWM0Generator2_Handler(void){ tick(); }
+void PWM0Generator3_Handler(void){ tick(); }
+void PWM1Generator0_Handler(void){ tick(); }
+void PWM1Generator1_Handler(void){ tick(); }
+void PWM1Generator2_Handler(void){ tick(); }
+void PWM1Generator3_Handler(void){ tick(); }
 
 // period is 16-bit number of PWM clock cycles in one period (3<=period)
-// period for PA6 and PA7 must be the same
+// period for PB6 and PB4 must be the same
 // duty is number of PWM clock cycles output is high  (2<=duty<=period-1)
 // PWM clock rate = processor clock rate/SYSCTL_RCC_PWMDIV
 //                = BusClock/2 
 //                = 50 MHz/2 = 25 MHz 
 void M0PWM0_M0PM2_Init(uint16_t period, uint16_t duty){
-  SYSCTL_RCGCPWM_R |= 0x01;             // 1) activate PWM0
-  SYSCTL_RCGCGPIO_R |= 0x02;            // 2) activate port B
-  while((SYSCTL_PRGPIO_R&0x02) == 0){};
-  GPIO_PORTB_AFSEL_R |= 0x50;           // enable alt funct on PB4,6
-  GPIO_PORTB_PCTL_R &= ~0x0F0F0000;     // configure PB4,6 as PWM0
-  GPIO_PORTB_PCTL_R |= 0x04040000;
-  GPIO_PORTB_AMSEL_R &= ~0x50;          // disable analog functionality on PB4,6
-  GPIO_PORTB_DEN_R |= 0x50;             // enable digital I/O on PB4,6
-      
-  SYSCTL_RCC_R = 0x00100000 |           // 3) use PWM divider
-      (SYSCTL_RCC_R & (~0x000E0000));   //    configure for /2 divider
-  PWM0_0_CTL_R = 0;                     // 4) re-loading down-counting mode
-  PWM0_1_CTL_R = 0;                     // 4) re-loading down-counting mode
-      
-  PWM0_0_GENA_R = 0xC8;                 // low on LOAD, high on CMPA down
-  PWM0_1_GENA_R = 0xC8;                 // low on LOAD, high on CMPA down 
-  PWM0_0_LOAD_R = period - 1;           // 5) cycles needed to count down to 0
-  PWM0_1_LOAD_R = period - 1;           // 5) cycles needed to count down to 0
-  PWM0_0_CMPA_R = duty - 1;             // 6) count value when output rises
-  PWM0_1_CMPA_R = duty - 1;             // 6) count value when output rises
-      
-  PWM0_0_CTL_R  |= 0x00000001;          // 7) start PWM0
-  PWM0_1_CTL_R  |= 0x00000001;          // 7) start PWM0
-  PWM0_ENABLE_R |= PWM_ENABLE_PWM0EN | PWM_ENABLE_PWM2EN; // enable PB6,4/M0PWM0,2
-}
-// change duty cycle of PA6
+  PWMChannel table[2];
+  table[PWM_CH0].output = PWM_M0PWM0;   // PB6
+  table[PWM_CH0].port = PWM_PORTB;
+  table[PWM_CH0].pin = 6;
+  table[PWM_CH2].output = PWM_M0PWM2;   // PB4
+  table[PWM_CH2].port = PWM_PORTB;
+  table[PWM_CH2].pin = 4;
+  table[PWM_CH0].period = table[PWM_CH2].period = period;
+  table[PWM_CH0].duty = table[PWM_CH2].duty = duty;
+  PWM_Init(table, 2);
+}
+// change duty cycle of PB6
 // duty is number of PWM clock cycles output is high  (2<=duty<=period-1)
 void M0PWM0_Duty(uint16_t duty){
-  PWM0_0_CMPA_R = duty - 1;             // 6) count value when output rises
+  PWM_Duty(PWM_CH0, duty);
 }
-// change duty cycle of PA7
+// change duty cycle of PB4
 // duty is number of PWM clock cycles output is high  (2<=duty<=period-1)
 void M0PWM2_Duty(uint16_t duty){
-  PWM0_1_CMPA_R = duty - 1;             // 6) count value when output rises
+  PWM_Duty(PWM_CH2, duty);
 }
-
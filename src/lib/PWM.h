@@ -1,6 +1,7 @@
 // PWM.h
 // Runs on TM4C123
-// Use PWM0/PB6 and PWM1/PB7 to generate pulse-width modulated outputs.
+// Generate pulse-width modulated outputs on any of the 16 outputs
+// of PWM0 and PWM1, described by a table of channels.
 // Daniel Valvano
 // March 28, 2014
 
@@ -23,18 +24,152 @@
 
 #include <stdint.h>
 
-// period is 16-bit number of PWM clock cycles in one period (3<=period)
-// period for PB6 and PB7 must be the same
-// duty is number of PWM clock cycles output is high  (2<=duty<=period-1)
+// Outputs, module*8 + generator*2 + (1 for the B comparator)
+#define PWM_M0PWM0         0
+#define PWM_M0PWM1         1
+#define PWM_M0PWM2         2
+#define PWM_M0PWM3         3
+#define PWM_M0PWM4         4
+#define PWM_M0PWM5         5
+#define PWM_M0PWM6         6
+#define PWM_M0PWM7         7
+#define PWM_M1PWM0         8
+#define PWM_M1PWM1         9
+#define PWM_M1PWM2         10
+#define PWM_M1PWM3         11
+#define PWM_M1PWM4         12
+#define PWM_M1PWM5         13
+#define PWM_M1PWM6         14
+#define PWM_M1PWM7         15
+
+// Ports for PWMChannel.port
+#define PWM_PORTA          0
+#define PWM_PORTB          1
+#define PWM_PORTC          2
+#define PWM_PORTD          3
+#define PWM_PORTE          4
+#define PWM_PORTF          5
+
+// Pins each output can use (PCTL 4 for M0PWMn, 5 for M1PWMn)
+//   M0PWM0 PB6   M0PWM1 PB7   M0PWM2 PB4   M0PWM3 PB5
+//   M0PWM4 PE4   M0PWM5 PE5   M0PWM6 PC4, PD0   M0PWM7 PC5, PD1
+//   M1PWM0 PD0   M1PWM1 PD1   M1PWM2 PA6, PE4   M1PWM3 PA7, PE5
+//   M1PWM4 PF0   M1PWM5 PF1   M1PWM6 PF2   M1PWM7 PF3
+typedef struct {
+  uint8_t output;                       // PWM_M0PWM0 to PWM_M1PWM7
+  uint8_t port;                         // PWM_PORTA to PWM_PORTF
+  uint8_t pin;                          // 0 to 7
+  uint16_t period;                      // PWM clock cycles in one period (3<=period),
+                                        //   the A and B outputs of a generator share it
+  uint16_t duty;                        // initial duty cycle (2<=duty<=period-1)
+} PWMChannel;
+
+#define PWM_MAX_CHANNELS   16
+
+// Set up the outputs of a table of channels.  A channel is
+// referred to by its index in the table.  Each generator counts
+// down from period-1, its outputs are low on LOAD and high on
+// the compare match, and the compare values of every generator
+// are globally synchronized: a change is only loaded at the
+// first zero count after it is committed.
 // PWM clock rate = processor clock rate/SYSCTL_RCC_PWMDIV
 //                = BusClock/2 
-//                = 80 MHz/2 = 40 MHz (in this example)
-// Output on PB6/M0PWM0
+//                = 50 MHz/2 = 25 MHz 
+void PWM_Init(const PWMChannel *table, uint8_t count);
+
+// change the duty cycle of a channel at the next period, stopping
+// any fade on it; inside PWM_Begin()/PWM_Commit() the change waits
+// for the commit
+// duty is number of PWM clock cycles output is high  (2<=duty<=period-1),
+// 0 turns the output off
+void PWM_Duty(uint8_t channel, uint16_t duty);
+
+// change the duty cycle of a channel with 8 fraction bits, 0 to
+// (period-1)*256, at the next period, stopping any fade on it;
+// the fraction is only output by a dithered channel
+void PWM_DutyFine(uint8_t channel, uint32_t fine);
+
+// Temporal dithering.  A dithered channel outputs the whole part
+// of its duty cycle plus the carry from a fraction accumulated
+// each period, so the average over 256 periods has 8 more bits of
+// resolution.  This lets the period be short (tens of kHz, no
+// flicker on camera) without coarse dimming steps.  It costs an
+// interrupt every period of the tick generator (see the fade
+// engine below), so dithered channels should share its period.
+// With PWM_DITHER_FADES a channel is only dithered while it fades,
+// where the fine steps show, and at rest its duty cycle is rounded
+// to the nearest whole cycle, so the tick stops once the fades end.
+#define PWM_DITHER_OFF     0
+#define PWM_DITHER_ON      1            // every period, the tick never stops
+#define PWM_DITHER_FADES   2            // only while fading
+
+// dither a channel's duty cycle fraction over successive periods:
+// mode PWM_DITHER_ON always, PWM_DITHER_FADES only while it fades,
+// PWM_DITHER_OFF never
+void PWM_Dither(uint8_t channel, int mode);
+
+// One period of dithering.  fine is a duty cycle with 8 fraction
+// bits and acc the fraction carried from earlier periods (0 to
+// 255, updated); gives the whole duty cycle to output this period.
+// First order error feedback: the high periods are spread as
+// evenly as possible.  Also used by src/tools/DitherSim.c.
+#define PWM_DITHER_STEP(fine, acc) \
+  ((acc) = ((acc)&0xFF) + ((fine)&0xFF), ((fine)>>8) + ((acc)>>8))
+
+// period of a channel in PWM clock cycles
+uint16_t PWM_Period(uint8_t channel);
+
+// Batch update.  PWM_Duty(), PWM_Fade() and PWM_SetLevel() calls
+// between PWM_Begin() and PWM_Commit() take effect together, in
+// the same period of each generator.  Fades started in a batch
+// all start at the commit, so fades of the same length also end
+// in the same period (see Scene.h).  Not nested.
+void PWM_Begin(void);
+void PWM_Commit(void);
+
+// period is 16-bit number of PWM clock cycles in one period (3<=period)
+// period for PB6 and PB4 must be the same
+// duty is number of PWM clock cycles output is high  (2<=duty<=period-1)
+// Outputs on PB6/M0PWM0 (channel PWM_CH0) and PB4/M0PWM2 (channel PWM_CH2)
 void M0PWM0_M0PM2_Init(uint16_t period, uint16_t duty);
 
-// change duty cycle of PB6
+// change duty cycle of PB6, stopping any fade on it
 // duty is number of PWM clock cycles output is high  (2<=duty<=period-1)
 void M0PWM0_Duty(uint16_t duty);    //PB6
 void M0PWM2_Duty(uint16_t duty);    //PB4
 
+// Channels set up by M0PWM0_M0PM2_Init()
+#define PWM_CH0            0            // M0PWM0, PB6
+#define PWM_CH2            1            // M0PWM2, PB4
+
+// Fade engine.  Each channel ramps from its current duty cycle
+// to a target over a given time.  The new compare values are
+// computed in the counter=LOAD interrupt of the generator of
+// channel 0, once per its period, and committed together; every
+// generator only loads them at its next zero count, so a ramp
+// never glitches a pulse.  The interrupt is armed only while a
+// fade is running.
+#define PWM_LEVEL_MAX      255          // brightest perceptual level
+
+#define PWM_FADE_LINEAR    0            // constant rate
+#define PWM_FADE_EASE      1            // smoothstep, slow at both ends
+
+// start fading a channel toward duty (2<=duty<=period-1) over ms
+// milliseconds, replacing any fade in progress on the channel;
+// ms = 0 changes the duty cycle at the next period
+void PWM_Fade(uint8_t channel, uint16_t duty, uint16_t ms, uint8_t curve);
+
+// start fading a channel toward a perceptual level, 0 (off) to
+// PWM_LEVEL_MAX, over ms milliseconds; levels follow CIE
+// lightness, so equal steps in level look like equal steps in
+// brightness
+void PWM_SetLevel(uint8_t channel, uint8_t level, uint16_t ms, uint8_t curve);
+
+// duty cycle of a perceptual level on a channel
+uint16_t PWM_LevelDuty(uint8_t channel, uint8_t level);
+
+// duty cycle the channel is fading toward, or has reached
+uint16_t PWM_Target(uint8_t channel);
 
+// 1 while the channel is fading
+int PWM_Fading(uint8_t channel);
@@ -0,0 +1,189 @@
+// Pixel.c
+// Runs on LM4F120/TM4C123, or a PC
+// Bulk pixel format conversion into the 16-bit color format of
+// the ST7735 driver, the same packing as ST7735_Color565():
+// blue in bits 15-11, green in bits 10-5, red in bits 4-0.
+// On a Cortex-M4 the loops work on two pixels per 32-bit word
+// with the DSP extension (UXTB16, REV16); elsewhere, or with
+// PIXEL_NO_SIMD defined, plain C versions give the same results.
+// Chanartip Soonthornwan
+
+#include <stdint.h>
+#include <string.h>
+#include "Pixel.h"
+
+#if !defined(PIXEL_NO_SIMD) && defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+// armclang, gcc: ACLE intrinsics
+#include <arm_acle.h>
+#define PIXEL_SIMD
+#define UXTB16(x) __uxtb16(x)
+#define REV16(x)  __rev16(x)
+#elif !defined(PIXEL_NO_SIMD) && defined(__CC_ARM) && defined(__TARGET_FEATURE_DSPMUL)
+// Keil armcc for Cortex-M4: __uxtb16 is built in, REV16 is not
+#define PIXEL_SIMD
+#define UXTB16(x) __uxtb16(x)
+#define REV16(x)  rev16(x)
+static __asm uint32_t rev16(uint32_t x){
+  rev16 r0, r0
+  bx lr
+}
+#elif !defined(PIXEL_NO_SIMD) && defined(PIXEL_SIMULATE)
+// On a PC (src/tools/PixelSim.c): the same loops, with C versions
+// of the two instructions
+#define PIXEL_SIMD
+#define UXTB16(x) ((x)&0x00FF00FF)
+#define REV16(x)  ((((x)&0xFF00FF00)>>8)|(((x)&0x00FF00FF)<<8))
+#endif
+
+#ifdef PIXEL_SIMD
+// Pack two pixels at once.  r, g and b each hold one 8-bit
+// channel in each 16-bit half; the result holds two colors.
+// No field crosses from one half to the other.
+#define PACK2(r, g, b) ((((b) & 0x00F800F8) << 8) | (((g) & 0x00FC00FC) << 3) | (((r) >> 3) & 0x001F001F))
+
+// Read a word from a byte address that may not be aligned.
+// The Cortex-M4 allows unaligned single word loads, so this
+// compiles to one LDR.
+static uint32_t load32(const void *p){
+  uint32_t w;
+  memcpy(&w, p, 4);
+  return w;
+}
+#endif
+
+//------------Pixel_RGB888To565------------
+// Convert 24-bit pixels stored as red, green, blue bytes (the
+// order of most image tools' raw RGB output) to 16-bit colors.
+// Input: dst 16-bit colors out, n entries
+//        src 3*n bytes in
+//        n   number of pixels
+// Output: none
+void Pixel_RGB888To565(uint16_t *dst, const uint8_t *src, uint32_t n){
+#ifdef PIXEL_SIMD
+  uint32_t w0, w1, w2, a, b, c, d, e, f;
+  uint32_t *out;
+  if(n && ((uintptr_t)dst & 0x02)){     // one pixel to align dst
+    *dst++ = PIXEL_565(src[0], src[1], src[2]);
+    src = src + 3;
+    n = n - 1;
+  }
+  out = (uint32_t *)dst;
+  while(n >= 4){
+    // 4 pixels in 3 words: R0 G0 B0 R1 | G1 B1 R2 G2 | B2 R3 G3 B3
+    w0 = load32(src); w1 = load32(src+4); w2 = load32(src+8);
+    a = UXTB16(w0);                     // R0 B0
+    b = UXTB16(w0>>8);                  // G0 R1
+    c = UXTB16(w1);                     // G1 R2
+    d = UXTB16(w1>>8);                  // B1 G2
+    e = UXTB16(w2);                     // B2 G3
+    f = UXTB16(w2>>8);                  // R3 B3
+    out[0] = PACK2((a&0xFFFF)|(b&0xFFFF0000), (b&0xFFFF)|(c<<16), (a>>16)|(d<<16));
+    out[1] = PACK2((c>>16)|(f<<16), (d>>16)|(e&0xFFFF0000), (e&0xFFFF)|(f&0xFFFF0000));
+    out = out + 2;
+    src = src + 12;
+    n = n - 4;
+  }
+  dst = (uint16_t *)out;
+#endif
+  while(n){
+    *dst++ = PIXEL_565(src[0], src[1], src[2]);
+    src = src + 3;
+    n = n - 1;
+  }
+}
+
+//------------Pixel_GrayTo565------------
+// Convert 8-bit grayscale pixels to 16-bit colors.
+// Input: dst 16-bit colors out, n entries
+//        src n bytes in, 0 black to 255 white
+//        n   number of pixels
+// Output: none
+void Pixel_GrayTo565(uint16_t *dst, const uint8_t *src, uint32_t n){
+#ifdef PIXEL_SIMD
+  uint32_t w, even, odd;
+  uint32_t *out;
+  if(n && ((uintptr_t)dst & 0x02)){     // one pixel to align dst
+    *dst++ = PIXEL_565(*src, *src, *src);
+    src = src + 1;
+    n = n - 1;
+  }
+  out = (uint32_t *)dst;
+  while(n >= 4){
+    w = load32(src);
+    even = UXTB16(w);                   // pixels 0 and 2
+    odd = UXTB16(w>>8);                 // pixels 1 and 3
+    even = PACK2(even, even, even);
+    odd = PACK2(odd, odd, odd);
+    out[0] = (even&0xFFFF)|(odd<<16);   // pixels 0 and 1
+    out[1] = (even>>16)|(odd&0xFFFF0000); // pixels 2 and 3
+    out = out + 2;
+    src = src + 4;
+    n = n - 4;
+  }
+  dst = (uint16_t *)out;
+#endif
+  while(n){
+    *dst++ = PIXEL_565(*src, *src, *src);
+    src = src + 1;
+    n = n - 1;
+  }
+}
+
+//------------Pixel_Swap565------------
+// Swap the two bytes of each 16-bit color, to convert between
+// the in-memory order and the most significant byte first order
+// the LCD receives, e.g. for images sent a byte at a time.
+// Input: dst 16-bit colors out, may be the same as src
+//        src 16-bit colors in
+//        n   number of pixels
+// Output: none
+void Pixel_Swap565(uint16_t *dst, const uint16_t *src, uint32_t n){
+#ifdef PIXEL_SIMD
+  uint32_t *out;
+  if(n && ((uintptr_t)dst & 0x02)){     // one pixel to align dst
+    *dst++ = (uint16_t)((*src << 8) | (*src >> 8));
+    src = src + 1;
+    n = n - 1;
+  }
+  out = (uint32_t *)dst;
+  while(n >= 2){
+    *out++ = REV16(load32(src));        // two pixels per instruction
+    src = src + 2;
+    n = n - 2;
+  }
+  dst = (uint16_t *)out;
+#endif
+  while(n){
+    *dst++ = (uint16_t)((*src << 8) | (*src >> 8));
+    src = src + 1;
+    n = n - 1;
+  }
+}
+
+//------------Pixel_Gradient565------------
+// Fill a buffer with a linear gradient between two colors, each
+// channel interpolated at 8 bits before packing.
+// Input: dst   16-bit colors out
+//        n     number of pixels, the first is rgb0 and the last rgb1
+//        rgb0  first color as 0xRRGGBB
+//        rgb1  last color as 0xRRGGBB
+// Output: none
+void Pixel_Gradient565(uint16_t *dst, uint32_t n, uint32_t rgb0, uint32_t rgb1){
+  int32_t r, g, b, dr, dg, db;
+  if(n == 0) return;
+  // channels in 16.16 fixed point, rounded to nearest
+  r = ((rgb0>>16)&0xFF)<<16; g = ((rgb0>>8)&0xFF)<<16; b = (rgb0&0xFF)<<16;
+  if(n > 1){
+    dr = ((int32_t)(((rgb1>>16)&0xFF)<<16) - r)/(int32_t)(n - 1);
+    dg = ((int32_t)(((rgb1>>8)&0xFF)<<16) - g)/(int32_t)(n - 1);
+    db = ((int32_t)((rgb1&0xFF)<<16) - b)/(int32_t)(n - 1);
+  } else{
+    dr = dg = db = 0;
+  }
+  r = r + 0x8000; g = g + 0x8000; b = b + 0x8000;
+  while(n){
+    *dst++ = PIXEL_565(r>>16, g>>16, b>>16);
+    r = r + dr; g = g + dg; b = b + db;
+    n = n - 1;
+  }
+}
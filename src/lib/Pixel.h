@@ -0,0 +1,57 @@
+// Pixel.h
+// Runs on LM4F120/TM4C123
+// Bulk pixel format conversion into the 16-bit color format of
+// the ST7735 driver, the same packing as ST7735_Color565():
+// blue in bits 15-11, green in bits 10-5, red in bits 4-0.
+// On a Cortex-M4 the loops work on two pixels per 32-bit word
+// with the DSP extension (UXTB16, REV16); elsewhere, or with
+// PIXEL_NO_SIMD defined, plain C versions give the same results.
+// On a PC, PIXEL_SIMULATE runs the word at a time loops with C
+// versions of the instructions, to check them (src/tools/PixelSim.c).
+// Chanartip Soonthornwan
+
+#ifndef __PIXEL_H__ // do not include more than once
+#define __PIXEL_H__
+#include <stdint.h>
+
+// Pack one 8-bit per channel color, same as ST7735_Color565()
+#define PIXEL_565(r, g, b) ((((b) & 0xF8) << 8) | (((g) & 0xFC) << 3) | ((r) >> 3))
+
+//------------Pixel_RGB888To565------------
+// Convert 24-bit pixels stored as red, green, blue bytes (the
+// order of most image tools' raw RGB output) to 16-bit colors.
+// Input: dst 16-bit colors out, n entries
+//        src 3*n bytes in
+//        n   number of pixels
+// Output: none
+void Pixel_RGB888To565(uint16_t *dst, const uint8_t *src, uint32_t n);
+
+//------------Pixel_GrayTo565------------
+// Convert 8-bit grayscale pixels to 16-bit colors.
+// Input: dst 16-bit colors out, n entries
+//        src n bytes in, 0 black to 255 white
+//        n   number of pixels
+// Output: none
+void Pixel_GrayTo565(uint16_t *dst, const uint8_t *src, uint32_t n);
+
+//------------Pixel_Swap565------------
+// Swap the two bytes of each 16-bit color, to convert between
+// the in-memory order and the most significant byte first order
+// the LCD receives, e.g. for images sent a byte at a time.
+// Input: dst 16-bit colors out, may be the same as src
+//        src 16-bit colors in
+//        n   number of pixels
+// Output: none
+void Pixel_Swap565(uint16_t *dst, const uint16_t *src, uint32_t n);
+
+//------------Pixel_Gradient565------------
+// Fill a buffer with a linear gradient between two colors, each
+// channel interpolated at 8 bits before packing.
+// Input: dst   16-bit colors out
+//        n     number of pixels, the first is rgb0 and the last rgb1
+//        rgb0  first color as 0xRRGGBB
+//        rgb1  last color as 0xRRGGBB
+// Output: none
+void Pixel_Gradient565(uint16_t *dst, uint32_t n, uint32_t rgb0, uint32_t rgb1);
+
+#endif // __PIXEL_H__
@@ -0,0 +1,159 @@
+// SSI.c
+// Runs on LM4F120/TM4C123
+// Bus manager for the four SSI modules.  Each SPI peripheral is
+// described by an SSIDevice (module, clock, SPI mode, frame size,
+// chip select and data/command pins).  The manager sets up the
+// module and its pins when the first device registers, and loads
+// a device's bus settings only when the module switches to it.
+// Chanartip Soonthornwan
+
+#include <stdint.h>
+#include "tm4c123gh6pm.h"
+#include "SSI.h"
+
+long StartCritical(void);    // previous I bit, disable interrupts
+void EndCritical(long sr);   // restore I bit to previous value
+
+// Registers of module m, which are 0x1000 apart
+#define SSI_BASE(m)    (0x40008000 + 0x1000*(m))
+#define SSI_CR0(m)     (*((volatile unsigned long *)(SSI_BASE(m) + 0x000)))
+#define SSI_CR1(m)     (*((volatile unsigned long *)(SSI_BASE(m) + 0x004)))
+#define SSI_SR(m)      (*((volatile unsigned long *)(SSI_BASE(m) + 0x00C)))
+#define SSI_CPSR(m)    (*((volatile unsigned long *)(SSI_BASE(m) + 0x010)))
+#define SSI_CC(m)      (*((volatile unsigned long *)(SSI_BASE(m) + 0xFC8)))
+
+#define CS_HIGH        0xFF    // any bit set, the address selects the pin
+#define CS_LOW         0x00
+
+static SSIDevice *Current[SSI_MODULES]; // device whose settings are loaded
+static uint8_t Started;                 // bit m set once module m is on
+
+// Set the PCTL fields of the pins in bits to function fn.
+static unsigned long pctl(unsigned long reg, unsigned long bits, unsigned long fn){
+  int i;
+  for(i=0; i<8; i=i+1){
+    if(bits&(1<<i)){
+      reg = (reg&~(0x0FUL<<(4*i)))|(fn<<(4*i));
+    }
+  }
+  return reg;
+}
+
+// Turn on the pins of module m: Clk and Tx, plus Fss and Rx if asked.
+static void pinInit(uint8_t m, uint8_t fss, uint8_t rx){
+  volatile unsigned long delay;
+  unsigned long bits;
+  switch(m){
+    case 0:                             // PA2 Clk, PA3 Fss, PA4 Rx, PA5 Tx
+      SYSCTL_RCGCGPIO_R |= 0x01;
+      delay = SYSCTL_RCGCGPIO_R;
+      bits = 0x24|(fss ? 0x08 : 0)|(rx ? 0x10 : 0);
+      GPIO_PORTA_AFSEL_R |= bits;
+      GPIO_PORTA_DEN_R |= bits;
+      GPIO_PORTA_PCTL_R = pctl(GPIO_PORTA_PCTL_R, bits, 2);
+      GPIO_PORTA_AMSEL_R &= ~bits;
+      break;
+    case 1:                             // PF2 Clk, PF3 Fss, PF0 Rx, PF1 Tx
+      SYSCTL_RCGCGPIO_R |= 0x20;
+      delay = SYSCTL_RCGCGPIO_R;
+      bits = 0x06|(fss ? 0x08 : 0)|(rx ? 0x01 : 0);
+      GPIO_PORTF_LOCK_R = GPIO_LOCK_KEY;  // PF0 is locked
+      GPIO_PORTF_CR_R |= bits;
+      GPIO_PORTF_AFSEL_R |= bits;
+      GPIO_PORTF_DEN_R |= bits;
+      GPIO_PORTF_PCTL_R = pctl(GPIO_PORTF_PCTL_R, bits, 2);
+      GPIO_PORTF_AMSEL_R &= ~bits;
+      break;
+    case 2:                             // PB4 Clk, PB5 Fss, PB6 Rx, PB7 Tx
+      SYSCTL_RCGCGPIO_R |= 0x02;
+      delay = SYSCTL_RCGCGPIO_R;
+      bits = 0x90|(fss ? 0x20 : 0)|(rx ? 0x40 : 0);
+      GPIO_PORTB_AFSEL_R |= bits;
+      GPIO_PORTB_DEN_R |= bits;
+      GPIO_PORTB_PCTL_R = pctl(GPIO_PORTB_PCTL_R, bits, 2);
+      GPIO_PORTB_AMSEL_R &= ~bits;
+      break;
+    case 3:                             // PD0 Clk, PD1 Fss, PD2 Rx, PD3 Tx
+      SYSCTL_RCGCGPIO_R |= 0x08;
+      delay = SYSCTL_RCGCGPIO_R;
+      bits = 0x09|(fss ? 0x02 : 0)|(rx ? 0x04 : 0);
+      GPIO_PORTD_AFSEL_R |= bits;
+      GPIO_PORTD_DEN_R |= bits;
+      GPIO_PORTD_PCTL_R = pctl(GPIO_PORTD_PCTL_R, bits, 1);
+      GPIO_PORTD_AMSEL_R &= ~bits;
+      break;
+  }
+  (void)delay;
+}
+
+// Load the settings of dev into its module and move the chip
+// select to it.  The module must not be busy.
+static void load(SSIDevice *dev){
+  uint8_t m = dev->module;
+  SSIDevice *old = Current[m];
+  if(old && old->cs){
+    *old->cs = CS_HIGH;
+  }
+  SSI_CR1(m) &= ~SSI_CR1_SSE;           // settings only change while disabled
+  SSI_CPSR(m) = dev->cpsr;
+  SSI_CR0(m) = (dev->scr<<8)|((dev->mode&0x02) ? SSI_CR0_SPO : 0)|
+               ((dev->mode&0x01) ? SSI_CR0_SPH : 0)|SSI_CR0_FRF_MOTO|(dev->bits - 1);
+  SSI_CR1(m) |= SSI_CR1_SSE;
+  if(dev->cs){
+    *dev->cs = CS_LOW;
+  }
+  Current[m] = dev;
+}
+
+//********SSI_Register*****************
+// Prepare the module and pins used by a device.  The first device
+// on a module turns the module on; the device's GPIO chip select,
+// if any, must already be a digital output, and is set high.
+// inputs: dev  device, must stay valid, stats are cleared
+// outputs: none
+void SSI_Register(SSIDevice *dev){
+  uint8_t m = dev->module;
+  dev->stats.selects = dev->stats.bytes = 0;
+  if(dev->cs){
+    *dev->cs = CS_HIGH;
+  }
+  if(Current[m] == dev){
+    Current[m] = 0;                     // the next SSI_Select() lowers CS again
+  }
+  if((Started&(1<<m)) == 0){
+    SYSCTL_RCGCSSI_R |= 1<<m;           // activate SSIm
+    while((SYSCTL_PRSSI_R&(1<<m)) == 0){};
+    SSI_CR1(m) = 0;                     // disabled, master mode
+    SSI_CC(m) = SSI_CC_CS_SYSPLL;       // bus clock
+    Started |= 1<<m;
+  }
+  pinInit(m, dev->cs == 0, dev->rx);
+}
+
+//********SSI_Select*****************
+// Make dev the device on its module, loading its clock, mode and
+// frame size and moving the chip select if another device was
+// selected.  Waits for the previous device's frames to finish.
+// inputs: dev  registered device
+// outputs: 1 if the module switched to dev, 0 if it already was
+int SSI_Select(SSIDevice *dev){
+  long sr;
+  if(Current[dev->module] == dev){
+    return 0;
+  }
+  sr = StartCritical();
+  while(SSI_SR(dev->module)&SSI_SR_BSY){};
+  load(dev);
+  dev->stats.selects = dev->stats.selects + 1;
+  EndCritical(sr);
+  return 1;
+}
+
+//********SSI_Count*****************
+// Add to the number of bytes sent to a device.
+// inputs: dev  registered device
+//         n    bytes the driver wrote to the module
+// outputs: none
+void SSI_Count(SSIDevice *dev, uint32_t n){
+  dev->stats.bytes = dev->stats.bytes + n;
+}
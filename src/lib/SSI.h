@@ -0,0 +1,77 @@
+// SSI.h
+// Runs on LM4F120/TM4C123
+// Bus manager for the four SSI modules.  Each SPI peripheral is
+// described by an SSIDevice (module, clock, SPI mode, frame size,
+// chip select and data/command pins).  The manager sets up the
+// module and its pins when the first device registers, and loads
+// a device's bus settings only when the module switches to it.
+// Chanartip Soonthornwan
+
+// Drivers that write the SSI registers themselves (Nokia5110.c,
+// ST7735.c) call SSI_Select() before touching the module; it
+// costs one comparison when the device is already selected.
+// A transaction runs from its first SSI_Select() until another
+// device is selected, so the callers keep transactions on one
+// module from overlapping: on the master both displays are drawn
+// from one thread, or, with the kernel, under the SsiBus mutex.
+// Drivers report the frames they send with SSI_Count().
+
+// Default pins of each module (PCTL function in brackets)
+//   SSI0  PA2 Clk, PA3 Fss, PA4 Rx, PA5 Tx  (2)
+//   SSI1  PF2 Clk, PF3 Fss, PF0 Rx, PF1 Tx  (2)
+//   SSI2  PB4 Clk, PB5 Fss, PB6 Rx, PB7 Tx  (2)
+//   SSI3  PD0 Clk, PD1 Fss, PD2 Rx, PD3 Tx  (1)
+// Clk and Tx are always used.  Fss is used by a device with no
+// GPIO chip select; it frames every byte the module sends, so
+// such a device should be the only one on its module.  Rx is
+// only used by a device that reads.
+
+#ifndef __SSI_H__ // do not include more than once
+#define __SSI_H__
+#include <stdint.h>
+
+#define SSI_MODULES    4
+
+typedef struct {
+  uint32_t selects;                     // times the module switched to this device
+  uint32_t bytes;                       // bytes sent, counted with SSI_Count()
+} SSIStats;
+
+typedef struct {
+  uint8_t module;                       // 0 to 3
+  uint8_t cpsr;                         // clock prescale, even, 2 to 254
+  uint8_t scr;                          // SSIClk = BUS_CLOCK/(cpsr*(1+scr))
+  uint8_t mode;                         // SPI mode 0 to 3, bit 1 SPO, bit 0 SPH
+  uint8_t bits;                         // frame size, 4 to 16
+  uint8_t rx;                           // 1 to use the Rx pin
+  volatile unsigned long *cs;           // GPIO data address of the chip select,
+                                        //   active low, 0 to use the Fss pin
+  volatile unsigned long *dc;           // GPIO data address of the data/command pin, 0 if none
+  unsigned long dcData;                 // value written to *dc for data, 0 is written for commands
+  SSIStats stats;
+} SSIDevice;
+
+//********SSI_Register*****************
+// Prepare the module and pins used by a device.  The first device
+// on a module turns the module on; the device's GPIO chip select,
+// if any, must already be a digital output, and is set high.
+// inputs: dev  device, must stay valid, stats are cleared
+// outputs: none
+void SSI_Register(SSIDevice *dev);
+
+//********SSI_Select*****************
+// Make dev the device on its module, loading its clock, mode and
+// frame size and moving the chip select if another device was
+// selected.  Waits for the previous device's frames to finish.
+// inputs: dev  registered device
+// outputs: 1 if the module switched to dev, 0 if it already was
+int SSI_Select(SSIDevice *dev);
+
+//********SSI_Count*****************
+// Add to the number of bytes sent to a device.
+// inputs: dev  registered device
+//         n    bytes the driver wrote to the module
+// outputs: none
+void SSI_Count(SSIDevice *dev, uint32_t n);
+
+#endif // __SSI_H__
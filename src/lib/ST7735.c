@@ -17,7 +17,7 @@
  ****************************************************/
 
 // ST7735.c
-// Runs on LM4F120/TM4C123
+// Runs on LM4F120/TM4C123, or a PC with ST7735_SIMULATE defined
 // Low level drivers for the ST7735 160x128 LCD based off of
 // the file described above.
 //    16-bit color, 128 wide by 160 high LCD
@@ -49,7 +49,7 @@
 // MISO (pin 9) unconnected
 // SCK (pin 8) connected to PA2 (SSI0Clk)
 // MOSI (pin 7) connected to PA5 (SSI0Tx)
-// TFT_CS (pin 6) connected to PA3 (SSI0Fss)
+// TFT_CS (pin 6) connected to PA3 (GPIO)
 // CARD_CS (pin 5) unconnected
 // Data/Command (pin 4) connected to PA6 (GPIO), high for data, low for command
 // RESET (pin 3) connected to PA7 (GPIO)
@@ -92,6 +92,9 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include "ST7735.h"
+#include "SSI.h"
+#include "Timebase.h"
+#include "Timer.h"
 #include "tm4c123gh6pm.h"
 
 // 16 rows (0 to 15) and 21 characters (0 to 20)
@@ -147,13 +150,51 @@ uint16_t StTextColor = ST7735_YELLOW;
 #define ST7735_GMCTRP1 0xE0
 #define ST7735_GMCTRN1 0xE1
 
+#ifndef ST7735_SIMULATE
 #define TFT_CS                  (*((volatile uint32_t *)0x40004020))
-#define TFT_CS_LOW              0           // CS normally controlled by hardware
-#define TFT_CS_HIGH             0x08
 #define DC                      (*((volatile uint32_t *)0x40004100))
+#define RESET                   (*((volatile uint32_t *)0x40004200))
+#define SSI0_OUT(frame)         (SSI0_DR_R = (frame))
+#else
+// On a PC (src/tools/ST7735Sim.c) the pins and registers are
+// variables, the SSI is never busy, and each frame goes to
+// ST7735_SimFrame(), provided by the program, with its size and
+// the Data/Command pin.  SSI_Select(), SSI_Register(), SSI_Count(),
+// Delay_ms() and Timer2_OneShot() are provided by the program as well.
+void ST7735_SimFrame(uint16_t frame, uint8_t bits, uint8_t data);
+static volatile uint32_t SimPin[3];                     // TFT_CS, DC, RESET
+static volatile unsigned long SimReg[10] = {0x07};      // SSI0 starts with 8-bit frames
+#undef SSI0_SR_R
+#undef SSI0_CR0_R
+#undef SSI0_CR1_R
+#undef SYSCTL_RCGCSSI_R
+#undef SYSCTL_RCGCGPIO_R
+#undef SYSCTL_PRGPIO_R
+#undef GPIO_PORTA_DIR_R
+#undef GPIO_PORTA_AFSEL_R
+#undef GPIO_PORTA_DEN_R
+#undef GPIO_PORTA_PCTL_R
+#undef GPIO_PORTA_AMSEL_R
+#define SSI0_SR_R               SSI_SR_TNF  // never busy, never full
+#define SYSCTL_PRGPIO_R         0x01        // ports always ready
+#define SSI0_CR0_R              SimReg[0]
+#define SSI0_CR1_R              SimReg[1]
+#define SYSCTL_RCGCSSI_R        SimReg[2]
+#define SYSCTL_RCGCGPIO_R       SimReg[3]
+#define GPIO_PORTA_DIR_R        SimReg[4]
+#define GPIO_PORTA_AFSEL_R      SimReg[5]
+#define GPIO_PORTA_DEN_R        SimReg[6]
+#define GPIO_PORTA_PCTL_R       SimReg[7]
+#define GPIO_PORTA_AMSEL_R      SimReg[8]
+#define TFT_CS                  SimPin[0]
+#define DC                      SimPin[1]
+#define RESET                   SimPin[2]
+#define SSI0_OUT(frame)         ST7735_SimFrame(frame, (SSI0_CR0_R&SSI_CR0_DSS_M) + 1, DC == DC_DATA)
+#endif
+#define TFT_CS_LOW              0           // CS driven by the SSI bus manager
+#define TFT_CS_HIGH             0x08
 #define DC_COMMAND              0
 #define DC_DATA                 0x40
-#define RESET                   (*((volatile uint32_t *)0x40004200))
 #define RESET_LOW               0
 #define RESET_HIGH              0x80
 
@@ -164,6 +205,7 @@ uint16_t StTextColor = ST7735_YELLOW;
 #define SSI_CR0_FRF_MOTO        0x00000000  // Freescale SPI Frame Format
 #define SSI_CR0_DSS_M           0x0000000F  // SSI Data Size Select
 #define SSI_CR0_DSS_8           0x00000007  // 8-bit data
+#define SSI_CR0_DSS_16          0x0000000F  // 16-bit data
 #define SSI_CR1_MS              0x00000004  // SSI Master/Slave Select
 #define SSI_CR1_SSE             0x00000002  // SSI Synchronous Serial Port
                                             // Enable
@@ -199,8 +241,10 @@ uint16_t StTextColor = ST7735_YELLOW;
 #define ST7735_RAMRD   0x2E
 
 #define ST7735_PTLAR   0x30
+#define ST7735_VSCRDEF 0x33
 #define ST7735_COLMOD  0x3A
 #define ST7735_MADCTL  0x36
+#define ST7735_VSCRSADD 0x37
 
 #define ST7735_FRMCTR1 0xB1
 #define ST7735_FRMCTR2 0xB2
@@ -493,6 +537,14 @@ static int16_t _width = ST7735_TFTWIDTH;   // this could probably be a constant,
 static int16_t _height = ST7735_TFTHEIGHT;
 
 
+// SSI0 with PA3 as a GPIO TFT_CS, so other devices can share the
+// bus, 5 MHz SSIClk (50 MHz/10), SPI mode 0, 8-bit frames.  The
+// pixel stream functions change the frame size to 16 bits and
+// back without the bus manager.
+static SSIDevice TftDev = {0, 10, 0, 0, 8, 0, (volatile unsigned long *)&TFT_CS,
+                           (volatile unsigned long *)&DC, DC_DATA, {0, 0}};
+
+
 // The Data/Command pin must be valid when the eighth bit is
 // sent.  The SSI module has hardware input and output FIFOs
 // that are 8 locations deep.  Based on the observation that
@@ -511,34 +563,71 @@ static int16_t _height = ST7735_TFTHEIGHT;
 // NOTE: These functions will crash or stall indefinitely if
 // the SSI0 module is not initialized and enabled.
 void static writecommand(uint8_t c) {
+  SSI_Select(&TftDev);
                                         // wait until SSI0 not busy/transmit FIFO empty
   while((SSI0_SR_R&SSI_SR_BSY)==SSI_SR_BSY){};
   DC = DC_COMMAND;
-  SSI0_DR_R = c;                        // data out
+  SSI0_OUT(c);                          // data out
+  SSI_Count(&TftDev, 1);
                                         // wait until SSI0 not busy/transmit FIFO empty
   while((SSI0_SR_R&SSI_SR_BSY)==SSI_SR_BSY){};
 }
 
 
 void static writedata(uint8_t c) {
+  SSI_Select(&TftDev);
   while((SSI0_SR_R&SSI_SR_TNF)==0){};   // wait until transmit FIFO not full
   DC = DC_DATA;
-  SSI0_DR_R = c;                        // data out
+  SSI0_OUT(c);                          // data out
+  SSI_Count(&TftDev, 1);
+}
+
+// Pixel stream mode.  After setAddrWindow() every byte sent is
+// data, so the Data/Command pin does not need to be touched
+// again, and each RGB565 pixel can go out as one 16-bit SSI
+// frame (most significant byte first, same as pushColor()).
+// This halves the number of FIFO writes and TNF polls per
+// pixel.  pixelStreamEnd() must be called before the next
+// command so the following 8-bit writes are framed correctly.
+void static pixelStreamBegin(void){
+  SSI_Select(&TftDev);
+                                        // wait until SSI0 not busy/transmit FIFO empty
+  while((SSI0_SR_R&SSI_SR_BSY)==SSI_SR_BSY){};
+  DC = DC_DATA;
+  SSI0_CR1_R &= ~SSI_CR1_SSE;           // data size can only change while disabled
+  SSI0_CR0_R = (SSI0_CR0_R&~SSI_CR0_DSS_M)+SSI_CR0_DSS_16;
+  SSI0_CR1_R |= SSI_CR1_SSE;
 }
-// Subroutine to wait 1 msec
-// Inputs: None
-// Outputs: None
-// Notes: ...
-void Delay1ms(uint32_t n){uint32_t volatile time;
+
+
+void static pixelStreamEnd(void){
+                                        // wait until the last pixel has been shifted out
+  while((SSI0_SR_R&SSI_SR_BSY)==SSI_SR_BSY){};
+  SSI0_CR1_R &= ~SSI_CR1_SSE;
+  SSI0_CR0_R = (SSI0_CR0_R&~SSI_CR0_DSS_M)+SSI_CR0_DSS_8;
+  SSI0_CR1_R |= SSI_CR1_SSE;
+}
+
+
+// Send one pixel in pixel stream mode
+void static streamPixel(uint16_t color){
+  while((SSI0_SR_R&SSI_SR_TNF)==0){};   // wait until transmit FIFO not full
+  SSI0_OUT(color);
+  SSI_Count(&TftDev, 2);
+}
+
+
+// Send the same pixel n times in pixel stream mode
+void static streamFill(uint16_t color, uint32_t n){
+  SSI_Count(&TftDev, 2*n);
   while(n){
-    time = 72724*2/91;  // 1msec, tuned at 80 MHz
-    while(time){
-      time--;
-    }
+    while((SSI0_SR_R&SSI_SR_TNF)==0){}; // wait until transmit FIFO not full
+    SSI0_OUT(color);
     n--;
   }
 }
 
+
 // Rather than a bazillion writecommand() and writedata() calls, screen
 // initialization commands and arguments are organized in these tables
 // stored in ROM.  The table may look bulky, but that's mostly the
@@ -678,43 +767,121 @@ static const uint8_t
       100 };                  //     100 ms delay
 
 
-// Companion code to the above tables.  Reads and issues
-// a series of LCD commands stored in ROM byte array.
-void static commandList(const uint8_t *addr) {
-
-  uint8_t numCommands, numArgs;
+// Companion code to the above tables.  Initialization is a
+// sequence of steps: the reset pulse, then each command of up to
+// three lists stored in ROM.  initStep()
+// runs steps until one asks for a delay and returns that delay,
+// so the same sequence can either busy wait (ST7735_InitR()) or
+// be resumed by a one-shot timer (ST7735_StartInitR()).
+#define INIT_RESET      0            // reset pulse, three 500 ms steps
+#define INIT_LISTS      3            // walking the command lists
+#define INIT_FINISH     4            // color filter and text settings
+#define INIT_DONE       5
+static const uint8_t *InitLists[3];  // command lists to send
+static uint8_t InitNumLists;
+static uint8_t InitList;             // index of the next list
+static const uint8_t *InitAddr;      // next command in the current list
+static uint8_t InitCommands;         // commands left in the current list
+static volatile uint8_t InitStage = INIT_DONE;
+static enum initRFlags InitOption;
+static void (*InitDoneTask)(void);   // called when ST7735_StartInitR() finishes
+void static ssiInit(void);
+
+// Run initialization steps up to the next delay
+// Input: none
+// Output: delay in ms before the next call, 0 when finished
+uint16_t static initStep(void){
+  uint8_t numArgs;
   uint16_t ms;
 
-  numCommands = *(addr++);               // Number of commands to follow
-  while(numCommands--) {                 // For each command...
-    writecommand(*(addr++));             //   Read, issue command
-    numArgs  = *(addr++);                //   Number of args to follow
-    ms       = numArgs & DELAY;          //   If hibit set, delay follows args
-    numArgs &= ~DELAY;                   //   Mask out delay bit
-    while(numArgs--) {                   //   For each argument...
-      writedata(*(addr++));              //     Read, issue argument
-    }
+  switch(InitStage){
+    case INIT_RESET:                     // toggle RST low to reset
+      RESET = RESET_HIGH;
+      InitStage = INIT_RESET + 1;
+      return 500;
+    case INIT_RESET + 1:
+      RESET = RESET_LOW;
+      InitStage = INIT_RESET + 2;
+      return 500;
+    case INIT_RESET + 2:
+      RESET = RESET_HIGH;
+      InitStage = INIT_LISTS;
+      return 500;
+    case INIT_LISTS:
+      if((InitList == 0) && (InitCommands == 0)){
+        ssiInit();                       // first time here
+      }
+      for(;;){
+        if(InitCommands == 0){           // start the next list
+          if(InitList == InitNumLists){
+            break;
+          }
+          InitAddr = InitLists[InitList++];
+          InitCommands = *(InitAddr++);  // Number of commands to follow
+          continue;
+        }
+        InitCommands--;
+        writecommand(*(InitAddr++));     //   Read, issue command
+        numArgs  = *(InitAddr++);        //   Number of args to follow
+        ms       = numArgs & DELAY;      //   If hibit set, delay follows args
+        numArgs &= ~DELAY;               //   Mask out delay bit
+        while(numArgs--) {               //   For each argument...
+          writedata(*(InitAddr++));      //     Read, issue argument
+        }
+        if(ms) {
+          ms = *(InitAddr++);            // Read post-command delay time (ms)
+          if(ms == 255) ms = 500;        // If 255, delay for 500 ms
+          if(ms) return ms;
+        }
+      }
+      InitStage = INIT_FINISH;
+      // fall through
+    case INIT_FINISH:
+      // if black, change MADCTL color filter
+      if (InitOption == INITR_BLACKTAB) {
+        writecommand(ST7735_MADCTL);
+        writedata(0xC0);
+      }
+      TabColor = InitOption;
+      ST7735_SetCursor(0,0);
+      StTextColor = ST7735_YELLOW;
+      InitStage = INIT_DONE;
+      break;
+  }
+  return 0;
+}
 
-    if(ms) {
-      ms = *(addr++);             // Read post-command delay time (ms)
-      if(ms == 255) ms = 500;     // If 255, delay for 500 ms
-      Delay1ms(ms);
-    }
+
+// Run the next initialization steps from the TIMER2A one-shot
+// and schedule the call after the next delay
+void static initTimerTask(void){
+  uint16_t ms = initStep();
+  if(ms){
+    Timer2_OneShot(&initTimerTask, ms*(BUS_CLOCK/1000));
+  } else if(InitDoneTask){
+    (*InitDoneTask)();
   }
 }
 
 
 // Initialization code common to both 'B' and 'R' type displays
-void static commonInit(const uint8_t *cmdList) {
-  volatile uint32_t delay;
+// Sets up the pins and the step sequence for up to three lists
+void static commonInit(const uint8_t *list1, const uint8_t *list2, const uint8_t *list3) {
   ColStart  = RowStart = 0; // May be overridden in init func
+  InitLists[0] = list1;
+  InitLists[1] = list2;
+  InitLists[2] = list3;
+  InitNumLists = list3 ? 3 : (list2 ? 2 : 1);
+  InitList = 0;
+  InitCommands = 0;
+  InitOption = none;
 
   SYSCTL_RCGCSSI_R |= 0x01;  // activate SSI0
   SYSCTL_RCGCGPIO_R |= 0x01; // activate port A
   while((SYSCTL_PRGPIO_R&0x01)==0){}; // allow time for clock to start
 
   // toggle RST low to reset; CS low so it'll listen to us
-  // SSI0Fss is temporarily used as GPIO
+  // PA3 stays a GPIO, the chip select of the SSI bus manager
   GPIO_PORTA_DIR_R |= 0xC8;             // make PA3,6,7 out
   GPIO_PORTA_AFSEL_R &= ~0xC8;          // disable alt funct on PA3,6,7
   GPIO_PORTA_DEN_R |= 0xC8;             // enable digital I/O on PA3,6,7
@@ -722,82 +889,106 @@ void static commonInit(const uint8_t *cmdList) {
   GPIO_PORTA_PCTL_R = (GPIO_PORTA_PCTL_R&0x00FF0FFF)+0x00000000;
   GPIO_PORTA_AMSEL_R &= ~0xC8;          // disable analog functionality on PA3,6,7
   TFT_CS = TFT_CS_LOW;
-  RESET = RESET_HIGH;
-  Delay1ms(500);
-  RESET = RESET_LOW;
-  Delay1ms(500);
-  RESET = RESET_HIGH;
-  Delay1ms(500);
-
-  // initialize SSI0
-  GPIO_PORTA_AFSEL_R |= 0x2C;           // enable alt funct on PA2,3,5
-  GPIO_PORTA_DEN_R |= 0x2C;             // enable digital I/O on PA2,3,5
-                                        // configure PA2,3,5 as SSI
-  GPIO_PORTA_PCTL_R = (GPIO_PORTA_PCTL_R&0xFF0F00FF)+0x00202200;
-  GPIO_PORTA_AMSEL_R &= ~0x2C;          // disable analog functionality on PA2,3,5
-  SSI0_CR1_R &= ~SSI_CR1_SSE;           // disable SSI
-  SSI0_CR1_R &= ~SSI_CR1_MS;            // master mode
-                                        // configure for system clock/PLL baud clock source
-  SSI0_CC_R = (SSI0_CC_R&~SSI_CC_CS_M)+SSI_CC_CS_SYSPLL;
-//                                        // clock divider for 3.125 MHz SSIClk (50 MHz PIOSC/16)
-//  SSI0_CPSR_R = (SSI0_CPSR_R&~SSI_CPSR_CPSDVSR_M)+16;
-                                        // clock divider for 8 MHz SSIClk (80 MHz PLL/24)
-                                        // SysClk/(CPSDVSR*(1+SCR))
-                                        // 80/(10*(1+0)) = 8 MHz (slower than 4 MHz)
-  SSI0_CPSR_R = (SSI0_CPSR_R&~SSI_CPSR_CPSDVSR_M)+10; // must be even number
-  SSI0_CR0_R &= ~(SSI_CR0_SCR_M |       // SCR = 0 (8 Mbps data rate)
-                  SSI_CR0_SPH |         // SPH = 0
-                  SSI_CR0_SPO);         // SPO = 0
-                                        // FRF = Freescale format
-  SSI0_CR0_R = (SSI0_CR0_R&~SSI_CR0_FRF_M)+SSI_CR0_FRF_MOTO;
-                                        // DSS = 8-bit data
-  SSI0_CR0_R = (SSI0_CR0_R&~SSI_CR0_DSS_M)+SSI_CR0_DSS_8;
-  SSI0_CR1_R |= SSI_CR1_SSE;            // enable SSI
+  InitStage = INIT_RESET;               // reset pulse is the first step
+}
+
 
-  if(cmdList) commandList(cmdList);
+// Initialize SSI0, after the reset pulse
+void static ssiInit(void) {
+  SSI_Register(&TftDev);                // SSI0 on PA2,5, PA3 chip select
+  SSI_Select(&TftDev);
 }
 
 
 //------------ST7735_InitB------------
 // Initialization for ST7735B screens.
+// Busy waits for the delays in the initialization sequence.
 // Input: none
 // Output: none
 void ST7735_InitB(void) {
-  commonInit(Bcmd);
-  ST7735_SetCursor(0,0);
-  StTextColor = ST7735_YELLOW;
+  uint16_t ms;
+  commonInit(Bcmd, 0, 0);
+  while((ms = initStep()) != 0){
+    Delay_ms(ms);
+  }
   ST7735_FillScreen(0);                 // set screen to black
 }
 
 
-//------------ST7735_InitR------------
-// Initialization for ST7735R screens (green or red tabs).
-// Input: option one of the enumerated options depending on tabs
-// Output: none
-void ST7735_InitR(enum initRFlags option) {
-  commonInit(Rcmd1);
+// Set up the lists for an ST7735R screen
+void static initR(enum initRFlags option) {
   if(option == INITR_GREENTAB) {
-    commandList(Rcmd2green);
+    commonInit(Rcmd1, Rcmd2green, Rcmd3);
     ColStart = 2;
     RowStart = 1;
   } else {
     // colstart, rowstart left at default '0' values
-    commandList(Rcmd2red);
+    commonInit(Rcmd1, Rcmd2red, Rcmd3);
   }
-  commandList(Rcmd3);
+  InitOption = option;
+}
 
-  // if black, change MADCTL color filter
-  if (option == INITR_BLACKTAB) {
-    writecommand(ST7735_MADCTL);
-    writedata(0xC0);
+
+//------------ST7735_InitR------------
+// Initialization for ST7735R screens (green or red tabs).
+// Busy waits for the delays in the initialization sequence.
+// Input: option one of the enumerated options depending on tabs
+// Output: none
+void ST7735_InitR(enum initRFlags option) {
+  uint16_t ms;
+  initR(option);
+  while((ms = initStep()) != 0){
+    Delay_ms(ms);
   }
-  TabColor = option;
-  ST7735_SetCursor(0,0);
-  StTextColor = ST7735_YELLOW;
   ST7735_FillScreen(0);                 // set screen to black
 }
 
 
+//------------ST7735_StartInitB------------
+// Start initialization of an ST7735B screen in the background.
+// Returns right away; the sequence continues from TIMER2A
+// interrupts during its delays (about 2 seconds in all).  No
+// other ST7735 function may be called until done is called, from
+// the TIMER2A interrupt.  The screen is not cleared, so the first
+// thing drawn, from the main program, should cover all of it.
+// Input: done function to call when finished, 0 for none
+// Output: none
+// Assumes: interrupts are enabled or will be soon
+void ST7735_StartInitB(void(*done)(void)) {
+  commonInit(Bcmd, 0, 0);
+  InitDoneTask = done;
+  initTimerTask();
+}
+
+
+//------------ST7735_StartInitR------------
+// Start initialization of an ST7735R screen in the background.
+// Returns right away; the sequence continues from TIMER2A
+// interrupts during its delays (about 2 seconds in all).  No
+// other ST7735 function may be called until done is called, from
+// the TIMER2A interrupt.  The screen is not cleared, so the first
+// thing drawn, from the main program, should cover all of it.
+// Input: option one of the enumerated options depending on tabs
+//        done   function to call when finished, 0 for none
+// Output: none
+// Assumes: interrupts are enabled or will be soon
+void ST7735_StartInitR(enum initRFlags option, void(*done)(void)) {
+  initR(option);
+  InitDoneTask = done;
+  initTimerTask();
+}
+
+
+//------------ST7735_InitDone------------
+// Check whether initialization has finished.  Nothing else may
+// be drawn until it has.
+// Input: none
+// Output: 1 if the screen is ready, 0 if still initializing
+int ST7735_InitDone(void) {
+  return InitStage == INIT_DONE;
+}
+
+
 // Set the region of the screen RAM to be modified
 // Pixel colors are sent left to right, top to bottom
 // (same as Font table is encoded; different from regular bitmap)
@@ -849,67 +1040,72 @@ void ST7735_DrawPixel(int16_t x, int16_t y, uint16_t color) {
   pushColor(color);
 }
 
-//------------ST7735_DrawCircle------------
-// Draw a circle with the given radius and color.
-// Input: x     horizontal position of the start of the line, columns from the left edge
-//        y     vertical position of the start of the line, rows from the top edge
-//        r     radius of the circle
-//        color 16-bit color, which can be produced by ST7735_Color565()
-// Output: none
-void ST7735_DrawCircle(uint8_t x0, uint8_t y0, uint8_t r, uint16_t color)
-{
+// Draw the points of one or more quarters of a circle outline
+// as spans.  The midpoint circle algorithm gives the points of
+// one octant, (x, y) with x going from 0 up to about y.  Points
+// with the same y are collected into one run, which is one
+// horizontal span in the octants next to the top and bottom of
+// the circle and one vertical span in the octants next to the
+// left and right.
+// corners 0x01 top left, 0x02 top right, 0x04 bottom right, 0x08 bottom left
+void static circleArcs(int16_t x0, int16_t y0, int16_t r, uint8_t corners, uint16_t color){
   int16_t f = 1 - r;
   int16_t ddF_x = 1;
   int16_t ddF_y = -2 * r;
   int16_t x = 0;
   int16_t y = r;
-
-  ST7735_DrawPixel(x0, y0+r, color);
-  ST7735_DrawPixel(x0, y0-r, color);
-  ST7735_DrawPixel(x0+r, y0, color);
-  ST7735_DrawPixel(x0-r, y0, color);
-
-  while (x<y) {
-    if (f >= 0) {
+  int16_t xs = 0;                       // first x of the run at this y
+  int16_t n;
+
+  for(;;){
+    if((x >= y) || (f >= 0)){           // the run at this y is complete
+      n = x - xs + 1;
+      if(corners&0x01){
+        ST7735_DrawFastHLine(x0-x, y0-y, n, color);
+        ST7735_DrawFastVLine(x0-y, y0-x, n, color);
+      }
+      if(corners&0x02){
+        ST7735_DrawFastHLine(x0+xs, y0-y, n, color);
+        ST7735_DrawFastVLine(x0+y, y0-x, n, color);
+      }
+      if(corners&0x04){
+        ST7735_DrawFastHLine(x0+xs, y0+y, n, color);
+        ST7735_DrawFastVLine(x0+y, y0+xs, n, color);
+      }
+      if(corners&0x08){
+        ST7735_DrawFastHLine(x0-x, y0+y, n, color);
+        ST7735_DrawFastVLine(x0-y, y0+xs, n, color);
+      }
+      if(x >= y) return;
       y--;
       ddF_y += 2;
       f += ddF_y;
+      xs = x + 1;
     }
     x++;
     ddF_x += 2;
     f += ddF_x;
-  
-    ST7735_DrawPixel(x0 + x, y0 + y, color);
-    ST7735_DrawPixel(x0 - x, y0 + y, color);
-    ST7735_DrawPixel(x0 + x, y0 - y, color);
-    ST7735_DrawPixel(x0 - x, y0 - y, color);
-    
-    ST7735_DrawPixel(x0 + y, y0 + x, color);
-    ST7735_DrawPixel(x0 - y, y0 + x, color);
-    ST7735_DrawPixel(x0 + y, y0 - x, color);
-    ST7735_DrawPixel(x0 - y, y0 - x, color);
-    
   }
 }
- 
-//------------ST7735_FillCircle------------
-// Fill a circle with the given radius and color.
-// Input: x     horizontal position of the start of the line, columns from the left edge
-//        y     vertical position of the start of the line, rows from the top edge
-//        r     radius of the circle
-//        color 16-bit color, which can be produced by ST7735_Color565()
-// Output: none
- void ST7735_FillCircle(uint8_t x0, uint8_t y0, uint8_t r, uint16_t color) {
-	int16_t f = 1 - r;
+
+// Fill the left and/or right half of a circle with vertical
+// spans, each stretched down by delta rows.  Each column is
+// drawn once, with its final height.
+// sides 0x01 right, 0x02 left; the center column is not drawn
+void static circleFill(int16_t x0, int16_t y0, int16_t r, uint8_t sides, int16_t delta, uint16_t color){
+  int16_t f = 1 - r;
   int16_t ddF_x = 1;
   int16_t ddF_y = -2 * r;
   int16_t x = 0;
   int16_t y = r;
 
-  ST7735_DrawFastVLine(x0, y0-r, 2*r+1, color);
-
   while (x<y) {
     if (f >= 0) {
+      // column y is done growing before y moves in
+      if(x){
+        if(sides&0x01) ST7735_DrawFastVLine(x0+y, y0-x, 2*x+1+delta, color);
+        if(sides&0x02) ST7735_DrawFastVLine(x0-y, y0-x, 2*x+1+delta, color);
+      }
       y--;
       ddF_y += 2;
       f += ddF_y;
@@ -917,64 +1113,209 @@ void ST7735_DrawCircle(uint8_t x0, uint8_t y0, uint8_t r, uint16_t color)
     x++;
     ddF_x += 2;
     f += ddF_x;
-  
-    ST7735_DrawFastVLine(x0+x, y0-y, 2*y+1, color);
-    ST7735_DrawFastVLine(x0-x, y0-y, 2*y+1, color);
-    ST7735_DrawFastVLine(x0+y, y0-x, 2*x+1, color);
-    ST7735_DrawFastVLine(x0-y, y0-x, 2*x+1, color);
+    if(sides&0x01) ST7735_DrawFastVLine(x0+x, y0-y, 2*y+1+delta, color);
+    if(sides&0x02) ST7735_DrawFastVLine(x0-x, y0-y, 2*y+1+delta, color);
   }
- }
- 
+  if(x > 0){                            // last outer column
+    if(sides&0x01) ST7735_DrawFastVLine(x0+y, y0-x, 2*x+1+delta, color);
+    if(sides&0x02) ST7735_DrawFastVLine(x0-y, y0-x, 2*x+1+delta, color);
+  }
+}
+
+
+//------------ST7735_DrawCircle------------
+// Draw a circle with the given radius and color.  The outline is
+// drawn as horizontal and vertical spans, one address window
+// each, rather than one window per pixel.
+// Input: x0    horizontal position of the center, columns from the left edge
+//        y0    vertical position of the center, rows from the top edge
+//        r     radius of the circle
+//        color 16-bit color, which can be produced by ST7735_Color565()
+// Output: none
+void ST7735_DrawCircle(uint8_t x0, uint8_t y0, uint8_t r, uint16_t color)
+{
+  circleArcs(x0, y0, r, 0x0F, color);
+}
+
+//------------ST7735_FillCircle------------
+// Fill a circle with the given radius and color.
+// Input: x0    horizontal position of the center, columns from the left edge
+//        y0    vertical position of the center, rows from the top edge
+//        r     radius of the circle
+//        color 16-bit color, which can be produced by ST7735_Color565()
+// Output: none
+void ST7735_FillCircle(uint8_t x0, uint8_t y0, uint8_t r, uint16_t color) {
+  ST7735_DrawFastVLine(x0, y0-r, 2*r+1, color);
+  circleFill(x0, y0, r, 0x03, 0, color);
+}
+
 //------------ST7735_DrawLine------------
-// Draw a  line at the given coordinates with the given height and color.
-// Requires (11 + 2*h) bytes of transmission (assuming image fully on screen)
-// Input: x     horizontal position of the start of the line, columns from the left edge
-//        y     vertical position of the start of the line, rows from the top edge
-//        h     height of the line
+// Draw a line between two points with the given color.  Pixels
+// of the Bresenham line that share a row (or a column, for steep
+// lines) are drawn as one span with one address window.
+// Requires about (11 + 2*n) bytes of transmission per span
+// Input: x0    horizontal position of the start of the line, columns from the left edge
+//        y0    vertical position of the start of the line, rows from the top edge
+//        x1    horizontal position of the end of the line, columns from the left edge
+//        y1    vertical position of the end of the line, rows from the top edge
 //        color 16-bit color, which can be produced by ST7735_Color565()
 // Output: none
- 
- void ST7735_DrawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
- 
-	 int16_t steep = abs(y1 - y0) > abs(x1 - x0);
-	 int16_t dx, dy;
-	 int16_t err, ystep;
-		if (steep) {
-			swap(x0, y0);
-			swap(x1, y1);
-		}
-
-		if (x0 > x1) {
-			swap(x0, x1);
-			swap(y0, y1);
-		}
-
-		
-		dx = x1 - x0;
-		dy = abs(y1 - y0);
-
-		err = dx / 2;
-		
-
-		if (y0 < y1) {
-			ystep = 1;
-			} else {
-			ystep = -1;
-		}
-
-		for (; x0<=x1; x0++) {
-			if (steep) {
-				ST7735_DrawPixel(y0, x0, color);
-				} else {
-				ST7735_DrawPixel(x0, y0, color);
-			}
-			err -= dy;
-			if (err < 0) {
-				y0 += ystep;
-				err += dx;
-			}
-		}
+void ST7735_DrawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+  int16_t steep = abs(y1 - y0) > abs(x1 - x0);
+  int16_t dx, dy;
+  int16_t err, ystep;
+  int16_t start;                        // first x of the current span
+
+  if (steep) {
+    swap(x0, y0);
+    swap(x1, y1);
+  }
+  if (x0 > x1) {
+    swap(x0, x1);
+    swap(y0, y1);
+  }
+  dx = x1 - x0;
+  dy = abs(y1 - y0);
+  err = dx / 2;
+  if (y0 < y1) {
+    ystep = 1;
+  } else {
+    ystep = -1;
+  }
+
+  for (start = x0; x0<=x1; x0++) {
+    err -= dy;
+    if ((err < 0) || (x0 == x1)) {      // last pixel of this span
+      if (steep) {
+        ST7735_DrawFastVLine(y0, start, x0-start+1, color);
+      } else {
+        ST7735_DrawFastHLine(start, y0, x0-start+1, color);
+      }
+      start = x0 + 1;
     }
+    if (err < 0) {
+      y0 += ystep;
+      err += dx;
+    }
+  }
+}
+
+//------------ST7735_DrawRoundRect------------
+// Draw the outline of a rectangle with rounded corners.
+// Input: x     horizontal position of the top left corner of the rectangle, columns from the left edge
+//        y     vertical position of the top left corner of the rectangle, rows from the top edge
+//        w     horizontal width of the rectangle
+//        h     vertical height of the rectangle
+//        r     radius of the corners, at most half of w and h
+//        color 16-bit color, which can be produced by ST7735_Color565()
+// Output: none
+void ST7735_DrawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color) {
+  if((w <= 0) || (h <= 0)) return;
+  if(r > w/2) r = w/2;
+  if(r > h/2) r = h/2;
+  if(r < 0) r = 0;
+  ST7735_DrawFastHLine(x+r, y, w-2*r, color);       // top
+  ST7735_DrawFastHLine(x+r, y+h-1, w-2*r, color);   // bottom
+  ST7735_DrawFastVLine(x, y+r, h-2*r, color);       // left
+  ST7735_DrawFastVLine(x+w-1, y+r, h-2*r, color);   // right
+  if(r > 0){
+    circleArcs(x+r, y+r, r, 0x01, color);
+    circleArcs(x+w-r-1, y+r, r, 0x02, color);
+    circleArcs(x+w-r-1, y+h-r-1, r, 0x04, color);
+    circleArcs(x+r, y+h-r-1, r, 0x08, color);
+  }
+}
+
+//------------ST7735_FillRoundRect------------
+// Fill a rectangle with rounded corners.  The middle is one
+// address window and each column of the rounded ends is one more.
+// Input: x     horizontal position of the top left corner of the rectangle, columns from the left edge
+//        y     vertical position of the top left corner of the rectangle, rows from the top edge
+//        w     horizontal width of the rectangle
+//        h     vertical height of the rectangle
+//        r     radius of the corners, at most half of w and h
+//        color 16-bit color, which can be produced by ST7735_Color565()
+// Output: none
+void ST7735_FillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color) {
+  if((w <= 0) || (h <= 0)) return;
+  if(r > w/2) r = w/2;
+  if(r > h/2) r = h/2;
+  if(r < 0) r = 0;
+  ST7735_FillRect(x+r, y, w-2*r, h, color);
+  if(r > 0){
+    circleFill(x+w-r-1, y+r, r, 0x01, h-2*r-1, color);
+    circleFill(x+r, y+r, r, 0x02, h-2*r-1, color);
+  }
+}
+
+//------------ST7735_DrawTriangle------------
+// Draw the outline of a triangle.
+// Input: x0, y0 first corner, columns from the left edge and rows from the top edge
+//        x1, y1 second corner
+//        x2, y2 third corner
+//        color  16-bit color, which can be produced by ST7735_Color565()
+// Output: none
+void ST7735_DrawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                         int16_t x2, int16_t y2, uint16_t color) {
+  ST7735_DrawLine(x0, y0, x1, y1, color);
+  ST7735_DrawLine(x1, y1, x2, y2, color);
+  ST7735_DrawLine(x2, y2, x0, y0, color);
+}
+
+//------------ST7735_FillTriangle------------
+// Fill a triangle, one horizontal span per row.
+// Input: x0, y0 first corner, columns from the left edge and rows from the top edge
+//        x1, y1 second corner
+//        x2, y2 third corner
+//        color  16-bit color, which can be produced by ST7735_Color565()
+// Output: none
+void ST7735_FillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                         int16_t x2, int16_t y2, uint16_t color) {
+  int16_t a, b, y, last;
+  int32_t dx01, dy01, dx02, dy02, dx12, dy12, sa, sb;
+
+  // sort the corners by row, y0 <= y1 <= y2
+  if (y0 > y1) { swap(y0, y1); swap(x0, x1); }
+  if (y1 > y2) { swap(y2, y1); swap(x2, x1); }
+  if (y0 > y1) { swap(y0, y1); swap(x0, x1); }
+
+  if (y0 == y2) {                       // all on one row
+    a = b = x0;
+    if (x1 < a) a = x1; else if (x1 > b) b = x1;
+    if (x2 < a) a = x2; else if (x2 > b) b = x2;
+    ST7735_DrawFastHLine(a, y0, b-a+1, color);
+    return;
+  }
+  dx01 = x1 - x0; dy01 = y1 - y0;
+  dx02 = x2 - x0; dy02 = y2 - y0;
+  dx12 = x2 - x1; dy12 = y2 - y1;
+  sa = 0; sb = 0;
+
+  // upper part, edges 0-1 and 0-2; includes row y1 only if
+  // the lower part is flat (y1 == y2)
+  if (y1 == y2) last = y1;
+  else          last = y1 - 1;
+  for (y=y0; y<=last; y++) {
+    a = x0 + sa / dy01;
+    b = x0 + sb / dy02;
+    sa += dx01;
+    sb += dx02;
+    if (a > b) swap(a, b);
+    ST7735_DrawFastHLine(a, y, b-a+1, color);
+  }
+  // lower part, edges 1-2 and 0-2
+  sa = dx12 * (y - y1);
+  sb = dx02 * (y - y0);
+  for (; y<=y2; y++) {
+    a = x1 + sa / dy12;
+    b = x0 + sb / dy02;
+    sa += dx12;
+    sb += dx02;
+    if (a > b) swap(a, b);
+    ST7735_DrawFastHLine(a, y, b-a+1, color);
+  }
+}
+
 //------------ST7735_DrawFastVLine------------
 // Draw a vertical line at the given coordinates with the given height and color.
 // A vertical line is parallel to the longer side of the rectangular display
@@ -985,17 +1326,17 @@ void ST7735_DrawCircle(uint8_t x0, uint8_t y0, uint8_t r, uint16_t color)
 //        color 16-bit color, which can be produced by ST7735_Color565()
 // Output: none
 void ST7735_DrawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
-  uint8_t hi = color >> 8, lo = color;
 
-  // Rudimentary clipping
-  if((x >= _width) || (y >= _height)) return;
+  // clip on all sides, lines and circles may run off the screen
+  if((x < 0) || (x >= _width) || (y >= _height)) return;
+  if(y < 0){ h = h + y; y = 0; }
   if((y+h-1) >= _height) h = _height-y;
+  if(h <= 0) return;
   setAddrWindow(x, y, x, y+h-1);
 
-  while (h--) {
-    writedata(hi);
-    writedata(lo);
-  }
+  pixelStreamBegin();
+  streamFill(color, h);
+  pixelStreamEnd();
 }
 
 
@@ -1009,17 +1350,17 @@ void ST7735_DrawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
 //        color 16-bit color, which can be produced by ST7735_Color565()
 // Output: none
 void ST7735_DrawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
-  uint8_t hi = color >> 8, lo = color;
 
-  // Rudimentary clipping
-  if((x >= _width) || (y >= _height)) return;
+  // clip on all sides, lines and circles may run off the screen
+  if((y < 0) || (x >= _width) || (y >= _height)) return;
+  if(x < 0){ w = w + x; x = 0; }
   if((x+w-1) >= _width)  w = _width-x;
+  if(w <= 0) return;
   setAddrWindow(x, y, x+w-1, y);
 
-  while (w--) {
-    writedata(hi);
-    writedata(lo);
-  }
+  pixelStreamBegin();
+  streamFill(color, w);
+  pixelStreamEnd();
 }
 
 
@@ -1044,21 +1385,20 @@ void ST7735_FillScreen(uint16_t color) {
 //        color 16-bit color, which can be produced by ST7735_Color565()
 // Output: none
 void ST7735_FillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
-  uint8_t hi = color >> 8, lo = color;
 
-  // rudimentary clipping (drawChar w/big text requires this)
+  // clip on all sides (drawChar w/big text requires this)
   if((x >= _width) || (y >= _height)) return;
+  if(x < 0){ w = w + x; x = 0; }
+  if(y < 0){ h = h + y; y = 0; }
   if((x + w - 1) >= _width)  w = _width  - x;
   if((y + h - 1) >= _height) h = _height - y;
+  if((w <= 0) || (h <= 0)) return;
 
   setAddrWindow(x, y, x+w-1, y+h-1);
 
-  for(y=h; y>0; y--) {
-    for(x=w; x>0; x--) {
-      writedata(hi);
-      writedata(lo);
-    }
-  }
+  pixelStreamBegin();
+  streamFill(color, (uint32_t)w*h);
+  pixelStreamEnd();
 }
 
 
@@ -1138,28 +1478,211 @@ void ST7735_DrawBitmap(int16_t x, int16_t y, const uint16_t *image, int16_t w, i
 
   setAddrWindow(x, y-h+1, x+w-1, y);
 
+  pixelStreamBegin();
   for(y=0; y<h; y=y+1){
     for(x=0; x<w; x=x+1){
-                                        // send the top 8 bits
-      writedata((uint8_t)(image[i] >> 8));
-                                        // send the bottom 8 bits
-      writedata((uint8_t)image[i]);
+      streamPixel(image[i]);            // one 16-bit frame per pixel
       i = i + 1;                        // go to the next pixel
     }
     i = i + skipC;
     i = i - 2*originalWidth;
   }
+  pixelStreamEnd();
+}
+
+
+//------------ST7735_DrawBuffer------------
+// Displays a 16-bit color image stored top row first, left to
+// right, such as a strip rendered in RAM.  Unlike
+// ST7735_DrawBitmap() the image may be any size and is clipped
+// on all sides.
+// Requires (11 + 2*w*h) bytes of transmission (assuming image fully on screen)
+// Input: x      horizontal position of the top left corner of the image, columns from the left edge
+//        y      vertical position of the top left corner of the image, rows from the top edge
+//        buf    pointer to w*h 16-bit colors
+//        w      number of pixels wide
+//        h      number of pixels tall
+//        stride number of pixels from the start of one row of buf to the next (w or more)
+// Output: none
+void ST7735_DrawBuffer(int16_t x, int16_t y, const uint16_t *buf, int16_t w, int16_t h, int16_t stride){
+  int32_t i, j;
+  if(x < 0){                            // clip left
+    buf = buf - x;
+    w = w + x;
+    x = 0;
+  }
+  if(y < 0){                            // clip top
+    buf = buf - y*stride;
+    h = h + y;
+    y = 0;
+  }
+  if((x + w) > _width)  w = _width - x; // clip right
+  if((y + h) > _height) h = _height - y;// clip bottom
+  if((w <= 0) || (h <= 0)) return;
+
+  setAddrWindow(x, y, x+w-1, y+h-1);
+
+  pixelStreamBegin();
+  for(j=0; j<h; j=j+1){
+    for(i=0; i<w; i=i+1){
+      streamPixel(buf[i]);
+    }
+    buf = buf + stride;
+  }
+  pixelStreamEnd();
+}
+
+
+//------------ST7735_DrawImage------------
+// Displays an image stored in the compressed format made by the
+// ImageConv host program (src/tools/ImageConv.c).  See ST7735.h
+// for the format.  Rows above or below the screen still have to
+// be decoded, since the packets do not line up with rows, but
+// only visible pixels are sent.
+// (x,y) is the screen location of the lower left corner of the image
+// Requires (11 + 2*w*h) bytes of transmission (assuming image fully on screen)
+// Input: x     horizontal position of the bottom left corner of the image, columns from the left edge
+//        y     vertical position of the bottom left corner of the image, rows from the top edge
+//        image pointer to a compressed image
+// Output: none
+void ST7735_DrawImage(int16_t x, int16_t y, const uint8_t *image){
+  const uint8_t *palette;
+  int32_t w, h, left, right, top, bottom;
+  int32_t col, row, n, span, a, b;
+  uint8_t code, bits, mask, shift;
+  uint16_t color;
+
+  w = image[0] + (image[1]<<8);
+  h = image[2] + (image[3]<<8);
+  bits = image[5];
+  mask = (1<<bits) - 1;
+  palette = &image[6];
+  image = palette + 2*(image[4] + 1);   // first packet
+  y = y - h + 1;                        // top edge of the image
+
+  left = 0; right = w;                  // visible part, in image coordinates
+  top = 0; bottom = h;
+  if(x < 0) left = -x;
+  if(y < 0) top = -y;
+  if((x + w) > _width)  right = _width - x;
+  if((y + h) > _height) bottom = _height - y;
+  if((left >= right) || (top >= bottom)) return;
+
+  setAddrWindow(x+left, y+top, x+right-1, y+bottom-1);
+
+  pixelStreamBegin();
+  col = row = 0;
+  while(row < bottom){
+    code = *image++;
+    n = (code&0x7F) + 1;
+    if(code&0x80){                      // repeat packet
+      a = *image++;
+      color = palette[2*a] + (palette[2*a+1]<<8);
+      while((n > 0) && (row < bottom)){
+        span = w - col;                 // pixels left on this row
+        if(span > n) span = n;
+        if(row >= top){
+          a = (col > left) ? col : left;
+          b = (col + span < right) ? (col + span) : right;
+          if(b > a) streamFill(color, b - a);
+        }
+        col = col + span;
+        n = n - span;
+        if(col == w){ col = 0; row = row + 1; }
+      }
+    } else{                             // literal packet
+      shift = 8;
+      while(n > 0){
+        if(shift == 0){ image++; shift = 8; }
+        shift = shift - bits;
+        if((row >= top) && (row < bottom) && (col >= left) && (col < right)){
+          a = (*image>>shift)&mask;
+          streamPixel(palette[2*a] + (palette[2*a+1]<<8));
+        }
+        n = n - 1;
+        col = col + 1;
+        if(col == w){ col = 0; row = row + 1; }
+      }
+      image++;                          // skip the padding bits
+    }
+  }
+  pixelStreamEnd();
+}
+
+// Span based text renderer used by ST7735_DrawCharS(),
+// ST7735_DrawString() and ST7735_DrawText().  Draws n characters
+// of pt as one line of text with its top left corner at (x, y),
+// each character 6*size pixels wide (5 font columns and a blank
+// column) and 8*size pixels tall, clipped to the screen.
+// Opaque text (bgColor != textColor) uses one address window for
+// the whole visible line and expands the font bits straight into
+// the pixel stream, one run per font column on each pixel row.
+// Transparent text (bgColor == textColor) leaves the background
+// alone, so each horizontal run of set pixels on a pixel row is
+// sent as its own one row window.
+// Requires 11 + 2*(6*size*n)*(8*size) bytes for opaque text
+// fully on the screen, versus (11 + 2)*6*8*n one pixel at a time.
+void static drawText(int16_t x, int16_t y, const char *pt, uint32_t n,
+                     int16_t textColor, int16_t bgColor, uint8_t size){
+  int32_t x0, y0, x1, y1;               // visible part of the line
+  int32_t px, py, gx, run, rem, start;
+  uint8_t c, bit, on;
+  uint16_t color;
+
+  if((n == 0) || (size == 0)) return;
+  x0 = x;  x1 = x + 6*size*(int32_t)n - 1;
+  y0 = y;  y1 = y + 8*size - 1;
+  if(x0 < 0) x0 = 0;
+  if(y0 < 0) y0 = 0;
+  if(x1 >= _width)  x1 = _width - 1;
+  if(y1 >= _height) y1 = _height - 1;
+  if((x0 > x1) || (y0 > y1)) return;    // entirely off the screen
+
+  if(bgColor != textColor){
+    setAddrWindow(x0, y0, x1, y1);
+    pixelStreamBegin();
+  }
+  for(py=y0; py<=y1; py=py+1){
+    bit = 1<<((py - y)/size);           // font row of this pixel row
+    gx = (x0 - x)/size;                 // glyph column, 6 per character
+    rem = size - (x0 - x)%size;         // pixels left in the first glyph column
+    start = -1;                         // start of a transparent run
+    for(px=x0; px<=x1; px=px+run){
+      run = rem;
+      if(px + run - 1 > x1) run = x1 - px + 1;
+      c = gx%6;
+      on = (c < 5) && (Font[((uint8_t)pt[gx/6])*5 + c]&bit);
+      if(bgColor != textColor){
+        color = on ? textColor : bgColor;
+        streamFill(color, run);
+      } else if(on){
+        if(start < 0) start = px;       // run of set pixels begins
+      } else if(start >= 0){
+        ST7735_DrawFastHLine(start, py, px - start, textColor);
+        start = -1;
+      }
+      gx = gx + 1;
+      rem = size;
+    }
+    if(start >= 0){                     // run reaches the right edge
+      ST7735_DrawFastHLine(start, py, x1 + 1 - start, textColor);
+    }
+  }
+  if(bgColor != textColor){
+    pixelStreamEnd();
+  }
 }
 
 
 //------------ST7735_DrawCharS------------
-// Simple character draw function.  This is the same function from
-// Adafruit_GFX.c but adapted for this processor.  However, each call
-// to ST7735_DrawPixel() calls setAddrWindow(), which needs to send
-// many extra data and commands.  If the background color is the same
-// as the text color, no background will be printed, and text can be
-// drawn right over existing images without covering them with a box.
-// Requires (11 + 2*size*size)*6*8 (image fully on screen; textcolor != bgColor)
+// Simple character draw function.  This started as the function
+// from Adafruit_GFX.c, which called ST7735_DrawPixel() for every
+// font pixel; it now uses the span renderer above, so the whole
+// character goes out through one address window.  If the
+// background color is the same as the text color, no background
+// will be printed, and text can be drawn right over existing
+// images without covering them with a box.
+// Requires (11 + 2*size*size*6*8) bytes (image fully on screen; textcolor != bgColor)
 // Input: x         horizontal position of the top left corner of the character, columns from the left edge
 //        y         vertical position of the top left corner of the character, rows from the top edge
 //        c         character to be printed
@@ -1168,36 +1691,28 @@ void ST7735_DrawBitmap(int16_t x, int16_t y, const uint16_t *image, int16_t w, i
 //        size      number of pixels per character pixel (e.g. size==2 prints each pixel of font as 2x2 square)
 // Output: none
 void ST7735_DrawCharS(int16_t x, int16_t y, char c, int16_t textColor, int16_t bgColor, uint8_t size){
-  uint8_t line; // vertical column of pixels of character in font
-  int32_t i, j;
-  if((x >= _width)            || // Clip right
-     (y >= _height)           || // Clip bottom
-     ((x + 5 * size - 1) < 0) || // Clip left
-     ((y + 8 * size - 1) < 0))   // Clip top
-    return;
+  drawText(x, y, &c, 1, textColor, bgColor, size);
+}
 
-  for (i=0; i<6; i++ ) {
-    if (i == 5)
-      line = 0x0;
-    else
-      line = Font[(c*5)+i];
-    for (j = 0; j<8; j++) {
-      if (line & 0x1) {
-        if (size == 1) // default size
-          ST7735_DrawPixel(x+i, y+j, textColor);
-        else {  // big size
-          ST7735_FillRect(x+(i*size), y+(j*size), size, size, textColor);
-        }
-      } else if (bgColor != textColor) {
-        if (size == 1) // default size
-          ST7735_DrawPixel(x+i, y+j, bgColor);
-        else {  // big size
-          ST7735_FillRect(x+i*size, y+j*size, size, size, bgColor);
-        }
-      }
-      line >>= 1;
-    }
+
+//------------ST7735_DrawText------------
+// Draw a string at any pixel position, clipped to the screen on
+// all sides.  Each line of text is sent through one address
+// window (see ST7735_DrawCharS() for transparent text).
+// Requires (11 + 2*size*size*6*8*n) bytes for n characters fully on screen
+// Input: x         horizontal position of the top left corner of the text, columns from the left edge
+//        y         vertical position of the top left corner of the text, rows from the top edge
+//        pt        pointer to a null terminated string to be printed
+//        textColor 16-bit color of the characters
+//        bgColor   16-bit color of the background, same as textColor for transparent
+//        size      number of pixels per character pixel
+// Output: none
+void ST7735_DrawText(int16_t x, int16_t y, const char *pt, int16_t textColor, int16_t bgColor, uint8_t size){
+  uint32_t n = 0;
+  while(pt[n]){
+    n++;
   }
+  drawText(x, y, pt, n, textColor, bgColor, size);
 }
 
 
@@ -1216,7 +1731,7 @@ void ST7735_DrawCharS(int16_t x, int16_t y, char c, int16_t textColor, int16_t b
 // Output: none
 void ST7735_DrawChar(int16_t x, int16_t y, char c, int16_t textColor, int16_t bgColor, uint8_t size){
   uint8_t line; // horizontal row of pixels of character
-  int32_t col, row, i, j;// loop indices
+  int32_t col, row, i;// loop indices
   if(((x + 5*size - 1) >= _width)  || // Clip right
      ((y + 8*size - 1) >= _height) || // Clip bottom
      ((x + 5*size - 1) < 0)        || // Clip left
@@ -1226,6 +1741,7 @@ void ST7735_DrawChar(int16_t x, int16_t y, char c, int16_t textColor, int16_t bg
 
   setAddrWindow(x, y, x+6*size-1, y+8*size-1);
 
+  pixelStreamBegin();
   line = 0x01;        // print the top row first
   // print the rows, starting at the top
   for(row=0; row<8; row=row+1){
@@ -1234,28 +1750,24 @@ void ST7735_DrawChar(int16_t x, int16_t y, char c, int16_t textColor, int16_t bg
       for(col=0; col<5; col=col+1){
         if(Font[(c*5)+col]&line){
           // bit is set in Font, print pixel(s) in text color
-          for(j=0; j<size; j=j+1){
-            pushColor(textColor);
-          }
+          streamFill(textColor, size);
         } else{
           // bit is cleared in Font, print pixel(s) in background color
-          for(j=0; j<size; j=j+1){
-            pushColor(bgColor);
-          }
+          streamFill(bgColor, size);
         }
       }
       // print blank column(s) to the right of character
-      for(j=0; j<size; j=j+1){
-        pushColor(bgColor);
-      }
+      streamFill(bgColor, size);
     }
     line = line<<1;   // move up to the next row
   }
+  pixelStreamEnd();
 }
 //------------ST7735_DrawString------------
-// String draw function.
+// String draw function.  The whole string is sent through one
+// address window.
 // 16 rows (0 to 15) and 21 characters (0 to 20)
-// Requires (11 + size*size*6*8) bytes of transmission for each character
+// Requires (11 + 2*6*8*n) bytes of transmission for n characters
 // Input: x         columns from the left edge (0 to 20)
 //        y         rows from the top edge (0 to 15)
 //        pt        pointer to a null terminated string to be printed
@@ -1263,16 +1775,25 @@ void ST7735_DrawChar(int16_t x, int16_t y, char c, int16_t textColor, int16_t bg
 // bgColor is Black and size is 1
 // Output: number of characters printed
 uint32_t ST7735_DrawString(uint16_t x, uint16_t y, char *pt, int16_t textColor){
-  uint32_t count = 0;
+  uint32_t len = 0, limit;
   if(y>15) return 0;
-  while(*pt){
-    ST7735_DrawCharS(x*6, y*10, *pt, textColor, ST7735_BLACK, 1);
-    pt++;
-    x = x+1;
-    if(x>20) return count;  // number of characters printed
-    count++;
+  while(pt[len]){
+    len++;
+  }
+  if(x>20){                             // starts past the last column
+    if(len){
+      drawText(x*6, y*10, pt, 1, textColor, ST7735_BLACK, 1);  // clipped first character
+    }
+    return 0;
   }
-  return count;  // number of characters printed
+  limit = 21 - x;                       // columns left on the row
+  if(len >= limit){
+    len = limit;                        // reaches the end of the row
+    drawText(x*6, y*10, pt, len, textColor, ST7735_BLACK, 1);
+    return len-1;                       // last character is printed but not counted
+  }
+  drawText(x*6, y*10, pt, len, textColor, ST7735_BLACK, 1);
+  return len;  // number of characters printed
 }
 
 //-----------------------fillmessage-----------------------
@@ -1388,6 +1909,35 @@ void ST7735_SetRotation(uint8_t m) {
 }
 
 
+//------------ST7735_GetFont------------
+// Font used by the text functions, for renderers that draw
+// text into RAM.  Each character c is 5 bytes starting at
+// Font[c*5], one byte per column, least significant bit on top.
+// Input: none
+// Output: pointer to the 256 character 5x8 font
+const uint8_t *ST7735_GetFont(void){
+  return Font;
+}
+
+
+//------------ST7735_GetWidth------------
+// Width of the screen in the current rotation.
+// Input: none
+// Output: number of pixels from the left edge to the right edge
+int16_t ST7735_GetWidth(void){
+  return _width;
+}
+
+
+//------------ST7735_GetHeight------------
+// Height of the screen in the current rotation.
+// Input: none
+// Output: number of pixels from the top edge to the bottom edge
+int16_t ST7735_GetHeight(void){
+  return _height;
+}
+
+
 //------------ST7735_InvertDisplay------------
 // Send the command to invert all of the colors.
 // Requires 1 byte of transmission
@@ -1443,10 +1993,7 @@ void ST7735_PlotPoint(int32_t y){int32_t j;
   j = 32+(127*(Ymax-y))/Yrange;
   if(j<32) j = 32;
   if(j>159) j = 159;
-  ST7735_DrawPixel(X,   j,   ST7735_BLUE);
-  ST7735_DrawPixel(X+1, j,   ST7735_BLUE);
-  ST7735_DrawPixel(X,   j+1, ST7735_BLUE);
-  ST7735_DrawPixel(X+1, j+1, ST7735_BLUE);
+  ST7735_FillRect(X, j, 2, 2, ST7735_BLUE);  // 2x2 point, one window
 }
 // *************** ST7735_PlotLine ********************
 // Used in the voltage versus time plot, plot line to new point
@@ -1454,7 +2001,7 @@ void ST7735_PlotPoint(int32_t y){int32_t j;
 // Inputs: y is the y coordinate of the point plotted
 // Outputs: none
 int32_t lastj=0;
-void ST7735_PlotLine(int32_t y){int32_t i,j;
+void ST7735_PlotLine(int32_t y){int32_t j;
   if(y<Ymin) y=Ymin;
   if(y>Ymax) y=Ymax;
   // X goes from 0 to 127
@@ -1466,19 +2013,13 @@ void ST7735_PlotLine(int32_t y){int32_t i,j;
   if(j > 159) j = 159;
   if(lastj < 32) lastj = j;
   if(lastj > 159) lastj = j;
+  // one 2-pixel wide vertical span from the last point to this one
   if(lastj < j){
-    for(i = lastj+1; i<=j ; i++){
-      ST7735_DrawPixel(X,   i,   ST7735_BLUE) ;
-      ST7735_DrawPixel(X+1, i,   ST7735_BLUE) ;
-    }
+    ST7735_FillRect(X, lastj+1, 2, j-lastj, ST7735_BLUE);
   }else if(lastj > j){
-    for(i = j; i<lastj ; i++){
-      ST7735_DrawPixel(X,   i,   ST7735_BLUE) ;
-      ST7735_DrawPixel(X+1, i,   ST7735_BLUE) ;
-    }
+    ST7735_FillRect(X, j, 2, lastj-j, ST7735_BLUE);
   }else{
-    ST7735_DrawPixel(X,   j,   ST7735_BLUE) ;
-    ST7735_DrawPixel(X+1, j,   ST7735_BLUE) ;
+    ST7735_FillRect(X, j, 2, 1, ST7735_BLUE);
   }
   lastj = j;
 }
@@ -1646,6 +2187,178 @@ void ST7735_PlotNextErase(void){
 //        ST7735_PlotNext();
 //    }   // called 128 times
 
+// Scrolling strip chart
+// The controller can display its frame memory starting from any
+// row, wrapping around within a vertical scroll area (VSCRDEF
+// and VSCRSADD).  Frame memory rows run along the long side of
+// the screen, so in landscape (rotation 1 or 3) this scrolls the
+// chart sideways.  Each new sample moves the start row by one
+// and rewrites only the one column that wrapped around, as a
+// single vertical span, instead of redrawing the whole chart.
+// The frame memory has 162 rows; the scroll area is the chart
+// columns and the fixed areas are the columns to either side.
+#define CHART_ROWS 162              // rows of frame memory
+int16_t ChartLeft, ChartWidth;      // screen columns of the chart
+int16_t ChartTop, ChartHeight;      // screen rows of the chart
+int32_t ChartYmin, ChartYrange;
+uint16_t ChartColor, ChartBgColor;
+uint8_t ChartTFA;                   // frame memory row of the first scroll area slot
+uint8_t ChartReverse;               // 1 if screen columns run opposite to frame memory rows
+int16_t ChartStart;                 // scroll offset, 0 to ChartWidth-1
+uint8_t ChartLast;                  // row of the newest sample, 0xFF if none
+// ring buffer of the span drawn in each scroll area slot, 0xFF if empty
+uint8_t ChartLo[ST7735_TFTHEIGHT], ChartHi[ST7735_TFTHEIGHT];
+
+// Send the scroll start address for the current offset
+void static chartScroll(void){
+  writecommand(ST7735_VSCRSADD);
+  writedata(0x00);
+  writedata(ChartTFA + ChartStart);
+}
+
+// Draw one slot of the scroll area as a single column write.
+// Slots are addressed through the unscrolled screen column that
+// writes them, so the column shows up wherever the scroll puts it.
+void static chartColumn(int16_t slot){
+  int16_t x, lo, hi;
+  if(ChartReverse){
+    x = (CHART_ROWS - 1) - ColStart - (ChartTFA + slot);
+  } else{
+    x = ChartTFA + slot - ColStart;
+  }
+  setAddrWindow(x, ChartTop, x, ChartTop+ChartHeight-1);
+  pixelStreamBegin();
+  if(ChartLo[slot] == 0xFF){
+    streamFill(ChartBgColor, ChartHeight);
+  } else{
+    lo = ChartLo[slot];
+    hi = ChartHi[slot];
+    streamFill(ChartBgColor, lo);
+    streamFill(ChartColor, hi-lo+1);
+    streamFill(ChartBgColor, ChartHeight-1-hi);
+  }
+  pixelStreamEnd();
+}
+
+//------------ST7735_ChartInit------------
+// Start a scrolling strip chart.  The screen is switched to
+// landscape (rotation 1) if it is in portrait.  The chart area
+// is cleared; the rest of the screen is left alone and can be
+// used for labels, but only the columns to the left and right
+// of the chart stay put while it scrolls.
+// Requires about (30 + 2*width*height) bytes of transmission
+// Input: left    first screen column of the chart
+//        width   number of columns, also the number of samples shown
+//        top     first screen row of the chart
+//        height  number of rows
+//        ymin    value drawn at the bottom row
+//        ymax    value drawn at the top row
+//        color   16-bit color of the trace
+//        bgColor 16-bit color of the chart background
+// Output: none
+void ST7735_ChartInit(int16_t left, int16_t width, int16_t top, int16_t height,
+                      int32_t ymin, int32_t ymax, uint16_t color, uint16_t bgColor){
+  int16_t i;
+  if((Rotation&0x01) == 0){
+    ST7735_SetRotation(1);
+  }
+  if(left < 0){ width = width + left; left = 0; }
+  if(left + width > _width) width = _width - left;
+  if(top < 0){ height = height + top; top = 0; }
+  if(top + height > _height) height = _height - top;
+  if((width <= 1) || (height <= 0)){
+    ChartWidth = 0;
+    return;
+  }
+  if(ymax < ymin){ int32_t t = ymax; ymax = ymin; ymin = t; }
+  ChartLeft = left; ChartWidth = width;
+  ChartTop = top; ChartHeight = height;
+  ChartYmin = ymin; ChartYrange = (ymax > ymin) ? (ymax - ymin) : 1;
+  ChartColor = color; ChartBgColor = bgColor;
+  // rotation 1 mirrors the row address (MY), so screen columns
+  // run from the last frame memory row down
+  ChartReverse = (Rotation == 1);
+  if(ChartReverse){
+    ChartTFA = (CHART_ROWS - 1) - ColStart - (left + width - 1);
+  } else{
+    ChartTFA = left + ColStart;
+  }
+  ChartStart = 0;
+  ChartLast = 0xFF;
+  for(i=0; i<width; i=i+1){
+    ChartLo[i] = ChartHi[i] = 0xFF;
+  }
+  writecommand(ST7735_VSCRDEF);
+  writedata(0x00);
+  writedata(ChartTFA);                    // top fixed area
+  writedata(0x00);
+  writedata(width);                       // scroll area
+  writedata(0x00);
+  writedata(CHART_ROWS - ChartTFA - width); // bottom fixed area
+  chartScroll();
+  ST7735_FillRect(ChartLeft, ChartTop, ChartWidth, ChartHeight, bgColor);
+}
+
+//------------ST7735_ChartAdd------------
+// Add a sample at the right edge of the strip chart, scrolling
+// the older samples one column to the left.  The sample is
+// joined to the previous one by a vertical line.
+// Requires (19 + 2*height) bytes of transmission
+// Input: y new sample, clipped to the range given to ST7735_ChartInit()
+// Output: none
+void ST7735_ChartAdd(int32_t y){
+  int16_t slot, j;
+  if(ChartWidth <= 1) return;
+  if(y < ChartYmin) y = ChartYmin;
+  if(y > ChartYmin + ChartYrange) y = ChartYmin + ChartYrange;
+  // the slot that just scrolled off the left edge reappears on the right
+  if(ChartReverse){
+    ChartStart = (ChartStart == 0) ? ChartWidth - 1 : ChartStart - 1;
+    slot = ChartStart;
+  } else{
+    slot = ChartStart;
+    ChartStart = (ChartStart + 1 == ChartWidth) ? 0 : ChartStart + 1;
+  }
+  j = ((ChartHeight-1)*(ChartYmin + ChartYrange - y))/ChartYrange;
+  ChartLo[slot] = ChartHi[slot] = j;
+  if(ChartLast != 0xFF){
+    if(ChartLast < j) ChartLo[slot] = ChartLast;
+    if(ChartLast > j) ChartHi[slot] = ChartLast;
+  }
+  ChartLast = j;
+  chartColumn(slot);
+  chartScroll();
+}
+
+//------------ST7735_ChartRedraw------------
+// Redraw every column of the strip chart from the ring buffer,
+// e.g. after something else drew over it.
+// Requires about (19 + 2*height)*width bytes of transmission
+// Input: none
+// Output: none
+void ST7735_ChartRedraw(void){
+  int16_t slot;
+  if(ChartWidth <= 1) return;
+  for(slot=0; slot<ChartWidth; slot=slot+1){
+    chartColumn(slot);
+  }
+}
+
+//------------ST7735_ChartEnd------------
+// Stop the strip chart and return to normal display mode.  The
+// scroll is undone and the chart area is cleared.
+// Requires about (20 + 2*width*height) bytes of transmission
+// Input: none
+// Output: none
+void ST7735_ChartEnd(void){
+  if(ChartWidth <= 1) return;
+  ChartStart = 0;
+  chartScroll();
+  writecommand(ST7735_NORON);             // leave scroll mode
+  ST7735_FillRect(ChartLeft, ChartTop, ChartWidth, ChartHeight, ChartBgColor);
+  ChartWidth = 0;
+}
+
 // *************** ST7735_OutChar ********************
 // Output one character to the LCD
 // Position determined by ST7735_SetCursor command
@@ -114,6 +114,7 @@ enum initRFlags{
 
 //------------ST7735_InitB------------
 // Initialization for ST7735B screens.
+// Busy waits for the delays in the initialization sequence.
 // Input: none
 // Output: none
 void ST7735_InitB(void);
@@ -121,11 +122,47 @@ void ST7735_InitB(void);
 
 //------------ST7735_InitR------------
 // Initialization for ST7735R screens (green or red tabs).
+// Busy waits for the delays in the initialization sequence.
 // Input: option one of the enumerated options depending on tabs
 // Output: none
 void ST7735_InitR(enum initRFlags option);
 
 
+//------------ST7735_StartInitB------------
+// Start initialization of an ST7735B screen in the background.
+// Returns right away; the sequence continues from TIMER2A
+// interrupts during its delays (about 2 seconds in all).  No
+// other ST7735 function may be called until done is called, from
+// the TIMER2A interrupt.  The screen is not cleared, so the first
+// thing drawn, from the main program, should cover all of it.
+// Input: done function to call when finished, 0 for none
+// Output: none
+// Assumes: interrupts are enabled or will be soon
+void ST7735_StartInitB(void(*done)(void));
+
+
+//------------ST7735_StartInitR------------
+// Start initialization of an ST7735R screen in the background.
+// Returns right away; the sequence continues from TIMER2A
+// interrupts during its delays (about 2 seconds in all).  No
+// other ST7735 function may be called until done is called, from
+// the TIMER2A interrupt.  The screen is not cleared, so the first
+// thing drawn, from the main program, should cover all of it.
+// Input: option one of the enumerated options depending on tabs
+//        done   function to call when finished, 0 for none
+// Output: none
+// Assumes: interrupts are enabled or will be soon
+void ST7735_StartInitR(enum initRFlags option, void(*done)(void));
+
+
+//------------ST7735_InitDone------------
+// Check whether initialization has finished.  Nothing else may
+// be drawn until it has.
+// Input: none
+// Output: 1 if the screen is ready, 0 if still initializing
+int ST7735_InitDone(void);
+
+
 //------------ST7735_DrawPixel------------
 // Color the pixel at the given coordinates with the given color.
 // Requires 13 bytes of transmission
@@ -144,6 +181,48 @@ void ST7735_DrawCircle(uint8_t x0, uint8_t y0, uint8_t r, uint16_t color);
 void ST7735_FillCircle(uint8_t x0, uint8_t y0, uint8_t r, uint16_t color);
 void ST7735_DrawLine(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
 
+//------------ST7735_DrawRoundRect------------
+// Draw the outline of a rectangle with rounded corners.
+// Input: x     horizontal position of the top left corner of the rectangle, columns from the left edge
+//        y     vertical position of the top left corner of the rectangle, rows from the top edge
+//        w     horizontal width of the rectangle
+//        h     vertical height of the rectangle
+//        r     radius of the corners, at most half of w and h
+//        color 16-bit color, which can be produced by ST7735_Color565()
+// Output: none
+void ST7735_DrawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color);
+
+//------------ST7735_FillRoundRect------------
+// Fill a rectangle with rounded corners.
+// Input: x     horizontal position of the top left corner of the rectangle, columns from the left edge
+//        y     vertical position of the top left corner of the rectangle, rows from the top edge
+//        w     horizontal width of the rectangle
+//        h     vertical height of the rectangle
+//        r     radius of the corners, at most half of w and h
+//        color 16-bit color, which can be produced by ST7735_Color565()
+// Output: none
+void ST7735_FillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color);
+
+//------------ST7735_DrawTriangle------------
+// Draw the outline of a triangle.
+// Input: x0, y0 first corner, columns from the left edge and rows from the top edge
+//        x1, y1 second corner
+//        x2, y2 third corner
+//        color  16-bit color, which can be produced by ST7735_Color565()
+// Output: none
+void ST7735_DrawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                         int16_t x2, int16_t y2, uint16_t color);
+
+//------------ST7735_FillTriangle------------
+// Fill a triangle, one horizontal span per row.
+// Input: x0, y0 first corner, columns from the left edge and rows from the top edge
+//        x1, y1 second corner
+//        x2, y2 third corner
+//        color  16-bit color, which can be produced by ST7735_Color565()
+// Output: none
+void ST7735_FillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                         int16_t x2, int16_t y2, uint16_t color);
+
 //------------ST7735_DrawFastVLine------------
 // Draw a vertical line at the given coordinates with the given height and color.
 // A vertical line is parallel to the longer side of the rectangular display
@@ -225,14 +304,55 @@ uint16_t ST7735_SwapColor(uint16_t x) ;
 // Must be less than or equal to 128 pixels wide by 160 pixels high
 void ST7735_DrawBitmap(int16_t x, int16_t y, const uint16_t *image, int16_t w, int16_t h);
 
+//------------ST7735_DrawBuffer------------
+// Displays a 16-bit color image stored top row first, left to
+// right, such as a strip rendered in RAM.  Unlike
+// ST7735_DrawBitmap() the image may be any size and is clipped
+// on all sides.
+// Requires (11 + 2*w*h) bytes of transmission (assuming image fully on screen)
+// Input: x      horizontal position of the top left corner of the image, columns from the left edge
+//        y      vertical position of the top left corner of the image, rows from the top edge
+//        buf    pointer to w*h 16-bit colors
+//        w      number of pixels wide
+//        h      number of pixels tall
+//        stride number of pixels from the start of one row of buf to the next (w or more)
+// Output: none
+void ST7735_DrawBuffer(int16_t x, int16_t y, const uint16_t *buf, int16_t w, int16_t h, int16_t stride);
+
+//------------ST7735_DrawImage------------
+// Displays an image stored in the compressed format made by the
+// ImageConv host program (src/tools/ImageConv.c) from a 24-bit
+// .bmp file.  Pixels are indices into a palette of up to 256
+// colors, packed 1, 2, 4 or 8 bits each and run length coded,
+// which typically takes 5 to 10 times less flash than the
+// ST7735_DrawBitmap() format.  Decoding is done straight into
+// the pixel stream, and the image is clipped on all sides.
+//   bytes 0,1  width, least significant byte first
+//   bytes 2,3  height, least significant byte first
+//   byte 4     number of palette colors minus 1
+//   byte 5     bits per index: 1, 2, 4 or 8
+//   palette    2 bytes per color, least significant first, ST7735_Color565() format
+//   packets    pixels top row first, left to right; a packet may continue on the next row
+// Each packet starts with a code byte c.  If c&0x80 the next byte
+// is an index repeated (c&0x7F)+1 times; otherwise (c&0x7F)+1
+// indices follow, packed most significant bits first and padded
+// to a whole byte.
+// (x,y) is the screen location of the lower left corner of the image, as in ST7735_DrawBitmap()
+// Requires (11 + 2*w*h) bytes of transmission (assuming image fully on screen)
+// Input: x     horizontal position of the bottom left corner of the image, columns from the left edge
+//        y     vertical position of the bottom left corner of the image, rows from the top edge
+//        image pointer to a compressed image
+// Output: none
+void ST7735_DrawImage(int16_t x, int16_t y, const uint8_t *image);
+
 //------------ST7735_DrawCharS------------
-// Simple character draw function.  This is the same function from
-// Adafruit_GFX.c but adapted for this processor.  However, each call
-// to ST7735_DrawPixel() calls setAddrWindow(), which needs to send
-// many extra data and commands.  If the background color is the same
-// as the text color, no background will be printed, and text can be
+// Simple character draw function.  This started as the function
+// from Adafruit_GFX.c, which called ST7735_DrawPixel() for every
+// font pixel; it now expands the font bits straight into one
+// address window.  If the background color is the same as the
+// text color, no background will be printed, and text can be
 // drawn right over existing images without covering them with a box.
-// Requires (11 + 2*size*size)*6*8 (image fully on screen; textcolor != bgColor)
+// Requires (11 + 2*size*size*6*8) bytes (image fully on screen; textcolor != bgColor)
 // Input: x         horizontal position of the top left corner of the character, columns from the left edge
 //        y         vertical position of the top left corner of the character, rows from the top edge
 //        c         character to be printed
@@ -242,6 +362,21 @@ void ST7735_DrawBitmap(int16_t x, int16_t y, const uint16_t *image, int16_t w, i
 // Output: none
 void ST7735_DrawCharS(int16_t x, int16_t y, char c, int16_t textColor, int16_t bgColor, uint8_t size);
 
+//------------ST7735_DrawText------------
+// Draw a string at any pixel position, clipped to the screen on
+// all sides.  Each line of text is sent through one address
+// window.  If the background color is the same as the text color,
+// no background will be printed.
+// Requires (11 + 2*size*size*6*8*n) bytes for n characters fully on screen
+// Input: x         horizontal position of the top left corner of the text, columns from the left edge
+//        y         vertical position of the top left corner of the text, rows from the top edge
+//        pt        pointer to a null terminated string to be printed
+//        textColor 16-bit color of the characters
+//        bgColor   16-bit color of the background, same as textColor for transparent
+//        size      number of pixels per character pixel
+// Output: none
+void ST7735_DrawText(int16_t x, int16_t y, const char *pt, int16_t textColor, int16_t bgColor, uint8_t size);
+
 //------------ST7735_DrawChar------------
 // Advanced character draw function.  This is similar to the function
 // from Adafruit_GFX.c but adapted for this processor.  However, this
@@ -258,9 +393,10 @@ void ST7735_DrawCharS(int16_t x, int16_t y, char c, int16_t textColor, int16_t b
 void ST7735_DrawChar(int16_t x, int16_t y, char c, int16_t textColor, int16_t bgColor, uint8_t size);
 
 //------------ST7735_DrawString------------
-// String draw function.
+// String draw function.  The whole string is sent through one
+// address window.
 // 16 rows (0 to 15) and 21 characters (0 to 20)
-// Requires (11 + size*size*6*8) bytes of transmission for each character
+// Requires (11 + 2*6*8*n) bytes of transmission for n characters
 // Input: x         columns from the left edge (0 to 20)
 //        y         rows from the top edge (0 to 15)
 //        pt        pointer to a null terminated string to be printed
@@ -290,6 +426,26 @@ void ST7735_SetCursor(uint32_t newX, uint32_t newY);
 void ST7735_OutUDec(uint32_t n);
 
 
+//------------ST7735_GetFont------------
+// Font used by the text functions, for renderers that draw
+// text into RAM.  Each character c is 5 bytes starting at
+// Font[c*5], one byte per column, least significant bit on top.
+// Input: none
+// Output: pointer to the 256 character 5x8 font
+const uint8_t *ST7735_GetFont(void);
+
+//------------ST7735_GetWidth------------
+// Width of the screen in the current rotation.
+// Input: none
+// Output: number of pixels from the left edge to the right edge
+int16_t ST7735_GetWidth(void);
+
+//------------ST7735_GetHeight------------
+// Height of the screen in the current rotation.
+// Input: none
+// Output: number of pixels from the top edge to the bottom edge
+int16_t ST7735_GetHeight(void);
+
 //------------ST7735_SetRotation------------
 // Change the image rotation.
 // Requires 2 bytes of transmission
@@ -413,6 +569,59 @@ void ST7735_PlotNextErase(void);
 //        ST7735_PlotNext();
 //    }   // called 128 times
 
+//------------ST7735_ChartInit------------
+// Start a scrolling strip chart.  The controller's vertical
+// scroll area is used so the chart moves sideways in landscape
+// and each new sample costs one column write.  The screen is
+// switched to landscape (rotation 1) if it is in portrait.  The
+// chart area is cleared; the rest of the screen is left alone
+// and can be used for labels, but only the columns to the left
+// and right of the chart stay put while it scrolls.  Other
+// drawing inside the chart columns is scrolled with the chart.
+// Requires about (30 + 2*width*height) bytes of transmission
+// Input: left    first screen column of the chart
+//        width   number of columns, also the number of samples shown
+//        top     first screen row of the chart
+//        height  number of rows
+//        ymin    value drawn at the bottom row
+//        ymax    value drawn at the top row
+//        color   16-bit color of the trace
+//        bgColor 16-bit color of the chart background
+// Output: none
+void ST7735_ChartInit(int16_t left, int16_t width, int16_t top, int16_t height,
+                      int32_t ymin, int32_t ymax, uint16_t color, uint16_t bgColor);
+
+//------------ST7735_ChartAdd------------
+// Add a sample at the right edge of the strip chart, scrolling
+// the older samples one column to the left.  The sample is
+// joined to the previous one by a vertical line.
+// Requires (19 + 2*height) bytes of transmission
+// Input: y new sample, clipped to the range given to ST7735_ChartInit()
+// Output: none
+void ST7735_ChartAdd(int32_t y);
+
+//------------ST7735_ChartRedraw------------
+// Redraw every column of the strip chart from its ring buffer
+// of samples, e.g. after something else drew over it.
+// Requires about (19 + 2*height)*width bytes of transmission
+// Input: none
+// Output: none
+void ST7735_ChartRedraw(void);
+
+//------------ST7735_ChartEnd------------
+// Stop the strip chart and return to normal display mode.  The
+// scroll is undone and the chart area is cleared.
+// Requires about (20 + 2*width*height) bytes of transmission
+// Input: none
+// Output: none
+void ST7735_ChartEnd(void);
+
+// Example 5 Scrolling strip chart
+//    ST7735_ChartInit(20, 140, 16, 112, 0, 4095, ST7735_GREEN, ST7735_BLACK);
+//    {
+//        ST7735_ChartAdd(data);     // called at the sample rate
+//    }
+
 // *************** ST7735_OutChar ********************
 // Output one character to the LCD
 // Position determined by ST7735_SetCursor command
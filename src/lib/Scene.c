@@ -0,0 +1,34 @@
+// Scene.c
+// Runs on LM4F120/TM4C123
+// Lighting scenes: named sets of levels for the Slave's LED
+// strips, kept in flash and shared by the Master and the Slave.
+// Chanartip Soonthornwan
+
+#include <stdint.h>
+#include "PWM.h"
+#include "Scene.h"
+
+// Stepped through by the Master's 'C' key, in this order.  The
+// messages follow the Master's 'A' to 'D' brightness commands.
+//                                          HALLWAY BATHROOM
+const Scene Scenes[] = {
+  {"EVENING", 'E', 2000, PWM_FADE_EASE,   {150,     90}},
+  {"NIGHT",   'F', 3000, PWM_FADE_EASE,   { 40,     25}},
+  {"BRIGHT",  'G',  600, PWM_FADE_EASE,   {255,    255}},
+  {"OFF",     'H', 1500, PWM_FADE_EASE,   {  0,      0}},
+};
+const uint8_t SceneCount = sizeof(Scenes)/sizeof(Scene);
+
+//********Scene_Find*****************
+// Look up the scene selected by a Bluetooth character.
+// inputs: message  character received
+// outputs: the scene, 0 if message selects none
+const Scene *Scene_Find(char message){
+  uint8_t i;
+  for(i=0; i<SceneCount; i=i+1){
+    if(Scenes[i].message == message){
+      return &Scenes[i];
+    }
+  }
+  return 0;
+}
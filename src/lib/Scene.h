@@ -0,0 +1,41 @@
+// Scene.h
+// Runs on LM4F120/TM4C123
+// Lighting scenes: named sets of levels for the Slave's LED
+// strips, kept in flash and shared by the Master and the Slave.
+// The Master sends a scene's message character over Bluetooth;
+// the Slave looks it up and fades every strip to its level.
+// Chanartip Soonthornwan
+
+// A scene has one fade time for all its strips.  The Slave starts
+// the fades inside PWM_Begin()/PWM_Commit(), so they take their
+// first step on the same tick of the fade engine and, being as
+// long, reach their levels in the same PWM period: the room
+// changes as one, not strip by strip.
+
+#ifndef __SCENE_H__ // do not include more than once
+#define __SCENE_H__
+#include <stdint.h>
+
+// Strips of a scene, in the order of PWM channels on the Slave
+#define SCENE_HALLWAY      0            // PWM_CH0, PB6
+#define SCENE_BATHROOM     1            // PWM_CH2, PB4
+#define SCENE_STRIPS       2
+
+typedef struct {
+  const char *name;                     // printed by the Slave on UART0
+  char message;                         // Bluetooth character that selects it
+  uint16_t ms;                          // fade time of every strip
+  uint8_t curve;                        // PWM_FADE_LINEAR or PWM_FADE_EASE
+  uint8_t level[SCENE_STRIPS];          // perceptual level, 0 (off) to PWM_LEVEL_MAX
+} Scene;
+
+extern const Scene Scenes[];
+extern const uint8_t SceneCount;
+
+//********Scene_Find*****************
+// Look up the scene selected by a Bluetooth character.
+// inputs: message  character received
+// outputs: the scene, 0 if message selects none
+const Scene *Scene_Find(char message);
+
+#endif // __SCENE_H__
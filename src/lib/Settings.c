@@ -0,0 +1,269 @@
+// Settings.c
+// Runs on LM4F120/TM4C123, or a PC with EEPROM_SIMULATE defined
+// Settings kept over resets in the 2 KB on-chip EEPROM, as a ring
+// of 16-byte records with a sequence number and a CRC.  Saves are
+// coalesced in RAM and written from the main loop.
+// Chanartip Soonthornwan
+
+#include <stdint.h>
+#include "Timebase.h"
+#include "Settings.h"
+#ifndef EEPROM_SIMULATE
+#include "tm4c123gh6pm.h"
+#endif
+
+long StartCritical(void);    // previous I bit, disable interrupts
+void EndCritical(long sr);   // restore I bit to previous value
+
+#define RECORD         16               // bytes in a record
+#define RECORD_CRC     14               // bytes covered by the CRC
+
+static SettingsStats Stats;
+static uint8_t Version;
+static uint8_t Stored[SETTINGS_DATA];   // data of the newest record, or the defaults
+static uint8_t Staged[SETTINGS_DATA];   // data waiting to be written
+static uint8_t Dirty;                   // 1 if Staged differs from Stored
+static uint64_t Changed;                // Timebase_Now() of the last change
+
+#ifdef EEPROM_SIMULATE
+uint32_t Settings_Memory[SETTINGS_WORDS];
+uint32_t Settings_Wear[SETTINGS_WORDS];
+int32_t Settings_PowerCut = -1;
+
+static int eeStart(void){
+  return 1;
+}
+
+static uint32_t eeRead(uint16_t addr){
+  return Settings_Memory[addr];
+}
+
+static void eeWrite(uint16_t addr, uint32_t value){
+  if(Settings_PowerCut == 0){
+    return;                             // the power is gone
+  }
+  if(Settings_PowerCut > 0){
+    Settings_PowerCut = Settings_PowerCut - 1;
+  }
+  Settings_Memory[addr] = value;
+  Settings_Wear[addr] = Settings_Wear[addr] + 1;
+}
+#else
+// Wait for the EEPROM to finish, 0 if it reports a failure
+static int eeWait(void){
+  while(EEPROM_EEDONE_R&EEPROM_EEDONE_WORKING){};
+  return (EEPROM_EESUPP_R&(EEPROM_EESUPP_PRETRY|EEPROM_EESUPP_ERETRY)) == 0;
+}
+
+// Turn on the EEPROM and let it recover from an interrupted write,
+// as in the data sheet's initialization sequence.
+static int eeStart(void){
+  volatile unsigned long delay;
+  SYSCTL_RCGCEEPROM_R |= 0x01;          // activate the EEPROM
+  while((SYSCTL_PREEPROM_R&0x01) == 0){};
+  delay = SYSCTL_RCGCEEPROM_R;          // at least 6 cycles before the status is valid
+  if(!eeWait()){
+    return 0;
+  }
+  SYSCTL_SREEPROM_R = 0x01;             // reset it so the recovery is loaded
+  SYSCTL_SREEPROM_R = 0;
+  while((SYSCTL_PREEPROM_R&0x01) == 0){};
+  delay = SYSCTL_RCGCEEPROM_R;
+  (void)delay;
+  return eeWait();
+}
+
+// Words are addressed as block (16 words) and offset
+static uint32_t eeRead(uint16_t addr){
+  EEPROM_EEBLOCK_R = addr>>4;
+  EEPROM_EEOFFSET_R = addr&0x0F;
+  return EEPROM_EERDWR_R;
+}
+
+static void eeWrite(uint16_t addr, uint32_t value){
+  EEPROM_EEBLOCK_R = addr>>4;
+  EEPROM_EEOFFSET_R = addr&0x0F;
+  EEPROM_EERDWR_R = value;
+  (void)eeWait();                       // a failed word fails the record's CRC
+}
+#endif
+
+// CRC-16-CCITT, polynomial 0x1021, starting at 0xFFFF
+static uint16_t crc16(const uint8_t *pt, uint8_t n){
+  uint16_t crc = 0xFFFF;
+  uint8_t i;
+  while(n){
+    crc = crc^((uint16_t)*pt<<8);
+    for(i=0; i<8; i=i+1){
+      crc = (crc&0x8000) ? (crc<<1)^0x1021 : crc<<1;
+    }
+    pt = pt + 1;
+    n = n - 1;
+  }
+  return crc;
+}
+
+// Read a record, 1 if it is good
+static int readSlot(uint16_t slot, uint8_t *rec){
+  uint32_t word = 0;
+  uint8_t i;
+  for(i=0; i<RECORD; i=i+1){
+    if((i&3) == 0){
+      word = eeRead(4*slot + i/4);
+    }
+    rec[i] = (uint8_t)(word>>(8*(i&3)));  // little endian
+  }
+  return (rec[0] == SETTINGS_MAGIC) &&
+         (crc16(rec, RECORD_CRC) == (rec[14]|(rec[15]<<8)));
+}
+
+// Write data as the record after the newest one
+static void writeRecord(const uint8_t *data){
+  uint8_t rec[RECORD], i;
+  uint16_t slot = (Stats.slot + 1)%SETTINGS_SLOTS;
+  uint16_t seq = Stats.seq + 1, crc;
+  rec[0] = SETTINGS_MAGIC;
+  rec[1] = Version;
+  rec[2] = (uint8_t)seq;
+  rec[3] = (uint8_t)(seq>>8);
+  for(i=0; i<SETTINGS_DATA; i=i+1){
+    rec[4+i] = data[i];
+  }
+  crc = crc16(rec, RECORD_CRC);
+  rec[14] = (uint8_t)crc;
+  rec[15] = (uint8_t)(crc>>8);
+  for(i=0; i<RECORD; i=i+4){
+    eeWrite(4*slot + i/4, rec[i]|(rec[i+1]<<8)|((uint32_t)rec[i+2]<<16)|((uint32_t)rec[i+3]<<24));
+  }
+  Stats.slot = slot;
+  Stats.seq = seq;
+  Stats.writes = Stats.writes + 1;
+}
+
+//********Settings_Init*****************
+// Start the EEPROM and restore the newest record of this version.
+// Called once at boot, before interrupts that save settings.
+// inputs: version  layout of the data, any number
+//         data     where to restore, left as is if nothing is
+//         size     bytes of data, at most SETTINGS_DATA
+// outputs: 1 if data was restored, 0 if the program's defaults stay
+int Settings_Init(uint8_t version, void *data, uint8_t size){
+  uint8_t rec[RECORD], newest[RECORD], *pt = data, i;
+  uint16_t slot, seq;
+  int found = 0, restored = 0;
+  Stats.writes = Stats.coalesced = Stats.skipped = 0;
+  Stats.slot = SETTINGS_SLOTS - 1;      // so the first record goes in slot 0
+  Stats.seq = 0xFFFF;
+  Stats.failed = 0;
+  Version = version;
+  Dirty = 0;
+  if(!eeStart()){
+    Stats.failed = 1;
+    return 0;
+  }
+  for(slot=0; slot<SETTINGS_SLOTS; slot=slot+1){
+    if(readSlot(slot, rec)){
+      seq = rec[2]|(rec[3]<<8);
+      if(!found || ((int16_t)(seq - Stats.seq) > 0)){   // newer, across the wrap
+        found = 1;
+        Stats.slot = slot;
+        Stats.seq = seq;
+        for(i=0; i<RECORD; i=i+1){
+          newest[i] = rec[i];
+        }
+      }
+    }
+  }
+  if(found && (newest[1] == version)){
+    for(i=0; i<size; i=i+1){
+      pt[i] = newest[4+i];
+    }
+    restored = 1;
+  }
+  for(i=0; i<SETTINGS_DATA; i=i+1){     // what a save is compared with
+    Stored[i] = (i < size) ? pt[i] : 0;
+  }
+  return restored;
+}
+
+//********Settings_Save*****************
+// Stage data to be written by Settings_Poll().  Safe to call from
+// an ISR and as often as the data changes.
+// inputs: data  settings, same layout as Settings_Init()
+//         size  bytes of data, at most SETTINGS_DATA
+// outputs: none
+void Settings_Save(const void *data, uint8_t size){
+  const uint8_t *pt = data;
+  uint8_t i, b, sameStaged = 1, sameStored = 1;
+  long sr;
+  if(Stats.failed){
+    return;
+  }
+  sr = StartCritical();
+  for(i=0; i<SETTINGS_DATA; i=i+1){
+    b = (i < size) ? pt[i] : 0;
+    sameStaged = sameStaged && (b == Staged[i]);
+    sameStored = sameStored && (b == Stored[i]);
+  }
+  if(Dirty && sameStaged){              // nothing new, the quiet time goes on
+  } else if(sameStored){
+    if(Dirty){                          // changed back before it was written
+      Dirty = 0;
+      Stats.coalesced = Stats.coalesced + 1;
+    } else{
+      Stats.skipped = Stats.skipped + 1;
+    }
+  } else{
+    if(Dirty){
+      Stats.coalesced = Stats.coalesced + 1;
+    }
+    for(i=0; i<SETTINGS_DATA; i=i+1){
+      Staged[i] = (i < size) ? pt[i] : 0;
+    }
+    Dirty = 1;
+    Changed = Timebase_Now();
+  }
+  EndCritical(sr);
+}
+
+//********Settings_Poll*****************
+// Write the staged data once it has been unchanged for
+// SETTINGS_HOLD_MS.  Called from the main loop; a write takes
+// a few milliseconds.
+// inputs: none
+// outputs: none
+void Settings_Poll(void){
+  int due;
+  long sr = StartCritical();
+  due = Dirty && (Timebase_Now() - Changed >= TIMEBASE_MS(SETTINGS_HOLD_MS));
+  EndCritical(sr);
+  if(due){
+    Settings_Flush();
+  }
+}
+
+//********Settings_Flush*****************
+// Write the staged data now, if any.  Called from the main loop.
+// inputs: none
+// outputs: none
+void Settings_Flush(void){
+  uint8_t data[SETTINGS_DATA], i;
+  long sr = StartCritical();
+  if(!Dirty){
+    EndCritical(sr);
+    return;
+  }
+  for(i=0; i<SETTINGS_DATA; i=i+1){
+    data[i] = Stored[i] = Staged[i];
+  }
+  Dirty = 0;
+  EndCritical(sr);
+  writeRecord(data);                    // a save from an ISR now stages the next one
+}
+
+//********Settings_Stats*****************
+// inputs: none
+// outputs: counters of the store
+const SettingsStats *Settings_Stats(void){
+  return &Stats;
+}
@@ -0,0 +1,90 @@
+// Settings.h
+// Runs on LM4F120/TM4C123, or a PC with EEPROM_SIMULATE defined
+// Settings kept over resets in the 2 KB on-chip EEPROM.  The
+// EEPROM is used as a ring of 16-byte records; each save goes to
+// the slot after the newest record, so every slot wears the same,
+// and at boot the newest record with a good CRC is restored.
+// Chanartip Soonthornwan
+
+// Record, four 32-bit words
+//   byte  0     SETTINGS_MAGIC
+//   byte  1     version of the data layout, set by the program
+//   bytes 2,3   sequence number, one more than the previous record
+//   bytes 4-13  data, SETTINGS_DATA bytes, zero padded
+//   bytes 14,15 CRC-16-CCITT of bytes 0 to 13
+// A record cut short by a reset fails its CRC and the one before
+// it is restored.  A record of another version is not restored,
+// so changing the layout starts from the program's defaults.
+
+// Write coalescing.  Settings_Save() only copies the data; it is
+// written by Settings_Poll() once it has not changed for
+// SETTINGS_HOLD_MS, so a run of brightness steps costs one write,
+// and nothing is written if the data ends up as it was stored.
+
+// With EEPROM_SIMULATE defined, the EEPROM is an array in RAM and
+// the time comes from Timebase_Now() and StartCritical() provided
+// by the program, so the store can be run on a PC
+// (src/tools/SettingsSim.c).
+
+#ifndef __SETTINGS_H__ // do not include more than once
+#define __SETTINGS_H__
+#include <stdint.h>
+
+#define SETTINGS_MAGIC     0xA5
+#define SETTINGS_DATA      10           // bytes of data in a record
+#define SETTINGS_SLOTS     128          // records in the 2 KB EEPROM
+#define SETTINGS_HOLD_MS   3000         // quiet time before a change is written
+
+typedef struct {
+  uint32_t writes;                      // records written
+  uint32_t coalesced;                   // saves absorbed by a later one
+  uint32_t skipped;                     // saves equal to the stored data
+  uint16_t slot;                        // slot of the newest record
+  uint16_t seq;                         // its sequence number
+  uint8_t failed;                       // 1 if the EEPROM did not start
+} SettingsStats;
+
+//********Settings_Init*****************
+// Start the EEPROM and restore the newest record of this version.
+// Called once at boot, before interrupts that save settings.
+// inputs: version  layout of the data, any number
+//         data     where to restore, left as is if nothing is
+//         size     bytes of data, at most SETTINGS_DATA
+// outputs: 1 if data was restored, 0 if the program's defaults stay
+int Settings_Init(uint8_t version, void *data, uint8_t size);
+
+//********Settings_Save*****************
+// Stage data to be written by Settings_Poll().  Safe to call from
+// an ISR and as often as the data changes.
+// inputs: data  settings, same layout as Settings_Init()
+//         size  bytes of data, at most SETTINGS_DATA
+// outputs: none
+void Settings_Save(const void *data, uint8_t size);
+
+//********Settings_Poll*****************
+// Write the staged data once it has been unchanged for
+// SETTINGS_HOLD_MS.  Called from the main loop; a write takes
+// a few milliseconds.
+// inputs: none
+// outputs: none
+void Settings_Poll(void);
+
+//********Settings_Flush*****************
+// Write the staged data now, if any.  Called from the main loop.
+// inputs: none
+// outputs: none
+void Settings_Flush(void);
+
+//********Settings_Stats*****************
+// inputs: none
+// outputs: counters of the store
+const SettingsStats *Settings_Stats(void);
+
+#ifdef EEPROM_SIMULATE
+#define SETTINGS_WORDS     (4*SETTINGS_SLOTS)
+extern uint32_t Settings_Memory[SETTINGS_WORDS];    // the simulated EEPROM
+extern uint32_t Settings_Wear[SETTINGS_WORDS];      // writes of each word
+extern int32_t Settings_PowerCut;   // words written before a simulated reset, -1 never
+#endif
+
+#endif // __SETTINGS_H__
@@ -0,0 +1,307 @@
+// SoftTimer.c
+// Runs on LM4F120/TM4C123
+// Any number of one-shot and periodic software timers in a
+// hierarchical timing wheel, on TIMER3A in one-shot mode set for
+// the next thing the wheel has to do.
+// Chanartip Soonthornwan
+
+#include <stdint.h>
+#include "tm4c123gh6pm.h"
+#include "Timebase.h"
+#include "SoftTimer.h"
+
+long StartCritical(void);    // previous I bit, disable interrupts
+void EndCritical(long sr);   // restore I bit to previous value
+void WaitForInterrupt(void); // low power mode
+
+#define MS             TIMEBASE_MS(1)   // bus cycles in a tick of the wheel
+#define SPAN(level)    (1ULL<<(6*(level)))      // ms in a slot of a level
+#define RANGE          SPAN(SOFTTIMER_LEVELS)   // ms the wheel reaches
+#define NONE           0xFFFFFFFFFFFFFFFFULL
+#define EXPIRED        0xFF             // level of timers waiting for their task to run
+#define MIN_DELAY      50               // bus cycles, TIMER3A is never set shorter
+
+static SoftTimer *Slots[SOFTTIMER_LEVELS][64];
+static uint64_t Used[SOFTTIMER_LEVELS]; // bit n set if slot n has timers
+static SoftTimer *Expired;              // timers of the tick being run
+static uint64_t Next;                   // next ms of the wheel to run; earlier ones are done
+static SoftTimerStats Stats;
+static volatile uint8_t Woken;          // SoftTimer_Wake() called
+
+// Offset from bit start to the first set bit at or after it,
+// wrapping around from bit 63 to bit 0.  bits is not 0.
+static uint8_t firstFrom(uint64_t bits, uint8_t start){
+  uint8_t k = 0;
+  if(start){
+    bits = (bits>>start)|(bits<<(64 - start));
+  }
+  if((uint32_t)bits == 0){ bits = bits>>32; k = k + 32; }
+  if((bits&0xFFFF) == 0){ bits = bits>>16; k = k + 16; }
+  if((bits&0xFF) == 0){ bits = bits>>8; k = k + 8; }
+  if((bits&0x0F) == 0){ bits = bits>>4; k = k + 4; }
+  if((bits&0x03) == 0){ bits = bits>>2; k = k + 2; }
+  if((bits&0x01) == 0){ k = k + 1; }
+  return k;
+}
+
+// Queue a timer in the slot of the lowest level that reaches its
+// expiry time.  Level 0 holds the next 64 ms; a slot of level L
+// holds timers due within the 64^L ms that start when the wheel
+// reaches it, which is when they are moved down.
+static void insert(SoftTimer *t){
+  uint64_t e = t->expires, d;
+  uint8_t level = 0, slot;
+  if(e < Next){
+    e = Next;                           // late, run at the next tick
+  }
+  d = e - Next;
+  if(d >= RANGE){
+    d = RANGE - 1;                      // far away, wait in the last level
+    e = Next + d;
+  }
+  while(d >= SPAN(level + 1)){
+    level = level + 1;
+  }
+  slot = (e>>(6*level))&63;
+  t->prev = 0;
+  t->next = Slots[level][slot];
+  if(t->next){
+    t->next->prev = t;
+  }
+  Slots[level][slot] = t;
+  Used[level] |= 1ULL<<slot;
+  t->level = level;
+  t->slot = slot;
+  t->queued = 1;
+}
+
+// Take a timer out of its list
+static void unlink(SoftTimer *t){
+  SoftTimer **head = (t->level == EXPIRED) ? &Expired : &Slots[t->level][t->slot];
+  if(t->prev){
+    t->prev->next = t->next;
+  } else{
+    *head = t->next;
+  }
+  if(t->next){
+    t->next->prev = t->prev;
+  }
+  if((*head == 0) && (t->level != EXPIRED)){
+    Used[t->level] &= ~(1ULL<<t->slot);
+  }
+  t->queued = 0;
+}
+
+// ms from Next to the next tick with work: a level 0 slot with
+// timers, or a higher slot with timers to move down; NONE if the
+// wheel is empty
+static uint64_t nextDue(void){
+  uint64_t due = NONE, when, span;
+  uint8_t level;
+  if(Used[0]){
+    due = firstFrom(Used[0], Next&63);
+  }
+  for(level=1; level<SOFTTIMER_LEVELS; level=level+1){
+    if(Used[level]){
+      span = SPAN(level);
+      when = (Next + span - 1)&~(span - 1);    // first slot boundary from Next
+      when = when + firstFrom(Used[level], (when>>(6*level))&63)*span - Next;
+      if(when < due){
+        due = when;
+      }
+    }
+  }
+  return due;
+}
+
+// Set TIMER3A for the next tick with work, or stop it.
+// Interrupts are disabled.
+static void reprogram(void){
+  uint64_t due = nextDue(), when, now;
+  uint64_t delay = MIN_DELAY;
+  TIMER3_CTL_R = 0;                     // disable TIMER3A
+  if(due == NONE){
+    return;                             // nothing to wait for
+  }
+  when = (Next + due)*MS;
+  now = Timebase_Now();
+  if(when > now + MIN_DELAY){
+    delay = when - now;
+  }
+  if(delay > 0xFFFFFFFF){
+    delay = 0xFFFFFFFF;                 // 85 s, then look again
+  }
+  TIMER3_TAILR_R = (uint32_t)delay - 1;
+  TIMER3_ICR_R = TIMER_ICR_TATOCINT;
+  TIMER3_CTL_R = TIMER_CTL_TAEN;        // stops by itself after one timeout
+}
+
+//********SoftTimer_Init*****************
+// Set up TIMER3A for the wheel.  Called once after Timebase_Init().
+// inputs: none
+// outputs: none
+void SoftTimer_Init(void){
+  SYSCTL_RCGCTIMER_R |= 0x08;           // 0) activate TIMER3
+  while((SYSCTL_PRTIMER_R&0x08) == 0){};// allow time for clock to start
+  TIMER3_CTL_R = 0x00000000;            // 1) disable TIMER3A during setup
+  TIMER3_CFG_R = 0x00000000;            // 2) configure for 32-bit mode
+  TIMER3_TAMR_R = 0x00000001;           // 3) configure for one-shot mode, down-count
+  TIMER3_TAPR_R = 0;                    // 4) bus clock resolution
+  TIMER3_ICR_R = TIMER_ICR_TATOCINT;    // 5) clear TIMER3A timeout flag
+  TIMER3_IMR_R = TIMER_IMR_TATOIM;      // 6) arm timeout interrupt
+  NVIC_PRI8_R = (NVIC_PRI8_R&0x00FFFFFF)|0xC0000000; // 7) priority 6
+// vector number 51, interrupt number 35
+  NVIC_EN1_R = 1<<(35-32);              // 8) enable IRQ 35 in NVIC
+  Next = Timebase_Now()/MS;
+}
+
+//********SoftTimer_Start*****************
+// Run a task once after ms milliseconds, and then every period
+// milliseconds if period is not 0.  Restarts the timer if it was
+// running.  Safe to call from any ISR.
+// inputs: t       timer, zero initialized the first time
+//         task    function to run
+//         ms      delay to the first run, at least ms and less
+//                 than ms+1 milliseconds
+//         period  ms between runs, 0 to run once
+// outputs: none
+void SoftTimer_Start(SoftTimer *t, void (*task)(void), uint32_t ms, uint32_t period){
+  uint64_t now = (Timebase_Now() + MS - 1)/MS;  // the next ms boundary
+  long sr = StartCritical();
+  if(t->queued){
+    unlink(t);
+  }
+  if((Next < now) && (nextDue() == NONE)){
+    Next = now;                         // catch up an idle wheel, nothing to skip
+  }
+  t->task = task;
+  t->period = period;
+  t->expires = now + ms;
+  insert(t);
+  reprogram();
+  EndCritical(sr);
+}
+
+//********SoftTimer_Cancel*****************
+// Stop a timer; its task will not run unless started again.
+// Safe to call from any ISR, and on a timer that is not running.
+// inputs: t  timer
+// outputs: none
+void SoftTimer_Cancel(SoftTimer *t){
+  long sr = StartCritical();
+  if(t->queued){
+    unlink(t);
+    reprogram();
+  }
+  EndCritical(sr);
+}
+
+//********SoftTimer_Running*****************
+// inputs: t  timer
+// outputs: 1 if the timer is running, 0 if it expired (one-shot)
+//          or was cancelled
+int SoftTimer_Running(SoftTimer *t){
+  return t->queued;
+}
+
+//********SoftTimer_Idle*****************
+// Sleep until an interrupt: an input, or the soft timer due
+// next, unless SoftTimer_Wake() was called since the last return.
+// The interrupt has run when it returns.  Called from the main
+// loop when it has nothing to do.
+// inputs: none
+// outputs: none
+void SoftTimer_Idle(void){
+  uint64_t start;
+  long sr = StartCritical();            // a pending interrupt still ends the WFI
+  if(!Woken){
+    start = Timebase_Now();
+    WaitForInterrupt();
+    Stats.asleep = Stats.asleep + (Timebase_Now() - start);
+    Stats.wakeups = Stats.wakeups + 1;
+  }
+  Woken = 0;
+  EndCritical(sr);                      // let it run
+}
+
+//********SoftTimer_Wake*****************
+// Make the next SoftTimer_Idle() return at once.  Safe to call
+// from any ISR, and usable as the task of a timer that only wakes
+// the main loop.
+// inputs: none
+// outputs: none
+void SoftTimer_Wake(void){
+  Woken = 1;
+}
+
+//********SoftTimer_Stats*****************
+// inputs: none
+// outputs: counters of the wheel
+const SoftTimerStats *SoftTimer_Stats(void){
+  return &Stats;
+}
+
+// Run tick Next of the wheel: move down the timers of the higher
+// slots it reaches, highest level first so they can keep moving,
+// then run the tasks of its level 0 slot.  Interrupts are
+// disabled, and enabled while each task runs.
+static long tick(long sr){
+  SoftTimer *t, *list;
+  uint8_t level, slot;
+  for(level=SOFTTIMER_LEVELS-1; level>0; level=level-1){
+    if((Next&(SPAN(level) - 1)) == 0){
+      slot = (Next>>(6*level))&63;
+      list = Slots[level][slot];
+      Slots[level][slot] = 0;
+      Used[level] &= ~(1ULL<<slot);
+      while(list){
+        t = list;
+        list = t->next;
+        insert(t);                      // relative to Next, so a level lower
+        Stats.cascaded = Stats.cascaded + 1;
+      }
+    }
+  }
+  slot = Next&63;
+  Expired = Slots[0][slot];
+  Slots[0][slot] = 0;
+  Used[0] &= ~(1ULL<<slot);
+  for(t=Expired; t; t=t->next){
+    t->level = EXPIRED;
+  }
+  Next = Next + 1;                      // restarted timers go after this tick
+  while(Expired){
+    t = Expired;
+    unlink(t);
+    if(t->period){
+      t->expires = t->expires + t->period;      // no drift
+      insert(t);
+    }
+    Stats.expired = Stats.expired + 1;
+    EndCritical(sr);
+    t->task();
+    sr = StartCritical();
+  }
+  return sr;
+}
+
+// Run every tick with work up to now, jumping over the others,
+// then set TIMER3A for the next one.
+void Timer3A_Handler(void){
+  uint64_t due, now;
+  long sr = StartCritical();
+  TIMER3_ICR_R = TIMER_ICR_TATOCINT;    // acknowledge TIMER3A timeout
+  Stats.interrupts = Stats.interrupts + 1;
+  now = Timebase_Now()/MS;
+  while(Next <= now){
+    due = nextDue();
+    if((due == NONE) || (Next + due > now)){
+      Next = now + 1;                   // nothing left up to now
+      break;
+    }
+    Next = Next + due;
+    sr = tick(sr);
+  }
+  reprogram();
+  EndCritical(sr);
+}
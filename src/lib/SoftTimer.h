@@ -0,0 +1,110 @@
+// SoftTimer.h
+// Runs on LM4F120/TM4C123
+// Any number of one-shot and periodic software timers on TIMER3A.
+// The timers are kept in a hierarchical timing wheel with 1 ms
+// resolution, and TIMER3A runs in one-shot mode, set each time
+// for the next thing the wheel has to do, so there is no
+// interrupt while nothing is due and none at all while no timer
+// runs.  Time is read from the Timebase, which must be started.
+// Chanartip Soonthornwan
+
+// The wheel has SOFTTIMER_LEVELS levels of 64 slots.  A slot of
+// level 0 lasts 1 ms, one of level 1 lasts 64 ms, of level 2
+// 4.096 s and of level 3 262 s.  A timer goes in the slot of the
+// lowest level that reaches its expiry time, at the front of the
+// slot's list, so starting and cancelling take the same few steps
+// however many timers run.  When the wheel reaches a slot of a
+// higher level, its timers are moved down to the level below, and
+// the timers of a level 0 slot expire.  Timers more than 4.6 hours
+// away wait in the last level and are moved when it is reached.
+
+// Tasks run in the TIMER3A interrupt at priority 6, with other
+// interrupts enabled, in the order the timers expire within the
+// same ms.  A task may start or cancel any timer, its own too.
+
+// Tickless idle.  With inputs on interrupts and everything that
+// has to happen later on a soft timer, a main loop that calls
+// SoftTimer_Idle() only wakes for work: no periodic interrupt
+// polls anything.  The sleep is WFI, which keeps the bus clock
+// running, so the Timebase counts through it and needs no
+// correction afterwards.  An interrupt that leaves work for the
+// main loop calls SoftTimer_Wake(), so the loop runs again even
+// if the interrupt came just before it went to sleep.
+
+#ifndef __SOFTTIMER_H__ // do not include more than once
+#define __SOFTTIMER_H__
+#include <stdint.h>
+
+#define SOFTTIMER_LEVELS   4
+
+typedef struct {
+  uint32_t interrupts;                  // TIMER3A interrupts
+  uint32_t expired;                     // tasks run
+  uint32_t cascaded;                    // timers moved to a lower level
+  uint32_t wakeups;                     // sleeps of SoftTimer_Idle() ended
+  uint64_t asleep;                      // bus cycles spent in it
+} SoftTimerStats;
+
+typedef struct SoftTimer {              // owned by SoftTimer.c while running
+  void (*task)(void);
+  uint32_t period;                      // ms, 0 for a one-shot timer
+  uint64_t expires;                     // ms since the Timebase started
+  struct SoftTimer *next, *prev;        // list of the slot
+  uint8_t queued;                       // 1 while running
+  uint8_t level, slot;                  // where it is queued
+} SoftTimer;
+
+//********SoftTimer_Init*****************
+// Set up TIMER3A for the wheel.  Called once after Timebase_Init().
+// inputs: none
+// outputs: none
+void SoftTimer_Init(void);
+
+//********SoftTimer_Start*****************
+// Run a task once after ms milliseconds, and then every period
+// milliseconds if period is not 0.  Restarts the timer if it was
+// running.  Safe to call from any ISR.
+// inputs: t       timer, zero initialized the first time
+//         task    function to run
+//         ms      delay to the first run, at least ms and less
+//                 than ms+1 milliseconds
+//         period  ms between runs, 0 to run once
+// outputs: none
+void SoftTimer_Start(SoftTimer *t, void (*task)(void), uint32_t ms, uint32_t period);
+
+//********SoftTimer_Cancel*****************
+// Stop a timer; its task will not run unless started again.
+// Safe to call from any ISR, and on a timer that is not running.
+// inputs: t  timer
+// outputs: none
+void SoftTimer_Cancel(SoftTimer *t);
+
+//********SoftTimer_Running*****************
+// inputs: t  timer
+// outputs: 1 if the timer is running, 0 if it expired (one-shot)
+//          or was cancelled
+int SoftTimer_Running(SoftTimer *t);
+
+//********SoftTimer_Idle*****************
+// Sleep until an interrupt: an input, or the soft timer due
+// next, unless SoftTimer_Wake() was called since the last return.
+// The interrupt has run when it returns.  Called from the main
+// loop when it has nothing to do.
+// inputs: none
+// outputs: none
+void SoftTimer_Idle(void);
+
+//********SoftTimer_Wake*****************
+// Make the next SoftTimer_Idle() return at once.  Safe to call
+// from any ISR, and usable as the task of a timer that only wakes
+// the main loop.
+// inputs: none
+// outputs: none
+void SoftTimer_Wake(void);
+
+//********SoftTimer_Stats*****************
+// inputs: none
+// outputs: counters of the wheel
+const SoftTimerStats *SoftTimer_Stats(void);
+
+#endif // __SOFTTIMER_H__
@@ -0,0 +1,297 @@
+// TileRender.c
+// Runs on LM4F120/TM4C123
+// Band renderer for the ST7735 160x128 LCD.  A full 16-bit
+// framebuffer would need 40 KB, more than the 32 KB of SRAM, so
+// draw calls for a frame are recorded in a display list and
+// rasterized into one strip of TILE_BAND_H rows at a time.  The
+// strip is composed in RAM and only then sent, so overlapping
+// graphics never flicker.  The screen is split into tiles of
+// TILE_W by TILE_BAND_H pixels; a tile whose draw calls did not
+// change since the last frame is not rasterized or sent.
+// Chanartip Soonthornwan
+
+#include <stdint.h>
+#include "ST7735.h"
+#include "TileRender.h"
+
+// largest screen dimension in any rotation
+#define TILE_SCREEN    160
+#define TILE_COLUMNS   ((TILE_SCREEN + TILE_W - 1)/TILE_W)
+#define TILE_BANDS     ((TILE_SCREEN + TILE_BAND_H - 1)/TILE_BAND_H)
+
+// Display list operations
+#define TILE_RECT      0
+#define TILE_TEXT      1
+#define TILE_IMAGE     2
+
+typedef struct {
+  uint8_t op;                           // one of the TILE_ operations
+  uint8_t size;                         // font scale of a TEXT
+  int16_t x, y;                         // top left corner
+  int16_t w, h;                         // bounding box
+  uint16_t color;                       // fill or text color
+  uint16_t bg;                          // text background color
+  const void *data;                     // string of a TEXT, pixels of an IMAGE
+} TileOp;
+
+static TileOp Ops[TILE_MAX_OPS];
+static uint8_t NumOps;
+static uint16_t Background;
+static uint16_t Band[TILE_SCREEN*TILE_BAND_H];    // strip being composed
+static uint32_t Hash[TILE_BANDS][TILE_COLUMNS];   // signature each tile was sent with
+static uint8_t Valid;                   // 0 until every tile has been sent once
+
+// FNV-1a hash, one 32-bit word at a time
+#define FNV_BASIS      2166136261u
+#define FNV_PRIME      16777619u
+static uint32_t mix(uint32_t hash, uint32_t word){
+  return (hash ^ word)*FNV_PRIME;
+}
+
+// Add an entry to the display list.
+static TileOp *record(uint8_t op, int16_t x, int16_t y, int16_t w, int16_t h){
+  TileOp *p;
+  if((NumOps >= TILE_MAX_OPS) || (w <= 0) || (h <= 0)){
+    return 0;
+  }
+  p = &Ops[NumOps];
+  NumOps = NumOps + 1;
+  p->op = op;
+  p->x = x; p->y = y;
+  p->w = w; p->h = h;
+  p->size = 1;
+  p->color = p->bg = 0;
+  p->data = 0;
+  return p;
+}
+
+//------------Tile_Begin------------
+// Start recording a new frame.
+// Input: background 16-bit color of everything not drawn over
+// Output: none
+void Tile_Begin(uint16_t background){
+  Background = background;
+  NumOps = 0;
+}
+
+//------------Tile_FillRect------------
+// Record a filled rectangle.  Later calls draw on top.
+// Input: x, y  top left corner
+//        w, h  size in pixels
+//        color 16-bit color
+// Output: 1 if recorded, 0 if the display list is full
+int Tile_FillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color){
+  TileOp *p = record(TILE_RECT, x, y, w, h);
+  if(p == 0){
+    return 0;
+  }
+  p->color = color;
+  return 1;
+}
+
+//------------Tile_Text------------
+// Record a line of text in the 5x8 font, 6*size pixels per
+// character.  The string is not copied and must stay valid until
+// Tile_End(); its contents are compared between frames.
+// Input: x, y      top left corner
+//        pt        null terminated string
+//        textColor 16-bit color of the characters
+//        bgColor   16-bit color of the background, same as textColor for transparent
+//        size      number of pixels per font pixel
+// Output: 1 if recorded, 0 if the display list is full
+int Tile_Text(int16_t x, int16_t y, const char *pt, uint16_t textColor, uint16_t bgColor, uint8_t size){
+  TileOp *p;
+  int16_t n = 0;
+  if(size == 0){
+    size = 1;
+  }
+  while(pt[n] && (n < TILE_SCREEN/6)){
+    n = n + 1;
+  }
+  p = record(TILE_TEXT, x, y, 6*size*n, 8*size);
+  if(p == 0){
+    return 0;
+  }
+  p->size = size;
+  p->color = textColor;
+  p->bg = bgColor;
+  p->data = pt;
+  return 1;
+}
+
+//------------Tile_Image------------
+// Record an image stored top row first (the ST7735_DrawBuffer()
+// layout).  The image is not copied and is assumed constant, so
+// only its address is compared between frames.
+// Input: x, y  top left corner
+//        image w*h 16-bit colors
+//        w, h  size in pixels
+// Output: 1 if recorded, 0 if the display list is full
+int Tile_Image(int16_t x, int16_t y, const uint16_t *image, int16_t w, int16_t h){
+  TileOp *p = record(TILE_IMAGE, x, y, w, h);
+  if(p == 0){
+    return 0;
+  }
+  p->data = image;
+  return 1;
+}
+
+//------------Tile_Invalidate------------
+// Force every tile to be sent by the next Tile_End(), e.g.
+// after something else drew on the screen.
+// Input: none
+// Output: none
+void Tile_Invalidate(void){
+  Valid = 0;
+}
+
+// Signature of everything drawn in the tile with corners
+// (x0, y0) and (x1, y1), exclusive.  Two frames with the same
+// signature look the same in that tile.
+static uint32_t signature(int16_t x0, int16_t y0, int16_t x1, int16_t y1){
+  const TileOp *p;
+  const char *s;
+  uint32_t hash = mix(FNV_BASIS, Background);
+  uint8_t i;
+  for(i=0, p=Ops; i<NumOps; i=i+1, p=p+1){
+    if((p->x >= x1) || (p->y >= y1) || (p->x + p->w <= x0) || (p->y + p->h <= y0)){
+      continue;                         // does not touch this tile
+    }
+    hash = mix(hash, p->op | (p->size<<8));
+    hash = mix(hash, (uint16_t)p->x | ((uint32_t)(uint16_t)p->y<<16));
+    hash = mix(hash, (uint16_t)p->w | ((uint32_t)(uint16_t)p->h<<16));
+    hash = mix(hash, p->color | ((uint32_t)p->bg<<16));
+    if(p->op == TILE_TEXT){
+      for(s=p->data; *s; s=s+1){
+        hash = mix(hash, (uint8_t)*s);
+      }
+    } else{
+      hash = mix(hash, (uint32_t)p->data);
+    }
+  }
+  return hash;
+}
+
+// Fill columns [x0, x1) of rows [y0, y1) of the strip, rows
+// counted from the top of the strip.
+static void fillSpan(int16_t x0, int16_t x1, int16_t y0, int16_t y1, int16_t width, uint16_t color){
+  uint16_t *row;
+  int16_t i;
+  for(; y0<y1; y0=y0+1){
+    row = &Band[y0*width];
+    for(i=x0; i<x1; i=i+1){
+      row[i] = color;
+    }
+  }
+}
+
+// Draw one display list entry into the strip, which holds
+// screen rows [top, top+rows) and is width pixels wide.
+static void rasterize(const TileOp *p, int16_t top, int16_t rows, int16_t width){
+  const uint8_t *font;
+  const uint16_t *src;
+  const char *s;
+  uint16_t *dst;
+  int16_t x0, x1, y0, y1, x, y, col;
+  uint8_t line;
+
+  x0 = p->x; x1 = p->x + p->w;          // clip the bounding box to the strip
+  y0 = p->y; y1 = p->y + p->h;
+  if(x0 < 0) x0 = 0;
+  if(x1 > width) x1 = width;
+  if(y0 < top) y0 = top;
+  if(y1 > top + rows) y1 = top + rows;
+  if((x0 >= x1) || (y0 >= y1)){
+    return;
+  }
+  switch(p->op){
+    case TILE_RECT:
+      fillSpan(x0, x1, y0 - top, y1 - top, width, p->color);
+      break;
+    case TILE_IMAGE:
+      src = (const uint16_t *)p->data + (y0 - p->y)*p->w + (x0 - p->x);
+      for(y=y0; y<y1; y=y+1){
+        dst = &Band[(y - top)*width];
+        for(x=x0; x<x1; x=x+1){
+          dst[x] = src[x - x0];
+        }
+        src = src + p->w;
+      }
+      break;
+    case TILE_TEXT:
+      font = ST7735_GetFont();
+      s = p->data;
+      for(y=y0; y<y1; y=y+1){
+        line = (y - p->y)/p->size;      // font row, 0 on top
+        dst = &Band[(y - top)*width];
+        for(x=x0; x<x1; x=x+1){
+          col = (x - p->x)/p->size;     // font column across the string
+          if(((col%6) < 5) && ((font[(uint8_t)s[col/6]*5 + col%6]>>line)&0x01)){
+            dst[x] = p->color;
+          } else if(p->bg != p->color){
+            dst[x] = p->bg;
+          }
+        }
+      }
+      break;
+  }
+}
+
+//------------Tile_End------------
+// Rasterize the recorded frame band by band and send the tiles
+// that changed since the previous frame.
+// Input: none
+// Output: number of tiles sent to the LCD
+uint32_t Tile_End(void){
+  uint8_t changed[TILE_COLUMNS];
+  uint32_t hash, sent = 0;
+  int16_t width = ST7735_GetWidth();
+  int16_t height = ST7735_GetHeight();
+  int16_t top, rows, b, t, t0, x0, x1;
+  uint8_t i, any;
+
+  for(b=0, top=0; top<height; b=b+1, top=top+TILE_BAND_H){
+    rows = height - top;
+    if(rows > TILE_BAND_H){
+      rows = TILE_BAND_H;
+    }
+    // compare the signature of each tile in this band
+    any = 0;
+    for(t=0; t*TILE_W<width; t=t+1){
+      x1 = (t + 1)*TILE_W;
+      if(x1 > width){
+        x1 = width;
+      }
+      hash = signature(t*TILE_W, top, x1, top + rows);
+      changed[t] = (!Valid) || (hash != Hash[b][t]);
+      Hash[b][t] = hash;
+      any = any | changed[t];
+    }
+    if(!any){
+      continue;                         // nothing to draw in this band
+    }
+    // compose the whole band, then send runs of changed tiles
+    fillSpan(0, width, 0, rows, width, Background);
+    for(i=0; i<NumOps; i=i+1){
+      rasterize(&Ops[i], top, rows, width);
+    }
+    for(t=0; t*TILE_W<width; t=t+1){
+      if(!changed[t]){
+        continue;
+      }
+      t0 = t;
+      while(((t + 1)*TILE_W < width) && changed[t + 1]){
+        t = t + 1;
+      }
+      x0 = t0*TILE_W;
+      x1 = (t + 1)*TILE_W;
+      if(x1 > width){
+        x1 = width;
+      }
+      ST7735_DrawBuffer(x0, top, &Band[x0], x1 - x0, rows, width);
+      sent = sent + (t - t0 + 1);
+    }
+  }
+  Valid = 1;
+  return sent;
+}
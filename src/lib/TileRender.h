@@ -0,0 +1,77 @@
+// TileRender.h
+// Runs on LM4F120/TM4C123
+// Band renderer for the ST7735 160x128 LCD.  A full 16-bit
+// framebuffer would need 40 KB, more than the 32 KB of SRAM, so
+// draw calls for a frame are recorded in a display list and
+// rasterized into one strip of TILE_BAND_H rows at a time.  The
+// strip is composed in RAM and only then sent, so overlapping
+// graphics never flicker.  The screen is split into tiles of
+// TILE_W by TILE_BAND_H pixels; a tile whose draw calls did not
+// change since the last frame is not rasterized or sent.
+// Chanartip Soonthornwan
+
+// Typical use, once per frame:
+//    Tile_Begin(ST7735_BLACK);
+//    Tile_FillRect(0, 0, 60, 20, ST7735_BLUE);
+//    Tile_Text(4, 6, "HALLWAY", ST7735_WHITE, ST7735_WHITE, 1);
+//    Tile_End();
+
+#ifndef __TILERENDER_H__ // do not include more than once
+#define __TILERENDER_H__
+#include <stdint.h>
+
+#define TILE_BAND_H    16   // rows in the strip buffer
+#define TILE_W         32   // columns in a tile
+#define TILE_MAX_OPS   64   // draw calls recorded per frame
+
+//------------Tile_Begin------------
+// Start recording a new frame.
+// Input: background 16-bit color of everything not drawn over
+// Output: none
+void Tile_Begin(uint16_t background);
+
+//------------Tile_FillRect------------
+// Record a filled rectangle.  Later calls draw on top.
+// Input: x, y  top left corner
+//        w, h  size in pixels
+//        color 16-bit color
+// Output: 1 if recorded, 0 if the display list is full
+int Tile_FillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+
+//------------Tile_Text------------
+// Record a line of text in the 5x8 font, 6*size pixels per
+// character.  The string is not copied and must stay valid until
+// Tile_End(); its contents are compared between frames.
+// Input: x, y      top left corner
+//        pt        null terminated string
+//        textColor 16-bit color of the characters
+//        bgColor   16-bit color of the background, same as textColor for transparent
+//        size      number of pixels per font pixel
+// Output: 1 if recorded, 0 if the display list is full
+int Tile_Text(int16_t x, int16_t y, const char *pt, uint16_t textColor, uint16_t bgColor, uint8_t size);
+
+//------------Tile_Image------------
+// Record an image stored top row first (the ST7735_DrawBuffer()
+// layout).  The image is not copied and is assumed constant, so
+// only its address is compared between frames.
+// Input: x, y  top left corner
+//        image w*h 16-bit colors
+//        w, h  size in pixels
+// Output: 1 if recorded, 0 if the display list is full
+int Tile_Image(int16_t x, int16_t y, const uint16_t *image, int16_t w, int16_t h);
+
+//------------Tile_End------------
+// Rasterize the recorded frame band by band and send the tiles
+// that changed since the previous frame.
+// Input: none
+// Output: number of tiles sent to the LCD
+uint32_t Tile_End(void);
+
+//------------Tile_Invalidate------------
+// Force every tile to be sent by the next Tile_End(), e.g.
+// after something else drew on the screen.
+// Input: none
+// Output: none
+void Tile_Invalidate(void);
+
+#endif // __TILERENDER_H__
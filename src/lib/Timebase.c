@@ -0,0 +1,112 @@
+// Timebase.c
+// Runs on LM4F120/TM4C123
+// System timebase on WTIMER0.  The two halves of Wide Timer 0 are
+// concatenated into one 64-bit counter that counts up at the bus
+// clock and never wraps in practice (11,000 years at 50 MHz).
+// Delays are computed from BUS_CLOCK in PLL.h, so they stay exact
+// when SYSDIV2 changes, and sleep with WFI until a match
+// interrupt instead of spinning.
+// Chanartip Soonthornwan
+
+#include <stdint.h>
+#include "tm4c123gh6pm.h"
+#include "Timebase.h"
+
+long StartCritical(void);    // previous I bit, disable interrupts
+void EndCritical(long sr);   // restore I bit to previous value
+void WaitForInterrupt(void); // low power mode
+
+// Delays shorter than this spin, sleeping would take longer
+#define MIN_SLEEP  TIMEBASE_US(2)
+
+static uint8_t Started;      // 1 once the counter is running
+
+//********Timebase_Init*****************
+// Start the free running 64-bit counter at zero.  Called by
+// main after PLL_Init(); the delay functions also call it if
+// the counter has not been started.
+// inputs: none
+// outputs: none
+void Timebase_Init(void){
+  SYSCTL_RCGCWTIMER_R |= 0x01;           // 0) activate WTIMER0
+  while((SYSCTL_PRWTIMER_R&0x01) == 0){};// allow time for clock to start
+  WTIMER0_CTL_R = 0x00000000;            // 1) disable WTIMER0 during setup
+  WTIMER0_CFG_R = 0x00000000;            // 2) concatenated 64-bit mode
+                                         // 3) periodic, count up, match interrupt
+  WTIMER0_TAMR_R = TIMER_TAMR_TAMR_PERIOD|TIMER_TAMR_TACDIR|TIMER_TAMR_TAMIE;
+  WTIMER0_TAILR_R = 0xFFFFFFFF;          // 4) count all 64 bits
+  WTIMER0_TBILR_R = 0xFFFFFFFF;
+  WTIMER0_TAPR_R = 0;                    // 5) bus clock resolution
+  WTIMER0_IMR_R = 0x00000000;            // 6) match interrupt armed by the delays
+  WTIMER0_ICR_R = TIMER_ICR_TAMCINT;
+  NVIC_PRI23_R = (NVIC_PRI23_R&0xFF1FFFFF)|0x00E00000; // 7) priority 7
+// vector number 110, interrupt number 94
+  NVIC_EN2_R = 1<<(94-64);               // 8) enable IRQ 94 in NVIC
+  WTIMER0_CTL_R = TIMER_CTL_TAEN;        // 9) start counting from 0
+  Started = 1;
+}
+
+//********Timebase_Now*****************
+// Read the counter.  Safe to call from any ISR.
+// inputs: none
+// outputs: bus clock cycles since Timebase_Init()
+uint64_t Timebase_Now(void){
+  uint32_t hi, lo;
+  do{                                    // read again if the low half wrapped
+    hi = WTIMER0_TBV_R;
+    lo = WTIMER0_TAV_R;
+  } while(hi != WTIMER0_TBV_R);
+  return ((uint64_t)hi<<32) | lo;
+}
+
+// Wait until the counter reaches the given number of ticks from now
+static void delayTicks(uint64_t ticks){
+  uint64_t end;
+  long sr;
+  if(!Started){
+    Timebase_Init();
+  }
+  end = Timebase_Now() + ticks;
+  if((ticks < MIN_SLEEP) || (NVIC_INT_CTRL_R&NVIC_INT_CTRL_VEC_ACT_M)){
+    // short, or in an ISR where the match interrupt may not be able to wake us
+    while(Timebase_Now() < end){};
+    return;
+  }
+  WTIMER0_TAMATCHR_R = (uint32_t)end;
+  WTIMER0_TBMATCHR_R = (uint32_t)(end>>32);
+  WTIMER0_ICR_R = TIMER_ICR_TAMCINT;
+  WTIMER0_IMR_R |= TIMER_IMR_TAMIM;
+  // check and sleep with interrupts disabled, so a match just
+  // after the check still ends the WFI
+  sr = StartCritical();
+  while(Timebase_Now() < end){
+    WaitForInterrupt();
+    EndCritical(sr);                     // let the pending ISR run
+    sr = StartCritical();
+  }
+  EndCritical(sr);
+  WTIMER0_IMR_R &= ~TIMER_IMR_TAMIM;
+}
+
+//********Delay_us*****************
+// Wait at least us microseconds.  Sleeps until the WTIMER0 match
+// interrupt when called from main; spins on the counter when
+// called from an ISR or for very short delays.
+// inputs: us  number of microseconds
+// outputs: none
+void Delay_us(uint32_t us){
+  delayTicks(TIMEBASE_US(us));
+}
+
+//********Delay_ms*****************
+// Wait at least ms milliseconds, same as Delay_us().
+// inputs: ms  number of milliseconds
+// outputs: none
+void Delay_ms(uint32_t ms){
+  delayTicks(TIMEBASE_MS(ms));
+}
+
+// The match only has to wake the core from WFI
+void WideTimer0A_Handler(void){
+  WTIMER0_ICR_R = TIMER_ICR_TAMCINT;     // acknowledge WTIMER0A match
+}
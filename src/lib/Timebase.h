@@ -0,0 +1,48 @@
+// Timebase.h
+// Runs on LM4F120/TM4C123
+// System timebase on WTIMER0.  The two halves of Wide Timer 0 are
+// concatenated into one 64-bit counter that counts up at the bus
+// clock and never wraps in practice (11,000 years at 50 MHz).
+// Delays are computed from BUS_CLOCK in PLL.h, so they stay exact
+// when SYSDIV2 changes, and sleep with WFI until a match
+// interrupt instead of spinning.
+// Chanartip Soonthornwan
+
+#ifndef __TIMEBASE_H__ // do not include more than once
+#define __TIMEBASE_H__
+#include <stdint.h>
+#include "PLL.h"
+
+// Conversions between time and timebase ticks
+#define TIMEBASE_US(us)   ((uint64_t)(us)*(BUS_CLOCK/1000000))
+#define TIMEBASE_MS(ms)   ((uint64_t)(ms)*(BUS_CLOCK/1000))
+
+//********Timebase_Init*****************
+// Start the free running 64-bit counter at zero.  Called by
+// main after PLL_Init(); the delay functions also call it if
+// the counter has not been started.
+// inputs: none
+// outputs: none
+void Timebase_Init(void);
+
+//********Timebase_Now*****************
+// Read the counter.  Safe to call from any ISR.
+// inputs: none
+// outputs: bus clock cycles since Timebase_Init()
+uint64_t Timebase_Now(void);
+
+//********Delay_us*****************
+// Wait at least us microseconds.  Sleeps until the WTIMER0 match
+// interrupt when called from main; spins on the counter when
+// called from an ISR or for very short delays.
+// inputs: us  number of microseconds
+// outputs: none
+void Delay_us(uint32_t us);
+
+//********Delay_ms*****************
+// Wait at least ms milliseconds, same as Delay_us().
+// inputs: ms  number of milliseconds
+// outputs: none
+void Delay_ms(uint32_t ms);
+
+#endif // __TIMEBASE_H__
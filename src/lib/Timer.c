@@ -25,6 +25,7 @@
 
 void (*PeriodicTask0)(void);   // user function
 void (*PeriodicTask1)(void);   // user function
+void (*OneShotTask2)(void);    // user function
 
 // ***************** Timer0_Init ****************
 // Activate TIMER0 interrupts to run user task periodically
@@ -75,4 +76,28 @@ void Timer1A_Handler(void){
   (*PeriodicTask1)();                // execute user task
 }
 
+// ***************** Timer2_OneShot ****************
+// Activate TIMER2 to run user task once after a delay
+// Inputs:  task is a pointer to a user function
+//          delay in units (1/clockfreq)
+// Outputs: none
+void Timer2_OneShot(void(*task)(void), unsigned long delay){
+  SYSCTL_RCGCTIMER_R |= 0x04;   // 0) activate TIMER2
+  OneShotTask2 = task;           // user function
+  TIMER2_CTL_R = 0x00000000;    // 1) disable TIMER2A during setup
+  TIMER2_CFG_R = 0x00000000;    // 2) configure for 32-bit mode
+  TIMER2_TAMR_R = 0x00000001;   // 3) configure for one-shot mode, default down-count settings
+  TIMER2_TAILR_R = delay-1;     // 4) reload value
+  TIMER2_TAPR_R = 0;            // 5) bus clock resolution
+  TIMER2_ICR_R = 0x00000001;    // 6) clear TIMER2A timeout flag
+  TIMER2_IMR_R = 0x00000001;    // 7) arm timeout interrupt
+  NVIC_PRI5_R = (NVIC_PRI5_R&0x00FFFFFF)|0xE0000000; // 8) priority 7
+// vector number 39, interrupt number 23
+  NVIC_EN0_R = 1<<23;           // 9) enable IRQ 23 in NVIC
+  TIMER2_CTL_R = 0x00000001;    // 10) enable TIMER2A, stops by itself after one timeout
+}
 
+void Timer2A_Handler(void){
+  TIMER2_ICR_R = TIMER_ICR_TATOCINT;// acknowledge TIMER2A timeout
+  (*OneShotTask2)();                 // execute user task
+}
@@ -44,3 +44,18 @@ void Timer0_Init(void(*task)(void), unsigned long period);
 void Timer1_Init(void(*task)(void), unsigned long period);
 
 #endif // __TIMER2INTS_H__
+
+#ifndef __TIMER2INTS_H__ // do not include more than once
+#define __TIMER2INTS_H__
+
+// ***************** Timer2_OneShot ****************
+// Activate Timer2 to run user task once after a delay.  Calling
+// it again, even from the task, restarts Timer2 with the new
+// task and delay.  The task runs at priority 7, below every
+// other interrupt, so it may take a long time.
+// Inputs:  task is a pointer to a user function
+//          delay in units (1/clockfreq)
+// Outputs: none
+void Timer2_OneShot(void(*task)(void), unsigned long delay);
+
+#endif // __TIMER2INTS_H__
@@ -297,3 +297,28 @@ unsigned char UART1_NonBlockingInChar(void)
     return 0;
   }
 }
+
+void (*RxTask1)(unsigned char);   // user function
+
+//------------UART1_RxTask------------
+// Run a task from the UART1 interrupt (priority 6) with each
+// character received, instead of polling.  A single character
+// is seen at the receive timeout, 32 bit times after it.
+// Input: task is a pointer to a user function
+// Output: none
+void UART1_RxTask(void(*task)(unsigned char)){
+  RxTask1 = task;
+  UART1_IFLS_R = (UART1_IFLS_R&~UART_IFLS_RX_M)|UART_IFLS_RX1_8;
+  UART1_ICR_R = UART_ICR_RXIC|UART_ICR_RTIC;
+  UART1_IM_R |= UART_IM_RXIM|UART_IM_RTIM;  // arm receive and receive timeout
+  NVIC_PRI1_R = (NVIC_PRI1_R&0xFF00FFFF)|0x00C00000; // priority 6
+// vector number 22, interrupt number 6
+  NVIC_EN0_R = 1<<6;                // enable IRQ 6 in NVIC
+}
+
+void UART1_Handler(void){
+  UART1_ICR_R = UART_ICR_RXIC|UART_ICR_RTIC; // acknowledge
+  while((UART1_FR_R&UART_FR_RXFE) == 0){
+    (*RxTask1)((unsigned char)(UART1_DR_R&0xFF));
+  }
+}
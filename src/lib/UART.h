@@ -102,3 +102,11 @@ void UART1_InString(char *bufPt, unsigned short max);
 // Output: ASCII code for key typed or 0 if no character
 unsigned char UART0_NonBlockingInChar(void);
 unsigned char UART1_NonBlockingInChar(void);
+
+//------------UART1_RxTask------------
+// Run a task from the UART1 interrupt (priority 6) with each
+// character received, instead of polling.  A single character
+// is seen at the receive timeout, 32 bit times after it.
+// Input: task is a pointer to a user function
+// Output: none
+void UART1_RxTask(void(*task)(unsigned char));
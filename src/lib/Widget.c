@@ -0,0 +1,147 @@
+// Widget.c
+// Runs on LM4F120/TM4C123
+// Retained-mode status widgets drawn through Display.h, on the
+// Nokia5110 48x84 LCD or any other display backend.  Widgets
+// are placed on the text cell grid, bound to a state word, and
+// repainted only when the bound value changes.
+// Chanartip Soonthornwan
+
+#include "Display.h"
+#include "Widget.h"
+
+static const Display *Screen;           // display from Widget_Init()
+static const WidgetPage *Pages;         // page table from Widget_Init()
+static unsigned char NumPages;
+static unsigned char Page;              // page currently on the screen
+static volatile unsigned char NextPage; // page requested by Widget_SelectPage()
+static unsigned char Valid;             // 0 until the current page is drawn
+static unsigned int Last[WIDGET_MAX];   // value each widget was drawn with
+
+//********Widget_Init*****************
+// Set the display and the pages to be displayed and select
+// page 0.  Nothing is drawn until the next call to Widget_Update().
+// inputs: display  display backend, e.g. &Display_Nokia5110
+//         pages    array of pages
+//         count    number of pages
+// outputs: none
+// assumes: the display has been initialized
+void Widget_Init(const Display *display, const WidgetPage *pages, unsigned char count){
+  Screen = display;
+  Pages = pages;
+  NumPages = count;
+  Page = NextPage = 0;
+  Valid = 0;
+}
+
+//********Widget_SelectPage*****************
+// Request a page change.  Safe to call from an ISR, the page
+// is cleared and redrawn at the next Widget_Update().
+// inputs: page  page number, ignored if out of range
+// outputs: none
+void Widget_SelectPage(unsigned char page){
+  if(page < NumPages){
+    NextPage = page;
+  }
+}
+
+//********Widget_NextPage*****************
+// Request the next page, wrapping back to page 0.
+// inputs: none
+// outputs: none
+void Widget_NextPage(void){
+  if(NumPages == 0){
+    return;
+  }
+  NextPage = (NextPage + 1)%NumPages;
+}
+
+// Output n right justified in a field of width characters.
+// Digits that do not fit are dropped from the left.
+static void outUDec(unsigned char x, unsigned char y, unsigned int n, unsigned char width){
+  char buf[13];
+  int i = 12;
+  buf[12] = 0;
+  do{
+    buf[--i] = n%10 + '0';
+    n = n/10;
+  } while(n && (i > 0));
+  while(i > 12 - width){
+    buf[--i] = ' ';
+  }
+  Display_Text(Screen, x, y, &buf[12 - width], DISPLAY_WHITE, DISPLAY_BLACK);
+}
+
+// Bar gauge over width cells, framed top and bottom on the
+// second and seventh pixel rows of the cell, closed on both
+// ends, and solid for the first filled columns.
+static void outBar(unsigned char x, unsigned char y, unsigned char width, unsigned int filled){
+  int16_t left = x*Screen->cellW;
+  int16_t top = y*Screen->cellH;
+  int16_t columns = width*Screen->cellW;
+  Display_FillRect(Screen, left, top, columns, Screen->cellH, DISPLAY_BLACK);
+  Display_FillRect(Screen, left, top + 1, columns, 1, DISPLAY_WHITE);
+  Display_FillRect(Screen, left, top + 6, columns, 1, DISPLAY_WHITE);
+  Display_FillRect(Screen, left, top + 1, (filled > 1) ? filled : 1, 6, DISPLAY_WHITE);
+  Display_FillRect(Screen, left + columns - 1, top + 1, 1, 6, DISPLAY_WHITE);
+}
+
+// Draw one widget at its position using value.
+static void draw(const Widget *w, unsigned int value){
+  switch(w->type){
+    case WIDGET_LABEL:
+      Display_Text(Screen, w->x, w->y, w->text, DISPLAY_WHITE, DISPLAY_BLACK);
+      break;
+    case WIDGET_ONOFF:
+      Display_Text(Screen, w->x, w->y, value ? " ON" : "OFF", DISPLAY_WHITE, DISPLAY_BLACK);
+      break;
+    case WIDGET_UDEC:
+      outUDec(w->x, w->y, value, w->width);
+      break;
+    case WIDGET_BAR:
+      if(value > w->max){
+        value = w->max;
+      }
+      outBar(w->x, w->y, w->width, w->max ? (value*w->width*Screen->cellW)/w->max : 0);
+      break;
+  }
+}
+
+//********Widget_Update*****************
+// Repaint the widgets of the current page whose bound value
+// changed since they were last drawn, then flush the display.
+// After a page change the screen is cleared and every widget
+// is drawn.
+// inputs: none
+// outputs: none
+void Widget_Update(void){
+  const Widget *w;
+  unsigned int value;
+  unsigned char i;
+
+  if(NumPages == 0){
+    return;
+  }
+  if(NextPage != Page){
+    Page = NextPage;
+    Valid = 0;
+  }
+  if(!Valid){
+    Display_Clear(Screen);
+  }
+  w = Pages[Page].widgets;
+  for(i=0; i<Pages[Page].count; i=i+1, w=w+1){
+    value = 0;
+    if(w->state){
+      value = *w->state;
+      if(w->mask){
+        value &= w->mask;
+      }
+    }
+    if(!Valid || (w->type != WIDGET_LABEL && value != Last[i])){
+      draw(w, value);
+      Last[i] = value;
+    }
+  }
+  Valid = 1;
+  Display_Flush(Screen);
+}
@@ -0,0 +1,70 @@
+// Widget.h
+// Runs on LM4F120/TM4C123
+// Retained-mode status widgets drawn through Display.h, on the
+// Nokia5110 48x84 LCD or any other display backend.  Widgets
+// are placed on the text cell grid, bound to a state word, and
+// repainted only when the bound value changes.
+// Chanartip Soonthornwan
+
+#ifndef __WIDGET_H__ // do not include more than once
+#define __WIDGET_H__
+#include "Display.h"
+
+// Widget types
+#define WIDGET_LABEL   0    // fixed text, drawn once per page
+#define WIDGET_ONOFF   1    // " ON" or "OFF" from (*state & mask)
+#define WIDGET_UDEC    2    // *state in unsigned decimal, right justified
+#define WIDGET_BAR     3    // *state scaled against max as a bar gauge
+
+// Maximum number of widgets on one page
+#define WIDGET_MAX     12
+
+typedef struct {
+  unsigned char type;                   // one of the WIDGET_ types
+  unsigned char x;                      // column of the first cell (0 to 11 on the Nokia5110)
+  unsigned char y;                      // row (0 to 5 on the Nokia5110)
+  unsigned char width;                  // number of cells used
+  const char *text;                     // text of a LABEL, unused otherwise
+  const volatile unsigned int *state;   // bound state word
+  unsigned int mask;                    // bits of *state used, 0 for all
+  unsigned int max;                     // full scale value of a BAR
+} Widget;
+
+typedef struct {
+  const Widget *widgets;                // widgets on this page
+  unsigned char count;                  // number of widgets (<= WIDGET_MAX)
+} WidgetPage;
+
+//********Widget_Init*****************
+// Set the display and the pages to be displayed and select
+// page 0.  Nothing is drawn until the next call to Widget_Update().
+// inputs: display  display backend, e.g. &Display_Nokia5110
+//         pages    array of pages
+//         count    number of pages
+// outputs: none
+// assumes: the display has been initialized
+void Widget_Init(const Display *display, const WidgetPage *pages, unsigned char count);
+
+//********Widget_SelectPage*****************
+// Request a page change.  Safe to call from an ISR, the page
+// is cleared and redrawn at the next Widget_Update().
+// inputs: page  page number, ignored if out of range
+// outputs: none
+void Widget_SelectPage(unsigned char page);
+
+//********Widget_NextPage*****************
+// Request the next page, wrapping back to page 0.
+// inputs: none
+// outputs: none
+void Widget_NextPage(void);
+
+//********Widget_Update*****************
+// Repaint the widgets of the current page whose bound value
+// changed since they were last drawn, then flush the display.
+// After a page change the screen is cleared and every widget
+// is drawn.
+// inputs: none
+// outputs: none
+void Widget_Update(void);
+
+#endif // __WIDGET_H__
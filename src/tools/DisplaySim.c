@@ -0,0 +1,350 @@
+// DisplaySim.c
+// Runs on a PC (any C99 compiler)
+// Runs the status pages of the Master through Widget.c on each
+// display backend: the RAM framebuffer, the Nokia5110 against a
+// model of the PCD8544 and the ST7735 against a model of its
+// column, row and RAM write commands.  After every update the
+// picture must be the same as a full redraw of the same state
+// (with the whole Nokia5110 buffer sent), so a widget that is
+// not repainted, or a flush that leaves out part of what
+// changed, is caught.  Then counts, with
+// DISPLAY_STATS, what 400 updates cost on each backend, redrawn
+// only where the values changed and redrawn in full every time.
+// Prints each check and exits with 1 if one fails.
+// Chanartip Soonthornwan
+
+// Usage:
+//    gcc -O2 -DDISPLAY_STATS -DNOKIA5110_SIMULATE -DST7735_SIMULATE -I../lib
+//        -o DisplaySim DisplaySim.c ../lib/Widget.c ../lib/Display.c
+//        ../lib/DisplayMemory.c ../lib/DisplayNokia.c ../lib/DisplayST7735.c
+//        ../lib/Nokia5110.c ../lib/ST7735.c
+//    DisplaySim
+// The host time is only there to compare the backends with each
+// other; the bus time is the SSI bytes at each LCD's SSIClk.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "Display.h"
+#include "Widget.h"
+#include "Nokia5110.h"
+#include "ST7735.h"
+#include "SSI.h"
+
+#define UPDATES     400
+#define NOKIA_CLK   (50000000.0/16)     // SSIClk of each LCD, bus clock/CPSDVSR
+#define ST7735_CLK  (50000000.0/10)
+
+// Master's pages, with its device flags
+#define DESK1    0x0002
+#define DESK2    0x0004
+#define LAMP     0x0008
+#define POLE     0x0010
+#define DESK3    0x0020
+#define RELAY3   0x0040
+#define RELAY4   0x0080
+#define FAN      0x0100
+#define HALLWAY  0x0200
+#define BATHROOM 0x0400
+#define BRIGHT_MAX 255
+static volatile unsigned int Device, Hallway, Bathroom;
+
+static const Widget StatusPage[] = {
+  {WIDGET_LABEL, 0, 0, 12, "___MASTER___", 0, 0, 0},
+  {WIDGET_LABEL, 0, 1,  9, "HALLWAY:",     0, 0, 0},
+  {WIDGET_ONOFF, 9, 1,  3, 0, &Device, HALLWAY,  0},
+  {WIDGET_LABEL, 0, 2,  9, "BATHROOM:",    0, 0, 0},
+  {WIDGET_ONOFF, 9, 2,  3, 0, &Device, BATHROOM, 0},
+  {WIDGET_LABEL, 0, 3,  9, "LAMP:",        0, 0, 0},
+  {WIDGET_ONOFF, 9, 3,  3, 0, &Device, LAMP,     0},
+  {WIDGET_LABEL, 0, 4,  9, "POLE:",        0, 0, 0},
+  {WIDGET_ONOFF, 9, 4,  3, 0, &Device, POLE,     0},
+  {WIDGET_LABEL, 0, 5,  9, "FAN:",         0, 0, 0},
+  {WIDGET_ONOFF, 9, 5,  3, 0, &Device, FAN,      0},
+};
+static const Widget DevicePage[] = {
+  {WIDGET_LABEL, 0, 0, 12, "__DEVICES___", 0, 0, 0},
+  {WIDGET_LABEL, 0, 1,  9, "DESK1:",       0, 0, 0},
+  {WIDGET_ONOFF, 9, 1,  3, 0, &Device, DESK1,  0},
+  {WIDGET_LABEL, 0, 2,  9, "DESK2:",       0, 0, 0},
+  {WIDGET_ONOFF, 9, 2,  3, 0, &Device, DESK2,  0},
+  {WIDGET_LABEL, 0, 3,  9, "DESK3:",       0, 0, 0},
+  {WIDGET_ONOFF, 9, 3,  3, 0, &Device, DESK3,  0},
+  {WIDGET_LABEL, 0, 4,  9, "RELAY3:",      0, 0, 0},
+  {WIDGET_ONOFF, 9, 4,  3, 0, &Device, RELAY3, 0},
+  {WIDGET_LABEL, 0, 5,  9, "RELAY4:",      0, 0, 0},
+  {WIDGET_ONOFF, 9, 5,  3, 0, &Device, RELAY4, 0},
+};
+static const Widget BrightPage[] = {
+  {WIDGET_LABEL, 0, 0, 12, "_BRIGHTNESS_", 0, 0, 0},
+  {WIDGET_LABEL, 0, 1,  9, "HALLWAY:",     0, 0, 0},
+  {WIDGET_ONOFF, 9, 1,  3, 0, &Device, HALLWAY,  0},
+  {WIDGET_BAR,   0, 2, 12, 0, &Hallway,  0, BRIGHT_MAX},
+  {WIDGET_LABEL, 0, 3,  9, "BATHROOM:",    0, 0, 0},
+  {WIDGET_ONOFF, 9, 3,  3, 0, &Device, BATHROOM, 0},
+  {WIDGET_BAR,   0, 4, 12, 0, &Bathroom, 0, BRIGHT_MAX},
+  {WIDGET_UDEC,  9, 5,  3, 0, &Bathroom, 0, 0},
+};
+static const WidgetPage Pages[] = {
+  {StatusPage, sizeof(StatusPage)/sizeof(Widget)},
+  {DevicePage, sizeof(DevicePage)/sizeof(Widget)},
+  {BrightPage, sizeof(BrightPage)/sizeof(Widget)},
+};
+#define NUM_PAGES (sizeof(Pages)/sizeof(WidgetPage))
+
+static int Failures;
+static uint32_t Seed;
+static uint32_t Bytes;                  // SSI bytes counted by the drivers
+
+static void check(int ok, const char *what){
+  printf("%-52s %s\n", what, ok ? "ok" : "FAILED");
+  if(!ok){
+    Failures = Failures + 1;
+  }
+}
+
+static uint32_t rnd(uint32_t n){
+  Seed = Seed*1664525 + 1013904223;
+  return (Seed>>8)%n;
+}
+
+// Model of the PCD8544: X and Y address commands, then data
+// bytes written across the bank and on into the next one
+static unsigned char LcdRam[MAX_Y/8][MAX_X];
+static int LcdX, LcdY;
+
+void Nokia5110_SimByte(unsigned char message, unsigned char data){
+  if(!data){
+    if(message&0x80){
+      LcdX = (message&0x7F)%MAX_X;
+    } else if(message&0x40){
+      LcdY = (message&0x07)%(MAX_Y/8);
+    }
+    return;
+  }
+  LcdRam[LcdY][LcdX] = message;
+  LcdX = LcdX + 1;
+  if(LcdX == MAX_X){
+    LcdX = 0;
+    LcdY = (LcdY + 1)%(MAX_Y/8);
+  }
+}
+
+// Model of the ST7735 RAM write commands
+#define CASET  0x2A
+#define RASET  0x2B
+#define RAMWR  0x2C
+#define RAM_W  132                      // ST7735 frame memory
+#define RAM_H  162
+static uint16_t TftRam[RAM_H][RAM_W];
+static uint8_t Cmd;
+static uint8_t Arg[4];
+static int Args;
+static int Col0, Col1, Row0, Row1, Col, Row;    // window, next pixel
+static int HalfPixel;                   // first byte of an 8-bit pixel, -1 if none
+
+static void pixel(uint16_t color){
+  if((Col < RAM_W) && (Row < RAM_H)){
+    TftRam[Row][Col] = color;
+  }
+  Col = Col + 1;
+  if(Col > Col1){
+    Col = Col0;
+    Row = Row + 1;
+    if(Row > Row1){
+      Row = Row0;
+    }
+  }
+}
+
+void ST7735_SimFrame(uint16_t frame, uint8_t bits, uint8_t data){
+  if(!data){
+    Cmd = (uint8_t)frame;
+    Args = 0;
+    HalfPixel = -1;
+    if(Cmd == RAMWR){
+      Col = Col0;
+      Row = Row0;
+    }
+    return;
+  }
+  if(Cmd == RAMWR){
+    if(bits == 16){
+      pixel(frame);
+    } else if(HalfPixel < 0){
+      HalfPixel = frame&0xFF;
+    } else{
+      pixel((HalfPixel<<8)|(frame&0xFF));
+      HalfPixel = -1;
+    }
+  } else if(((Cmd == CASET) || (Cmd == RASET)) && (Args < 4)){
+    Arg[Args] = (uint8_t)frame;
+    Args = Args + 1;
+    if(Args == 4){
+      if(Cmd == CASET){
+        Col0 = (Arg[0]<<8)|Arg[1];  Col1 = (Arg[2]<<8)|Arg[3];
+      } else{
+        Row0 = (Arg[0]<<8)|Arg[1];  Row1 = (Arg[2]<<8)|Arg[3];
+      }
+    }
+  }
+}
+
+int SSI_Select(SSIDevice *dev){ (void)dev; return 0; }
+void SSI_Register(SSIDevice *dev){ (void)dev; }
+void SSI_Count(SSIDevice *dev, uint32_t n){ (void)dev; Bytes = Bytes + n; }
+void Delay_us(uint32_t us){ (void)us; }
+void Delay_ms(uint32_t ms){ (void)ms; }
+void Timer2_OneShot(void(*task)(void), unsigned long delay){ (void)task; (void)delay; }
+
+// DISPLAY_STATS times the backends with this, in ns on the PC
+uint64_t Timebase_Now(void){
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t)t.tv_sec*1000000000u + t.tv_nsec;
+}
+
+// What each backend shows, as a copy that can be compared
+static uint16_t MemPicture[2][DISPLAY_MEM_H][DISPLAY_MEM_W];
+static unsigned char LcdPicture[2][MAX_Y/8][MAX_X];
+static uint16_t TftPicture[2][RAM_H][RAM_W];
+
+static void snap(const Display *d, int k){
+  int16_t x, y;
+  if(d == &Display_Memory){
+    for(y=0; y<DISPLAY_MEM_H; y=y+1){
+      for(x=0; x<DISPLAY_MEM_W; x=x+1){
+        MemPicture[k][y][x] = Display_MemoryPixel(x, y);
+      }
+    }
+  } else if(d == &Display_Nokia5110){
+    memcpy(LcdPicture[k], LcdRam, sizeof(LcdRam));
+  } else{
+    memcpy(TftPicture[k], TftRam, sizeof(TftRam));
+  }
+}
+
+static int same(const Display *d){
+  if(d == &Display_Memory){
+    return memcmp(MemPicture[0], MemPicture[1], sizeof(MemPicture[0])) == 0;
+  } else if(d == &Display_Nokia5110){
+    return memcmp(LcdPicture[0], LcdPicture[1], sizeof(LcdPicture[0])) == 0;
+  }
+  return memcmp(TftPicture[0], TftPicture[1], sizeof(TftPicture[0])) == 0;
+}
+
+// One step of the script: a device switched, a level moved, or
+// the page changed, as the keypad and the Slave would do
+static unsigned char Page;
+static void step(void){
+  uint32_t r = rnd(20);
+  if(r < 10){
+    Device = Device^(0x0002<<rnd(10));
+  } else if(r < 18){
+    if(rnd(2)){
+      Hallway = rnd(BRIGHT_MAX + 1);
+    } else{
+      Bathroom = rnd(BRIGHT_MAX + 1);
+    }
+  } else{
+    Page = (Page + 1)%NUM_PAGES;
+    Widget_SelectPage(Page);
+  }
+}
+
+// Start the script over on display d
+static void start(const Display *d){
+  Seed = 12345;
+  Device = Hallway = Bathroom = 0;
+  Page = 0;
+  Widget_Init(d, Pages, NUM_PAGES);
+  Widget_Update();
+}
+
+// Forget what is on the screen, so the next Widget_Update()
+// clears it and draws every widget of the page
+static void forget(const Display *d){
+  Widget_Init(d, Pages, NUM_PAGES);
+  Widget_SelectPage(Page);
+}
+
+// 1 if every update of the script draws what a full redraw does;
+// on the Nokia5110 the full redraw sends the whole buffer
+static int incremental(const Display *d){
+  int i, ok = 1;
+  start(d);
+  for(i=0; (i<UPDATES) && ok; i=i+1){
+    step();
+    Widget_Update();
+    snap(d, 0);
+    forget(d);
+    Widget_Update();
+    if(d == &Display_Nokia5110){
+      Nokia5110_DisplayBuffer();        // all of the buffer, not just what the flush sent
+    }
+    snap(d, 1);
+    ok = same(d);
+  }
+  return ok;
+}
+
+// Run the script, redrawing everything each time if full, and
+// print what the updates cost
+static void cost(const Display *d, int full, double clk){
+  DisplayStats *s = d->stats;
+  uint32_t bytes;
+  int i;
+  start(d);
+  memset(s, 0, sizeof(*s));
+  Bytes = 0;
+  for(i=0; i<UPDATES; i=i+1){
+    step();
+    if(full){
+      forget(d);
+    }
+    Widget_Update();
+  }
+  bytes = Bytes;
+  printf("%-10s %-8s", full ? "" : d->name, full ? "full" : "changes");
+  printf(" %8.1f %9.0f %9.0f", (double)s->calls/UPDATES, (double)s->pixels/UPDATES,
+         (double)s->cycles/UPDATES);
+  if(clk > 0){
+    printf(" %9.1f %9.2f\n", (double)bytes/UPDATES, bytes*8.0/clk/UPDATES*1e3);
+  } else{
+    printf(" %9s %9s\n", "-", "-");
+  }
+}
+
+int main(void){
+  int ok;
+  uint16_t x, y;
+
+  ST7735_InitR(INITR_REDTAB);
+  check(incremental(&Display_Memory), "Memory, 400 updates same as a full redraw");
+  check(incremental(&Display_Nokia5110), "Nokia5110, 400 updates same as a full redraw");
+  check(incremental(&Display_ST7735), "ST7735, 400 updates same as a full redraw");
+
+  start(&Display_Memory);               // the same text on both 16 bpp backends
+  start(&Display_ST7735);
+  snap(&Display_Memory, 0);
+  ok = 1;
+  for(y=0; y<6*8; y=y+1){
+    for(x=0; x<12*6; x=x+1){
+      if(MemPicture[0][y][x] != TftRam[y][x]) ok = 0;
+    }
+  }
+  check(ok, "Memory and ST7735 draw the same status page");
+
+  printf("\n%-10s %-8s %8s %9s %9s %9s %9s\n", "", "redraw", "calls", "pixels", "host ns", "SSI", "bus ms");
+  printf("%-10s %-8s %8s %9s %9s %9s %9s\n", "backend", "", "/update", "/update", "/update", "bytes", "/update");
+  cost(&Display_Memory, 0, 0);
+  cost(&Display_Memory, 1, 0);
+  cost(&Display_Nokia5110, 0, NOKIA_CLK);
+  cost(&Display_Nokia5110, 1, NOKIA_CLK);
+  cost(&Display_ST7735, 0, ST7735_CLK);
+  cost(&Display_ST7735, 1, ST7735_CLK);
+
+  printf("\n%s\n", Failures ? "FAILED" : "all passed");
+  return Failures ? 1 : 0;
+}
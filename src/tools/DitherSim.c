@@ -0,0 +1,86 @@
+// DitherSim.c
+// Runs on a PC (any C99 compiler)
+// Simulates the temporal dithering of PWM.c: for a PWM period,
+// runs PWM_DITHER_STEP() over a full dither cycle for duty cycles
+// with 8 fraction bits, and checks that the average duty cycle
+// is the one asked for and how often the pattern repeats (the
+// lowest ripple frequency the light could show).
+// Chanartip Soonthornwan
+
+// Usage:
+//    gcc -O2 -o DitherSim DitherSim.c
+//    DitherSim 1250
+// The period is in PWM clock cycles (25 MHz, BUS_CLOCK/2), so
+// 1250 is 20 kHz.  The default is 1250.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "../lib/PWM.h"
+
+#define PWM_CLOCK  25000000L    // BUS_CLOCK/2
+#define PERIODS    256          // one full dither cycle
+
+// Average duty cycle, in PWM clock cycles, over a dither cycle
+static double average(uint32_t fine){
+  uint16_t acc = 0;
+  uint32_t sum = 0, duty;
+  int i;
+  for(i=0; i<PERIODS; i=i+1){
+    duty = PWM_DITHER_STEP(fine, acc);
+    sum = sum + duty;
+  }
+  return (double)sum/PERIODS;
+}
+
+// Periods before the output pattern repeats
+static int repeat(uint32_t fine){
+  int f = fine&0xFF, n = PERIODS;
+  if(f == 0){
+    return 1;
+  }
+  while((f%2) == 0){
+    f = f/2;
+    n = n/2;
+  }
+  return n;
+}
+
+int main(int argc, char **argv){
+  long period = 1250, rate;
+  uint32_t fine, top, stride;
+  double avg, err, maxErr = 0;
+  if(argc > 1){
+    period = atol(argv[1]);
+  }
+  if((period < 3) || (period > 65535)){
+    fprintf(stderr, "period must be 3 to 65535\n");
+    return 1;
+  }
+  rate = PWM_CLOCK/period;
+  top = (uint32_t)(period - 1)<<8;
+  printf("period %ld cycles, %ld Hz: %ld duty steps dithered, %ld without\n",
+         period, rate, (long)(top - (2<<8)), period - 3);
+  printf("     duty     asked%%   average%%     error  pattern Hz\n");
+                                        // fine steps at the dim end, then coarse
+  for(fine=2<<8; fine<=top; fine=fine+((fine < (16<<8)) ? 89 : (top>>4) + 1)){
+    avg = average(fine);
+    printf("%9.3f %10.5f %10.5f %9.2g %10ld\n", fine/256.0,
+           100.0*fine/256.0/period, 100.0*avg/period, avg - fine/256.0,
+           rate/repeat(fine));
+  }
+  stride = (top > 100000) ? 97 : 1;     // every duty cycle of short periods
+  for(fine=2<<8; fine<=top; fine=fine+stride){
+    err = average(fine) - fine/256.0;
+    if(err < 0){
+      err = -err;
+    }
+    if(err > maxErr){
+      maxErr = err;
+    }
+  }
+  printf("largest error of the average: %.3g cycles\n", maxErr);
+  printf("slowest pattern: %ld Hz, for fractions that are odd multiples of 1/256\n",
+         rate/PERIODS);
+  return 0;
+}
@@ -0,0 +1,214 @@
+// ImageConv.c
+// Runs on a PC (any C99 compiler)
+// Converts an uncompressed 24-bit .bmp file into a C array in the
+// palette and run length format drawn by ST7735_DrawImage().  See
+// ST7735.h for a description of the format.
+// Chanartip Soonthornwan
+
+// Usage:
+//    gcc -O2 -o ImageConv ImageConv.c
+//    ImageConv logo.bmp Logo > Logo.h
+// The output declares
+//    const uint8_t Logo[] = { ... };
+// which is displayed with ST7735_DrawImage(x, y, Logo).
+// Colors are reduced to RGB565 before counting, so the image may
+// have at most 256 distinct RGB565 colors.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#define MAXCOLORS  256
+#define MAXRUN     128      // pixels in one packet
+
+static uint16_t Palette[MAXCOLORS];
+static int NumColors;
+static uint8_t *Out;        // encoded image
+static long OutN;
+static int Column;          // for line wrapping the output
+
+// Same packing as ST7735_Color565()
+static uint16_t color565(uint8_t r, uint8_t g, uint8_t b){
+  return ((b & 0xF8) << 8) | ((g & 0xFC) << 3) | (r >> 3);
+}
+
+static uint32_t get16(const uint8_t *p){ return p[0] | (p[1]<<8); }
+static uint32_t get32(const uint8_t *p){ return get16(p) | (get16(p+2)<<16); }
+
+// Palette index of color, adding it if new.  -1 if the palette is full.
+static int lookup(uint16_t color){
+  int i;
+  for(i=0; i<NumColors; i=i+1){
+    if(Palette[i] == color){
+      return i;
+    }
+  }
+  if(NumColors == MAXCOLORS){
+    return -1;
+  }
+  Palette[NumColors] = color;
+  NumColors = NumColors + 1;
+  return i;
+}
+
+static void emit(uint8_t byte){
+  Out[OutN] = byte;
+  OutN = OutN + 1;
+}
+
+// Length of the run of equal indices starting at idx[i], at most MAXRUN
+static long runLength(const uint8_t *idx, long i, long n){
+  long r = 1;
+  while((i + r < n) && (r < MAXRUN) && (idx[i + r] == idx[i])){
+    r = r + 1;
+  }
+  return r;
+}
+
+// Encode n indices of bits each into Out.  A repeat packet costs
+// two bytes, so a run is only coded as a repeat when that is
+// smaller than packing the same pixels as literals.
+static void encode(const uint8_t *idx, long n, int bits){
+  long i = 0, start, k;
+  int minRun = 16/bits + 1;
+  int acc, used;
+  if(minRun < 2){
+    minRun = 2;
+  }
+  while(i < n){
+    long r = runLength(idx, i, n);
+    if(r >= minRun){
+      emit(0x80 | (r - 1));
+      emit(idx[i]);
+      i = i + r;
+      continue;
+    }
+    start = i;                          // collect literals up to the next long run
+    while((i < n) && (i - start < MAXRUN)){
+      r = runLength(idx, i, n);
+      if(r >= minRun){
+        break;
+      }
+      if(i - start + r > MAXRUN){
+        r = MAXRUN - (i - start);
+      }
+      i = i + r;
+    }
+    emit(i - start - 1);
+    acc = 0; used = 0;
+    for(k=start; k<i; k=k+1){
+      acc = (acc<<bits) | idx[k];
+      used = used + bits;
+      if(used == 8){
+        emit(acc);
+        acc = 0; used = 0;
+      }
+    }
+    if(used){
+      emit(acc<<(8 - used));            // pad to a whole byte
+    }
+  }
+}
+
+static void outByte(uint8_t byte){
+  if(Column == 0){
+    printf("  ");
+  }
+  printf("0x%02X,", byte);
+  Column = Column + 1;
+  if(Column == 16){
+    printf("\n");
+    Column = 0;
+  }
+}
+
+int main(int argc, char **argv){
+  FILE *f;
+  uint8_t *file, *idx;
+  const uint8_t *row;
+  long size, w, h, stride, x, y, n;
+  int bits, topDown = 0, i;
+
+  if(argc != 3){
+    fprintf(stderr, "usage: %s image.bmp ArrayName\n", argv[0]);
+    return 1;
+  }
+  f = fopen(argv[1], "rb");
+  if(f == NULL){
+    fprintf(stderr, "cannot open %s\n", argv[1]);
+    return 1;
+  }
+  fseek(f, 0, SEEK_END);
+  size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  file = malloc(size);
+  if((file == NULL) || (fread(file, 1, size, f) != (size_t)size)){
+    fprintf(stderr, "cannot read %s\n", argv[1]);
+    return 1;
+  }
+  fclose(f);
+
+  if((size < 54) || (file[0] != 'B') || (file[1] != 'M')){
+    fprintf(stderr, "%s is not a .bmp file\n", argv[1]);
+    return 1;
+  }
+  if((get16(&file[28]) != 24) || (get32(&file[30]) != 0)){
+    fprintf(stderr, "%s must be 24 bits per pixel, uncompressed\n", argv[1]);
+    return 1;
+  }
+  w = (int32_t)get32(&file[18]);
+  h = (int32_t)get32(&file[22]);
+  if(h < 0){                            // negative height means top row first
+    h = -h;
+    topDown = 1;
+  }
+  stride = (w*3 + 3) & ~3;              // rows are padded to four bytes
+  if((w <= 0) || (w > 0xFFFF) || (h == 0) || (h > 0xFFFF) ||
+     (get32(&file[10]) > (unsigned long)size) ||             // pixels start past the end
+     (h > (size - (long)get32(&file[10]))/stride)){          // or do not all fit
+    fprintf(stderr, "%s has a bad size\n", argv[1]);
+    return 1;
+  }
+
+  n = w*h;
+  idx = malloc(n);
+  Out = malloc(2*n + 16);               // worst case is well under this
+  if((idx == NULL) || (Out == NULL)){
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+  for(y=0; y<h; y=y+1){                 // convert top row first
+    row = &file[get32(&file[10]) + stride*(topDown ? y : (h - 1 - y))];
+    for(x=0; x<w; x=x+1){
+      i = lookup(color565(row[3*x+2], row[3*x+1], row[3*x]));
+      if(i < 0){
+        fprintf(stderr, "%s has more than %d colors\n", argv[1], MAXCOLORS);
+        return 1;
+      }
+      idx[y*w + x] = i;
+    }
+  }
+  bits = (NumColors <= 2) ? 1 : (NumColors <= 4) ? 2 : (NumColors <= 16) ? 4 : 8;
+
+  emit(w&0xFF); emit(w>>8);
+  emit(h&0xFF); emit(h>>8);
+  emit(NumColors - 1);
+  emit(bits);
+  for(i=0; i<NumColors; i=i+1){
+    emit(Palette[i]&0xFF); emit(Palette[i]>>8);
+  }
+  encode(idx, n, bits);
+
+  printf("// %s: %ldx%ld, %d colors, %d bits per pixel\n", argv[1], w, h, NumColors, bits);
+  printf("// %ld bytes, %ld as a ST7735_DrawBitmap() array (%.1f to 1)\n",
+         OutN, 2*n, (double)(2*n)/OutN);
+  printf("const uint8_t %s[] = {\n", argv[2]);
+  for(x=0; x<OutN; x=x+1){
+    outByte(Out[x]);
+  }
+  if(Column){
+    printf("\n");
+  }
+  printf("};\n");
+  return 0;
+}
@@ -0,0 +1,217 @@
+// NokiaSim.c
+// Runs on a PC (any C99 compiler)
+// Checks the screen buffer primitives of Nokia5110.c against a
+// reference that keeps one byte per pixel: ClearBuffer, SetPixel,
+// ClrPixel, FillRect and the lines, gauges and sparklines built
+// on it, on every rectangle that touches the screen and on long
+// random sequences.  Then times each primitive, and FillRect
+// against filling the same rectangle pixel by pixel.
+// Prints each check and exits with 1 if one fails.
+// Chanartip Soonthornwan
+
+// Usage:
+//    gcc -O2 -I../lib -o NokiaSim NokiaSim.c
+//    NokiaSim
+// Nokia5110.c is included, so the buffer can be read; its
+// functions that talk to the LCD are linked to stubs and never run.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "../lib/Nokia5110.c"
+
+int SSI_Select(SSIDevice *dev){ (void)dev; return 0; }
+void SSI_Register(SSIDevice *dev){ (void)dev; }
+void SSI_Count(SSIDevice *dev, uint32_t n){ (void)dev; (void)n; }
+void Delay_us(uint32_t us){ (void)us; }
+
+static unsigned char Ref[MAX_Y][MAX_X];   // reference, 1 if the pixel is on
+static int Failures;
+static uint32_t Seed = 12345;
+
+static void check(int ok, const char *what){
+  printf("%-52s %s\n", what, ok ? "ok" : "FAILED");
+  if(!ok){
+    Failures = Failures + 1;
+  }
+}
+
+static uint32_t rnd(uint32_t n){
+  Seed = Seed*1664525 + 1013904223;
+  return (Seed>>8)%n;
+}
+
+static void refPixel(int x, int y, int color){
+  if((x >= 0) && (x < MAX_X) && (y >= 0) && (y < MAX_Y)){
+    Ref[y][x] = color;
+  }
+}
+
+static void refRect(int x, int y, int w, int h, int color){
+  int i, j;
+  for(j=y; j<y+h; j=j+1){
+    for(i=x; i<x+w; i=i+1){
+      refPixel(i, j, color);
+    }
+  }
+}
+
+// 1 if the buffer holds the same picture as the reference
+static int same(void){
+  int x, y;
+  for(y=0; y<MAX_Y; y=y+1){
+    for(x=0; x<MAX_X; x=x+1){
+      if(((Screen[(y>>3)*MAX_X + x]>>(y&0x07))&1) != Ref[y][x]){
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+
+// Fill both with a random picture
+static void scramble(void){
+  int x, y;
+  for(y=0; y<MAX_Y; y=y+1){
+    for(x=0; x<MAX_X; x=x+1){
+      Ref[y][x] = rnd(2);
+      if(Ref[y][x]){
+        Nokia5110_SetPixel(x, y);
+      } else{
+        Nokia5110_ClrPixel(x, y);
+      }
+    }
+  }
+}
+
+static double seconds(void){
+  return (double)clock()/CLOCKS_PER_SEC;
+}
+
+// Time n calls of what, in ns per call
+#define TIME(n, what) do{ \
+    double t0 = seconds(); long k; \
+    for(k=0; k<(n); k=k+1){ what; } \
+    ns = (seconds() - t0)*1e9/(n); \
+  } while(0)
+
+int main(void){
+  int x, y, w, h, i, ok;
+  unsigned char data[120];
+  unsigned long value;
+  volatile unsigned char sink;
+  double ns, perPixel;
+
+  scramble();
+  Nokia5110_ClearBuffer();
+  memset(Ref, 0, sizeof(Ref));
+  check(same(), "ClearBuffer clears every pixel");
+
+  ok = 1;
+  for(y=0; y<MAX_Y+2; y=y+1){           // on and just off the screen
+    for(x=0; x<MAX_X+2; x=x+1){
+      Nokia5110_SetPixel(x, y);
+      refPixel(x, y, 1);
+    }
+  }
+  ok = ok && same();
+  for(i=0; i<4000; i=i+1){
+    x = rnd(MAX_X + 4); y = rnd(MAX_Y + 4);
+    if(rnd(2)){
+      Nokia5110_SetPixel(x, y); refPixel(x, y, 1);
+    } else{
+      Nokia5110_ClrPixel(x, y); refPixel(x, y, 0);
+    }
+  }
+  check(ok && same(), "SetPixel/ClrPixel, clipped off the screen");
+
+  ok = 1;
+  for(y=0; (y<MAX_Y+1) && ok; y=y+1){   // every top row, every height
+    for(h=0; (h<=MAX_Y+1) && ok; h=h+1){
+      scramble();
+      x = rnd(MAX_X); w = rnd(MAX_X + 8);
+      Nokia5110_FillRect(x, y, w, h, 1); refRect(x, y, w, h, 1);
+      ok = same();
+      x = rnd(MAX_X); w = rnd(MAX_X + 8);
+      Nokia5110_FillRect(x, y, w, h, 0); refRect(x, y, w, h, 0);
+      ok = ok && same();
+    }
+  }
+  check(ok, "FillRect on every top row and height, both colors");
+
+  ok = 1;
+  for(i=0; (i<20000) && ok; i=i+1){
+    x = rnd(MAX_X + 4); y = rnd(MAX_Y + 4);
+    w = rnd(MAX_X + 4); h = rnd(MAX_Y + 4);
+    switch(rnd(3)){
+      case 0:
+        Nokia5110_FillRect(x, y, w, h, i&1); refRect(x, y, w, h, i&1); break;
+      case 1:
+        Nokia5110_HLine(x, y, w, i&1); refRect(x, y, w, 1, i&1); break;
+      case 2:
+        Nokia5110_VLine(x, y, h, i&1); refRect(x, y, 1, h, i&1); break;
+    }
+    ok = same();
+  }
+  check(ok, "FillRect/HLine/VLine, 20000 random calls");
+
+  ok = 1;
+  for(i=0; (i<2000) && ok; i=i+1){
+    x = rnd(MAX_X - 3); y = rnd(MAX_Y - 3);
+    w = 3 + rnd(MAX_X - x - 2); h = 3 + rnd(MAX_Y - y - 2);
+    value = rnd(120);
+    Nokia5110_BarGauge(x, y, w, h, value, 100);
+    if(value > 100) value = 100;
+    refRect(x, y, w, h, 1);
+    refRect(x+1, y+1, w-2, h-2, 0);
+    refRect(x+1, y+1, (value*(w-2))/100, h-2, 1);
+    ok = same();
+  }
+  check(ok, "BarGauge, 2000 random gauges");
+
+  ok = 1;
+  for(i=0; (i<2000) && ok; i=i+1){
+    int n, v, row, prev = 0, max = 1 + rnd(255);
+    x = rnd(MAX_X - 1); y = rnd(MAX_Y - 1);
+    w = 1 + rnd(MAX_X - x); h = 1 + rnd(MAX_Y - y);
+    n = rnd(sizeof(data));
+    for(v=0; v<n; v=v+1) data[v] = rnd(256);
+    Nokia5110_Sparkline(x, y, w, h, data, n, max);
+    refRect(x, y, w, h, 0);
+    for(v=0; (v<n) && (v<w); v=v+1){
+      int d = data[(n > w) ? n - w + v : v];
+      if(d > max) d = max;
+      row = y + (h - 1) - (d*(h - 1))/max;
+      if(v == 0) prev = row;
+      refRect(x+v, (row < prev) ? row : prev, 1, ((row < prev) ? prev - row : row - prev) + 1, 1);
+      prev = row;
+    }
+    ok = same();
+  }
+  check(ok, "Sparkline, 2000 random plots");
+
+  printf("\n%-32s %10s\n", "host timing", "ns/call");
+  TIME(1000000, Nokia5110_ClearBuffer());
+  printf("%-32s %10.1f\n", "ClearBuffer", ns);
+  TIME(10000000, Nokia5110_SetPixel(k%MAX_X, k%MAX_Y));
+  printf("%-32s %10.1f\n", "SetPixel", ns);
+  TIME(10000000, Nokia5110_ClrPixel(k%MAX_X, k%MAX_Y));
+  printf("%-32s %10.1f\n", "ClrPixel", ns);
+  TIME(1000000, Nokia5110_FillRect(0, 0, MAX_X, MAX_Y, k&1));
+  printf("%-32s %10.1f\n", "FillRect 84x48", ns);
+  TIME(10000, for(y=0; y<MAX_Y; y=y+1) for(x=0; x<MAX_X; x=x+1) Nokia5110_SetPixel(x, y));
+  perPixel = ns;
+  printf("%-32s %10.1f\n", "84x48 with SetPixel", ns);
+  TIME(1000000, Nokia5110_FillRect(10, 3, 60, 30, k&1));
+  printf("%-32s %10.1f\n", "FillRect 60x30, unaligned", ns);
+  TIME(100000, Nokia5110_Sparkline(0, 0, MAX_X, MAX_Y, data, MAX_X, 255));
+  printf("%-32s %10.1f\n", "Sparkline 84x48", ns);
+  TIME(1000000, Nokia5110_FillRect(0, 0, MAX_X, MAX_Y, 1));
+  printf("full screen: FillRect %.1fx faster than SetPixel\n", perPixel/ns);
+  sink = Screen[0];
+  (void)sink;
+
+  printf("\n%s\n", Failures ? "FAILED" : "all passed");
+  return Failures ? 1 : 0;
+}
@@ -0,0 +1,177 @@
+// PixelSim.c
+// Runs on a PC (any C99 compiler)
+// Checks the conversions of Pixel.c against a reference written
+// from the 16-bit color format: every length from 0 to 67 (all
+// four n mod 4 tails of the word at a time loops), a source at
+// each byte offset, and a destination both on and off a 32-bit
+// boundary, with guards to catch writes past the end.  Then
+// times each conversion per pixel.
+// Build it twice, once for each path of Pixel.c; both must pass.
+// Prints each check and exits with 1 if one fails.
+// Chanartip Soonthornwan
+
+// Usage:
+//    gcc -O2 -DPIXEL_SIMULATE -I../lib -o PixelSim PixelSim.c ../lib/Pixel.c
+//    gcc -O2 -DPIXEL_NO_SIMD -I../lib -o PixelSim PixelSim.c ../lib/Pixel.c
+//    PixelSim
+// PIXEL_SIMULATE runs the two pixels per word loops with C
+// versions of UXTB16 and REV16; PIXEL_NO_SIMD the plain C loops.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "Pixel.h"
+
+#define MAX_N   67
+#define GUARD   0xA5A5
+
+static int Failures;
+static uint32_t Seed = 12345;
+
+static void check(int ok, const char *what){
+  printf("%-52s %s\n", what, ok ? "ok" : "FAILED");
+  if(!ok){
+    Failures = Failures + 1;
+  }
+}
+
+static uint8_t rnd(void){
+  Seed = Seed*1664525 + 1013904223;
+  return (uint8_t)(Seed>>24);
+}
+
+// Blue in bits 15-11, green in bits 10-5, red in bits 4-0
+static uint16_t ref565(uint8_t r, uint8_t g, uint8_t b){
+  return (uint16_t)(((b>>3)<<11) + ((g>>2)<<5) + (r>>3));
+}
+
+// Word aligned buffers; the tests start at an offset into them
+static uint32_t SrcWords[(3*MAX_N + 8)/4 + 1];
+static uint32_t DstWords[(MAX_N + 4)/2 + 1];
+#define Src ((uint8_t *)SrcWords)
+#define Dst ((uint16_t *)DstWords)
+
+static void fill(void){
+  unsigned int i;
+  for(i=0; i<sizeof(SrcWords); i=i+1){
+    Src[i] = rnd();
+  }
+  for(i=0; i<sizeof(DstWords)/2; i=i+1){
+    Dst[i] = GUARD;
+  }
+}
+
+// 1 if the entries of Dst before off and after off+n are untouched
+static int guards(int off, int n){
+  int i;
+  for(i=0; i<(int)(sizeof(DstWords)/2); i=i+1){
+    if(((i < off) || (i >= off + n)) && (Dst[i] != GUARD)){
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static double seconds(void){
+  return (double)clock()/CLOCKS_PER_SEC;
+}
+
+static uint16_t Big[4096];
+static uint8_t BigSrc[3*4096 + 4];
+
+// Time reps calls of what on 4096 pixels, in ns per pixel
+#define TIME(name, reps, what) do{ \
+    double t0 = seconds(); long k; \
+    for(k=0; k<(reps); k=k+1){ what; } \
+    printf("%-32s %10.3f\n", name, (seconds() - t0)*1e9/(reps)/4096); \
+  } while(0)
+
+int main(void){
+  int n, off, so, i, ok[3] = {1, 1, 1}, okGrad = 1;
+  uint16_t x, *dst;
+  const uint8_t *src;
+  char what[64];
+
+#if defined(PIXEL_SIMULATE) && !defined(PIXEL_NO_SIMD)
+  printf("Pixel.c built with its two pixels per word loops\n\n");
+#else
+  printf("Pixel.c built with its plain C loops\n\n");
+#endif
+  for(n=0; n<=MAX_N; n=n+1){
+    for(off=0; off<2; off=off+1){       // dst on, then off, a word boundary
+      for(so=0; so<4; so=so+1){         // every byte offset of src
+        dst = Dst + off;
+        src = Src + so;
+
+        fill();
+        Pixel_RGB888To565(dst, src, n);
+        for(i=0; i<n; i=i+1){
+          if(dst[i] != ref565(src[3*i], src[3*i+1], src[3*i+2])) ok[0] = 0;
+        }
+        if(!guards(off, n)) ok[0] = 0;
+
+        fill();
+        Pixel_GrayTo565(dst, src, n);
+        for(i=0; i<n; i=i+1){
+          if(dst[i] != ref565(src[i], src[i], src[i])) ok[1] = 0;
+        }
+        if(!guards(off, n)) ok[1] = 0;
+
+        fill();
+        Pixel_Swap565(dst, (const uint16_t *)(Src + 2*(so&1)), n);
+        for(i=0; i<n; i=i+1){
+          x = (uint16_t)((Src[2*(so&1) + 2*i]<<8)|Src[2*(so&1) + 2*i + 1]);
+          if(dst[i] != x) ok[2] = 0;
+        }
+        if(!guards(off, n)) ok[2] = 0;
+        fill();                         // in place
+        for(i=0; i<n; i=i+1){
+          dst[i] = (uint16_t)((Src[2*i]<<8)|Src[2*i + 1]);
+        }
+        Pixel_Swap565(dst, dst, n);
+        for(i=0; i<n; i=i+1){
+          if(dst[i] != ((Src[2*i + 1]<<8)|Src[2*i])) ok[2] = 0;
+        }
+        if(!guards(off, n)) ok[2] = 0;
+      }
+    }
+  }
+  sprintf(what, "RGB888To565, n 0 to %d, all alignments", MAX_N);
+  check(ok[0], what);
+  sprintf(what, "GrayTo565, n 0 to %d, all alignments", MAX_N);
+  check(ok[1], what);
+  sprintf(what, "Swap565, n 0 to %d, all alignments, in place", MAX_N);
+  check(ok[2], what);
+
+  for(n=1; n<=400; n=n+7){
+    uint32_t c0 = (rnd()<<16)|(rnd()<<8)|rnd(), c1 = (rnd()<<16)|(rnd()<<8)|rnd();
+    fill();
+    Pixel_Gradient565(Big, n, c0, c1);
+    if(Big[0] != ref565(c0>>16, c0>>8, c0)) okGrad = 0;
+    if((n > 1) && (Big[n-1] != ref565(c1>>16, c1>>8, c1))) okGrad = 0;
+    for(i=0; i<n; i=i+1){               // each channel within one step of exact
+      double t = (n > 1) ? (double)i/(n - 1) : 0;
+      int r = (int)((c0>>16&0xFF) + t*((int)(c1>>16&0xFF) - (int)(c0>>16&0xFF)) + 0.5);
+      int g = (int)((c0>>8&0xFF) + t*((int)(c1>>8&0xFF) - (int)(c0>>8&0xFF)) + 0.5);
+      int b = (int)((c0&0xFF) + t*((int)(c1&0xFF) - (int)(c0&0xFF)) + 0.5);
+      uint16_t e = ref565(r, g, b);
+      if((abs((Big[i]&0x1F) - (e&0x1F)) > 1) || (abs((Big[i]>>5&0x3F) - (e>>5&0x3F)) > 1) ||
+         (abs((Big[i]>>11) - (e>>11)) > 1)) okGrad = 0;
+    }
+  }
+  check(okGrad, "Gradient565, ends exact, within one step between");
+
+  for(i=0; i<(int)sizeof(BigSrc); i=i+1){
+    BigSrc[i] = rnd();
+  }
+  printf("\n%-32s %10s\n", "host timing", "ns/pixel");
+  TIME("RGB888To565", 20000, Pixel_RGB888To565(Big, BigSrc + (k&1), 4096));
+  TIME("GrayTo565", 20000, Pixel_GrayTo565(Big, BigSrc + (k&1), 4096));
+  TIME("Swap565", 20000, Pixel_Swap565(Big, Big, 4096));
+  TIME("Gradient565", 20000, Pixel_Gradient565(Big, 4096, 0x102030, 0xF0E0D0));
+
+  printf("\n%s\n", Failures ? "FAILED" : "all passed");
+  return Failures ? 1 : 0;
+}
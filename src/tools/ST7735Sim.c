@@ -0,0 +1,359 @@
+// ST7735Sim.c
+// Runs on a PC (any C99 compiler)
+// Runs ST7735.c against a model of the ST7735 that decodes the
+// column, row and RAM write commands into a picture, and measures
+// the fill rate of the pixel stream (16-bit frames) against the
+// 8-bit path it replaced (pushColor(), two writedata() calls per
+// pixel): SSI frames and bytes per pixel, the pixels per second
+// the 5 MHz SSIClk allows, and the host time per pixel of the
+// driver code.  The pictures of both paths must be the same.
+// Then counts the SSI bytes of the span based shapes (lines,
+// circles, rounded rectangles, triangles) against the per-pixel
+// code they replaced, where there was one, and against sending
+// each of their pixels with ST7735_DrawPixel().
+// Prints each check and exits with 1 if one fails.
+// Chanartip Soonthornwan
+
+// Usage:
+//    gcc -O2 -DST7735_SIMULATE -I../lib -o ST7735Sim ST7735Sim.c
+//    ST7735Sim
+// ST7735.c is included, so the 8-bit path can still be called.
+// The SSI is never busy on the PC, so the pixels per second on
+// the board are the lower of the SSIClk figure and what the CPU
+// can feed the FIFO, which only the board can tell.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "../lib/ST7735.c"
+
+#define RAM_W  132                      // ST7735 frame memory
+#define RAM_H  162
+
+static uint16_t Ram[RAM_H][RAM_W];      // what the model has drawn
+static uint16_t Picture[RAM_H][RAM_W];  // a copy to compare with
+static int Failures;
+
+// Model of the ST7735 RAM write commands
+static uint8_t Cmd;                     // last command
+static uint8_t Arg[4];
+static int Args;
+static int Col0, Col1, Row0, Row1, Col, Row;    // window, next pixel
+static int HalfPixel;                   // first byte of an 8-bit pixel, -1 if none
+
+// Traffic since the last clear()
+static uint32_t Frames, Bits;
+
+static void pixel(uint16_t color){
+  if((Col < RAM_W) && (Row < RAM_H)){
+    Ram[Row][Col] = color;
+  }
+  Col = Col + 1;
+  if(Col > Col1){
+    Col = Col0;
+    Row = Row + 1;
+    if(Row > Row1){
+      Row = Row0;
+    }
+  }
+}
+
+void ST7735_SimFrame(uint16_t frame, uint8_t bits, uint8_t data){
+  Frames = Frames + 1;
+  Bits = Bits + bits;
+  if(!data){
+    Cmd = (uint8_t)frame;
+    Args = 0;
+    HalfPixel = -1;
+    if(Cmd == ST7735_RAMWR){
+      Col = Col0;
+      Row = Row0;
+    }
+    return;
+  }
+  if(Cmd == ST7735_RAMWR){
+    if(bits == 16){
+      pixel(frame);
+    } else if(HalfPixel < 0){
+      HalfPixel = frame&0xFF;
+    } else{
+      pixel((HalfPixel<<8)|(frame&0xFF));
+      HalfPixel = -1;
+    }
+  } else if(((Cmd == ST7735_CASET) || (Cmd == ST7735_RASET)) && (Args < 4)){
+    Arg[Args] = (uint8_t)frame;
+    Args = Args + 1;
+    if(Args == 4){
+      if(Cmd == ST7735_CASET){
+        Col0 = (Arg[0]<<8)|Arg[1];  Col1 = (Arg[2]<<8)|Arg[3];
+      } else{
+        Row0 = (Arg[0]<<8)|Arg[1];  Row1 = (Arg[2]<<8)|Arg[3];
+      }
+    }
+  }
+}
+
+int SSI_Select(SSIDevice *dev){ (void)dev; return 0; }
+void SSI_Register(SSIDevice *dev){ (void)dev; }
+void SSI_Count(SSIDevice *dev, uint32_t n){ (void)dev; (void)n; }
+void Delay_ms(uint32_t ms){ (void)ms; }
+void Timer2_OneShot(void(*task)(void), unsigned long delay){ (void)task; (void)delay; }
+
+static void check(int ok, const char *what){
+  printf("%-52s %s\n", what, ok ? "ok" : "FAILED");
+  if(!ok){
+    Failures = Failures + 1;
+  }
+}
+
+static void clear(void){
+  memset(Ram, 0, sizeof(Ram));
+  Frames = Bits = 0;
+}
+
+static double seconds(void){
+  return (double)clock()/CLOCKS_PER_SEC;
+}
+
+// The 8-bit path: FillRect as it was, one pushColor() per pixel
+static void oldFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color){
+  int32_t n;
+  if((x >= _width) || (y >= _height)) return;
+  if((x + w - 1) >= _width)  w = _width  - x;
+  if((y + h - 1) >= _height) h = _height - y;
+  if((w <= 0) || (h <= 0)) return;
+  setAddrWindow(x, y, x+w-1, y+h-1);
+  for(n=(int32_t)w*h; n>0; n=n-1){
+    pushColor(color);
+  }
+}
+
+// The 8-bit path: DrawBitmap of an image fully on the screen
+static void oldDrawBitmap(int16_t x, int16_t y, const uint16_t *image, int16_t w, int16_t h){
+  int i = w*(h - 1), r, c;
+  setAddrWindow(x, y-h+1, x+w-1, y);
+  for(r=0; r<h; r=r+1){
+    for(c=0; c<w; c=c+1){
+      pushColor(image[i]);
+      i = i + 1;
+    }
+    i = i - 2*w;
+  }
+}
+
+static uint16_t Image[64*64];
+static double SsiClk = 50000000.0/10;  // 50 MHz bus, CPSDVSR 10, SCR 0
+static char Lines[20][100];             // the table printed at the end
+static int NLines;
+
+#define swapInt(a, b) { int t = a; a = b; b = t; }
+
+// The per-pixel DrawLine, one DrawPixel() per Bresenham point
+static void oldDrawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color){
+  int steep = abs(y1 - y0) > abs(x1 - x0);
+  int dx, dy, err, ystep;
+  if(steep){ swap(x0, y0); swap(x1, y1); }
+  if(x0 > x1){ swap(x0, x1); swap(y0, y1); }
+  dx = x1 - x0;
+  dy = abs(y1 - y0);
+  err = dx/2;
+  ystep = (y0 < y1) ? 1 : -1;
+  for(; x0<=x1; x0++){
+    if(steep){
+      ST7735_DrawPixel(y0, x0, color);
+    } else{
+      ST7735_DrawPixel(x0, y0, color);
+    }
+    err -= dy;
+    if(err < 0){ y0 += ystep; err += dx; }
+  }
+}
+
+// The per-pixel DrawCircle, eight DrawPixel() per midpoint step
+static void oldDrawCircle(uint8_t x0, uint8_t y0, uint8_t r, uint16_t color){
+  int f = 1 - r, ddF_x = 1, ddF_y = -2*r, x = 0, y = r;
+  ST7735_DrawPixel(x0, y0+r, color);
+  ST7735_DrawPixel(x0, y0-r, color);
+  ST7735_DrawPixel(x0+r, y0, color);
+  ST7735_DrawPixel(x0-r, y0, color);
+  while(x < y){
+    if(f >= 0){ y--; ddF_y += 2; f += ddF_y; }
+    x++; ddF_x += 2; f += ddF_x;
+    ST7735_DrawPixel(x0 + x, y0 + y, color);
+    ST7735_DrawPixel(x0 - x, y0 + y, color);
+    ST7735_DrawPixel(x0 + x, y0 - y, color);
+    ST7735_DrawPixel(x0 - x, y0 - y, color);
+    ST7735_DrawPixel(x0 + y, y0 + x, color);
+    ST7735_DrawPixel(x0 - y, y0 + x, color);
+    ST7735_DrawPixel(x0 + y, y0 - x, color);
+    ST7735_DrawPixel(x0 - y, y0 - x, color);
+  }
+}
+
+// The FillCircle that drew every column of each midpoint step,
+// overlapping ones included
+static void oldFillCircle(uint8_t x0, uint8_t y0, uint8_t r, uint16_t color){
+  int f = 1 - r, ddF_x = 1, ddF_y = -2*r, x = 0, y = r;
+  ST7735_DrawFastVLine(x0, y0-r, 2*r+1, color);
+  while(x < y){
+    if(f >= 0){ y--; ddF_y += 2; f += ddF_y; }
+    x++; ddF_x += 2; f += ddF_x;
+    ST7735_DrawFastVLine(x0+x, y0-y, 2*y+1, color);
+    ST7735_DrawFastVLine(x0-x, y0-y, 2*y+1, color);
+    ST7735_DrawFastVLine(x0+y, y0-x, 2*x+1, color);
+    ST7735_DrawFastVLine(x0-y, y0-x, 2*x+1, color);
+  }
+}
+
+// The Adafruit FillTriangle scan, one DrawPixel() per pixel
+static void pixelTriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint16_t color){
+  int a, b, y, last, i, dx01, dy01, dx02, dy02, dx12, dy12, sa = 0, sb = 0;
+  if(y0 > y1){ swapInt(y0, y1); swapInt(x0, x1); }
+  if(y1 > y2){ swapInt(y2, y1); swapInt(x2, x1); }
+  if(y0 > y1){ swapInt(y0, y1); swapInt(x0, x1); }
+  if(y0 == y2){                         // all on one row
+    a = b = x0;
+    if(x1 < a) a = x1; else if(x1 > b) b = x1;
+    if(x2 < a) a = x2; else if(x2 > b) b = x2;
+    for(i=a; i<=b; i++) ST7735_DrawPixel(i, y0, color);
+    return;
+  }
+  dx01 = x1 - x0; dy01 = y1 - y0; dx02 = x2 - x0;
+  dy02 = y2 - y0; dx12 = x2 - x1; dy12 = y2 - y1;
+  last = (y1 == y2) ? y1 : y1 - 1;
+  for(y=y0; y<=last; y++){
+    a = x0 + sa/dy01; b = x0 + sb/dy02;
+    sa += dx01; sb += dx02;
+    if(a > b) swapInt(a, b);
+    for(i=a; i<=b; i++) ST7735_DrawPixel(i, y, color);
+  }
+  sa = dx12*(y - y1); sb = dx02*(y - y0);
+  for(; y<=y2; y++){
+    a = x1 + sa/dy12; b = x0 + sb/dy02;
+    sa += dx12; sb += dx02;
+    if(a > b) swapInt(a, b);
+    for(i=a; i<=b; i++) ST7735_DrawPixel(i, y, color);
+  }
+}
+
+// Pixels drawn since the last clear()
+static uint32_t drawn(void){
+  uint32_t n = 0;
+  int x, y;
+  for(y=0; y<RAM_H; y=y+1){
+    for(x=0; x<RAM_W; x=x+1){
+      n = n + (Ram[y][x] != 0);
+    }
+  }
+  return n;
+}
+
+static uint32_t Seed = 12345;
+static int rnd(int n){
+  Seed = Seed*1664525 + 1013904223;
+  return (Seed>>8)%n;
+}
+
+// Draw n random shapes with the span code, and with the code it
+// replaced (hasOld 1) or with a per-pixel reference (hasOld 2),
+// and print the SSI bytes of the span code, of the code it
+// replaced, and of drawing every pixel of its picture with
+// DrawPixel()
+#define SHAPES(name, n, args, hasOld, old, new) do{ \
+    uint32_t sent[3] = {0, 0, 0}, bad = 0; int k; \
+    for(k=0; k<(n); k=k+1){ \
+      args; \
+      if(hasOld){ clear(); old; sent[0] = sent[0] + Bits/8; memcpy(Picture, Ram, sizeof(Ram)); } \
+      clear(); new; sent[1] = sent[1] + Bits/8; \
+      sent[2] = sent[2] + drawn()*pixelBytes; \
+      if(hasOld && memcmp(Picture, Ram, sizeof(Ram))) bad = bad + 1; \
+    } \
+    if(hasOld) check(bad == 0, name ", same picture as the per-pixel code"); \
+    shapes(name, sent[1], (hasOld == 1) ? sent[0] : 0, sent[2]); \
+  } while(0)
+
+static void shapes(const char *name, uint32_t spans, uint32_t before, uint32_t pixels){
+  if(before){
+    snprintf(Lines[NLines], sizeof(Lines[0]), "%-18s %10u %10u %6.0f%% %10u %6.0f%%",
+             name, spans, before, 100.0*spans/before, pixels, 100.0*spans/pixels);
+  } else{
+    snprintf(Lines[NLines], sizeof(Lines[0]), "%-18s %10u %10s %7s %10u %6.0f%%",
+             name, spans, "-", "", pixels, 100.0*spans/pixels);
+  }
+  NLines = NLines + 1;
+}
+
+// Draw a case with both paths, compare the pictures and print
+// the traffic and rates of each
+#define CASE(name, pixels, reps, old, new) do{ \
+    double t0, ns[2]; uint32_t f[2], b[2]; long k; \
+    clear(); old; f[0] = Frames; b[0] = Bits; memcpy(Picture, Ram, sizeof(Ram)); \
+    clear(); new; f[1] = Frames; b[1] = Bits; \
+    check(memcmp(Picture, Ram, sizeof(Ram)) == 0, name ", same picture both ways"); \
+    t0 = seconds(); for(k=0; k<(reps); k=k+1){ old; } ns[0] = (seconds() - t0)*1e9/(reps)/(pixels); \
+    t0 = seconds(); for(k=0; k<(reps); k=k+1){ new; } ns[1] = (seconds() - t0)*1e9/(reps)/(pixels); \
+    report(name, "8-bit", pixels, f[0], b[0], ns[0]); \
+    report(name, "16-bit", pixels, f[1], b[1], ns[1]); \
+  } while(0)
+
+
+static void report(const char *name, const char *path, uint32_t pixels,
+                   uint32_t frames, uint32_t bits, double ns){
+  snprintf(Lines[NLines], sizeof(Lines[0]), "%-18s %-6s %8.2f %8.2f %10.0f %10.2f",
+           name, path, (double)frames/pixels, bits/8.0/pixels, SsiClk*pixels/bits, ns);
+  NLines = NLines + 1;
+}
+
+int main(void){
+  int i, a, b, c, d, e, f, r, pixelBytes;
+  for(i=0; i<64*64; i=i+1){
+    Image[i] = (uint16_t)(i*2654435761u>>16);
+  }
+
+  CASE("full screen", 128*160, 200,
+       oldFillRect(0, 0, 128, 160, 0x1234), ST7735_FillRect(0, 0, 128, 160, 0x1234));
+  CASE("fill 40x40", 40*40, 5000,
+       oldFillRect(30, 50, 40, 40, 0xF800), ST7735_FillRect(30, 50, 40, 40, 0xF800));
+  CASE("fill 8x8", 8*8, 50000,
+       oldFillRect(3, 7, 8, 8, 0x07E0), ST7735_FillRect(3, 7, 8, 8, 0x07E0));
+  CASE("bitmap 64x64", 64*64, 1000,
+       oldDrawBitmap(10, 100, Image, 64, 64), ST7735_DrawBitmap(10, 100, Image, 64, 64));
+
+  printf("\nSSIClk %.2f MHz\n", SsiClk/1e6);
+  printf("%-18s %-6s %8s %8s %10s %10s\n", "", "", "frames", "bytes", "pixels/s", "host ns");
+  printf("%-18s %-6s %8s %8s %10s %10s\n", "", "", "/pixel", "/pixel", "on SSI", "/pixel");
+  for(i=0; i<NLines; i=i+1){
+    printf("%s\n", Lines[i]);
+  }
+
+  clear();
+  ST7735_DrawPixel(5, 5, 0x1234);
+  pixelBytes = Bits/8;
+  NLines = 0;
+  SHAPES("DrawLine", 2000,
+         (a = rnd(200) - 36, b = rnd(220) - 30, c = rnd(200) - 36, d = rnd(220) - 30),
+         1, oldDrawLine(a, b, c, d, 0x1234), ST7735_DrawLine(a, b, c, d, 0x1234));
+  SHAPES("DrawCircle", 1000,
+         (r = rnd(60), a = rnd(128), b = rnd(160)),
+         1, oldDrawCircle(a, b, r, 0x1234), ST7735_DrawCircle(a, b, r, 0x1234));
+  SHAPES("FillCircle", 1000,
+         (r = rnd(40), a = r + rnd(128 - 2*r), b = r + rnd(160 - 2*r)),
+         1, oldFillCircle(a, b, r, 0x1234), ST7735_FillCircle(a, b, r, 0x1234));
+  SHAPES("DrawRoundRect", 1000,
+         (a = rnd(100), b = rnd(130), c = 4 + rnd(124 - a), d = 4 + rnd(156 - b), r = rnd(12)),
+         0, (void)0, ST7735_DrawRoundRect(a, b, c, d, r, 0x1234));
+  SHAPES("FillRoundRect", 1000,
+         (a = rnd(100), b = rnd(130), c = 4 + rnd(124 - a), d = 4 + rnd(156 - b), r = rnd(12)),
+         0, (void)0, ST7735_FillRoundRect(a, b, c, d, r, 0x1234));
+  SHAPES("FillTriangle", 1000,
+         (a = rnd(128), b = rnd(160), c = rnd(128), d = rnd(160), e = rnd(128), f = rnd(160)),
+         2, pixelTriangle(a, b, c, d, e, f, 0x1234), ST7735_FillTriangle(a, b, c, d, e, f, 0x1234));
+  printf("\n%-18s %10s %10s %7s %10s %7s\n", "SSI bytes", "spans", "before", "", "DrawPixel", "");
+  for(i=0; i<NLines; i=i+1){
+    printf("%s\n", Lines[i]);
+  }
+
+  printf("\n%s\n", Failures ? "FAILED" : "all passed");
+  return Failures ? 1 : 0;
+}
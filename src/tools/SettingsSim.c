@@ -0,0 +1,125 @@
+// SettingsSim.c
+// Runs on a PC (any C99 compiler)
+// Runs the settings store of Settings.c on a simulated EEPROM:
+// coalescing of a burst of saves, wear over many writes, records
+// cut short by a reset, and the sequence number wrapping.
+// Prints each check and exits with 1 if one fails.
+// Chanartip Soonthornwan
+
+// Usage:
+//    gcc -O2 -DEEPROM_SIMULATE -I../lib -o SettingsSim SettingsSim.c ../lib/Settings.c
+//    SettingsSim
+
+#include <stdio.h>
+#include <stdint.h>
+#include "Timebase.h"
+#include "Settings.h"
+
+static uint64_t Now;                    // simulated timebase
+static int Failures;
+
+uint64_t Timebase_Now(void){ return Now; }
+long StartCritical(void){ return 0; }
+void EndCritical(long sr){ (void)sr; }
+
+typedef struct {                        // like the Slave's settings
+  uint8_t hallway, bathroom, on;
+} State;
+
+static void check(int ok, const char *what){
+  printf("%-52s %s\n", what, ok ? "ok" : "FAILED");
+  if(!ok){
+    Failures = Failures + 1;
+  }
+}
+
+// Let time pass, polling from the "main loop" every 33 ms
+static void run(uint32_t ms){
+  uint32_t t;
+  for(t=0; t<ms; t=t+33){
+    Now = Now + TIMEBASE_MS(33);
+    Settings_Poll();
+  }
+}
+
+// Reset the board: restore into s from the defaults
+static int boot(State *s){
+  s->hallway = s->bathroom = 230;
+  s->on = 0;
+  return Settings_Init(1, s, sizeof(State));
+}
+
+int main(void){
+  State s, r;
+  uint32_t i, min, max;
+  uint16_t seq;
+  int restored;
+
+  restored = boot(&s);
+  check(!restored && (s.hallway == 230), "blank EEPROM keeps the defaults");
+
+  Settings_Save(&s, sizeof(s));
+  run(5000);
+  check(Settings_Stats()->writes == 0, "saving the defaults writes nothing");
+
+  for(i=0; i<20; i=i+1){                // brightness steps 150 ms apart
+    s.hallway = s.hallway - 6;
+    Settings_Save(&s, sizeof(s));
+    run(150);
+  }
+  check(Settings_Stats()->writes == 0, "no write while the steps go on");
+  run(SETTINGS_HOLD_MS + 100);
+  check(Settings_Stats()->writes == 1, "20 steps cost one write");
+
+  s.bathroom = 100;                     // up and back down again
+  Settings_Save(&s, sizeof(s));
+  s.bathroom = 230;
+  Settings_Save(&s, sizeof(s));
+  run(SETTINGS_HOLD_MS + 100);
+  check(Settings_Stats()->writes == 1, "a change undone before the write costs none");
+
+  restored = boot(&r);
+  check(restored && (r.hallway == 110) && (r.bathroom == 230), "boot restores the last write");
+
+  for(i=0; i<70000; i=i+1){             // wear: many separate changes
+    s.hallway = (uint8_t)i;
+    s.on = (uint8_t)(i>>8);
+    Settings_Save(&s, sizeof(s));
+    Settings_Flush();
+  }
+  min = 0xFFFFFFFF;
+  max = 0;
+  for(i=0; i<SETTINGS_WORDS; i=i+1){
+    min = (Settings_Wear[i] < min) ? Settings_Wear[i] : min;
+    max = (Settings_Wear[i] > max) ? Settings_Wear[i] : max;
+  }
+  printf("  70000 records: each word written %lu to %lu times\n", (unsigned long)min, (unsigned long)max);
+  check(max - min <= 1, "every slot wears the same");
+  restored = boot(&r);
+  check(restored && (r.hallway == (uint8_t)69999) && (r.on == (uint8_t)(69999>>8)),
+        "boot restores the newest after the sequence wraps");
+
+  seq = Settings_Stats()->seq;
+  for(i=0; i<4; i=i+1){                 // reset after 0 to 3 of the 4 words
+    Settings_Save(&r, sizeof(r));       // the newest, so nothing to write
+    r.hallway = 7;
+    Settings_Save(&r, sizeof(r));
+    Settings_PowerCut = i;
+    Settings_Flush();
+    Settings_PowerCut = -1;
+    restored = boot(&r);
+    check(restored && (r.hallway == (uint8_t)69999), "a write cut short restores the record before");
+  }
+  check(Settings_Stats()->seq == seq, "no record left by the cut writes");
+  r.hallway = 8;                        // and the store goes on after it
+  Settings_Save(&r, sizeof(r));
+  Settings_Flush();
+  restored = boot(&r);
+  check(restored && (r.hallway == 8), "the next write after a cut is restored");
+
+  restored = Settings_Init(2, &r, sizeof(r));
+  check(!restored, "another version is not restored");
+
+  printf("%s\n", Failures ? "FAILED" : "all passed");
+  return Failures ? 1 : 0;
+}